@@ -7,6 +7,7 @@
 
 #include "LaMaskBoolOperations.h"
 #include <numeric> 
+#include <vector>
 
 /*
 *      Author:
@@ -20,6 +21,8 @@
 int main(int argc, char * argv[])
 {
 	char* input_f1, *output_f, *input_f2;
+	char* expression = NULL; 
+	std::vector<char*> more_input_f; 
 	
 	bool foundArgs1 = false, foundArgs2 = false, foundArgs3 = false;
 
@@ -49,30 +52,46 @@ int main(int argc, char * argv[])
 				
 				}
 
+				else if (std::string(argv[i]) == "-i") {
+					more_input_f.push_back(argv[i + 1]);
+				}
+
+				else if (std::string(argv[i]) == "-expr") {
+					expression = argv[i + 1];
+				}
+
 			}
 			
 		}
 	}
 
-	if (!(foundArgs1 && foundArgs2 && foundArgs3))
+	if (!(foundArgs1 && foundArgs2 && (foundArgs3 || expression != NULL)))
 	{
 		std::cerr << "Cheeck your parameters\n\nUsage:"
 			"\nPerforms boolean operations on two masks"
 			"\n(Mandatory)\n\t-i1 <mask1> \n\t-i2 <mask2>\n\t-o <output filename>\n"
 			"== Optional =="
-			"\n\t-m <which operation> (1=AND, 2=OR, 3-XOR, 4-A_NOT_B)" << std::endl; 
+			"\n\t-m <which operation> (1=AND, 2=OR, 3-XOR, 4-A_NOT_B)"
+			"\n\t-i <mask> further masks, can be repeated"
+			"\n\t-expr <expression> combines the masks, named A, B, C, ... in the order -i1, -i2, -i, e.g. \"(A|B)&~C\" or \"A=2 - B\","
+			"\n\t\toperators ~ (not), & (and), - (and not), ^ (xor), | (or); A=n selects label n of A. -i2 is optional with -expr" << std::endl; 
 			
 		exit(1);
 	}
 	else
 	{
 		LaImage* mask1 = new LaImage(input_f1);
-		LaImage* mask2 = new LaImage(input_f2);
+		LaImage* mask2 = foundArgs3 ? new LaImage(input_f2) : new LaImage();
 		LaImage* img_out = new LaImage();
 
 		LaMaskBoolOperations* algorithm = new LaMaskBoolOperations();
 		algorithm->SetInputData(mask1); 
 		algorithm->SetInputData2(mask2); 
+		for (size_t i = 0; i < more_input_f.size(); i++)
+			algorithm->AddInputData(new LaImage(more_input_f[i])); 
+
+		if (expression != NULL)
+			algorithm->SetExpression(expression); 
 
 		switch (method)
 		{
@@ -93,6 +112,12 @@ int main(int argc, char * argv[])
 
 		algorithm->Update();
 
+		if (!algorithm->Succeeded())
+		{
+			std::cerr << "boolmask: no output written to " << output_f << std::endl;
+			exit(1);
+		}
+
 		img_out = algorithm->GetOutput();
 
 		img_out->Export(output_f);
@@ -86,7 +86,8 @@ int main(int argc, char * argv[])
 		application->SetInputData(source);
 
 		std::cout << "Waiting for you to pick points on the mesh to draw a line, \nor I could complete a circle from your picked points"
-		"\n - Press x on keyboard for picking points on the mesh\n - Press l for drawing a line between your points and extract data\n - Press c to draw circle between points and extract data\n\n";
+		"\n - Press x on keyboard for picking points on the mesh\n - Press l for drawing a line between your points and extract data\n - Press c to draw circle between points and extract data"
+		"\n - Press u to undo the last picked point (keep picking and press l or c again, only the changed segments are recomputed)\n\n";
 		application->Run();
 
 
@@ -17,6 +17,7 @@ int main(int argc, char * argv[])
 {
 	char* output_fn, *input_img_fn; 
 	int nn=1, iter=1, direc=XYZ;;
+	int method = FILL_MEAN, radius = 3;
 
 	bool foundArgs1 = false, foundArgs2 = false, foundArgs3 = false;
     
@@ -24,7 +25,26 @@ int main(int argc, char * argv[])
 	if (argc >= 1)
 	{
 		for (int i = 1; i < argc; i++) {
-			if (i + 1 != argc) {
+            // switches first, so they can come anywhere on the command line
+            if (std::string(argv[i]) == "--xy") {
+                direc = XY;
+            }
+            else if (std::string(argv[i]) == "--yz") {
+                direc = YZ;
+            }
+            else if (std::string(argv[i]) == "--xz") {
+                direc = XZ;
+            }
+            else if (std::string(argv[i]) == "--telea") {
+                method = FILL_FAST_MARCHING;
+            }
+            else if (std::string(argv[i]) == "--laplace") {
+                method = FILL_LAPLACE;
+            }
+            else if (std::string(argv[i]) == "--biharmonic") {
+                method = FILL_BIHARMONIC;
+            }
+			else if (i + 1 != argc) {
 				
 				 if (std::string(argv[i]) == "-img") {
 					input_img_fn = argv[i + 1];
@@ -42,18 +62,12 @@ int main(int argc, char * argv[])
                 else if (std::string(argv[i]) == "-iter") {
                     iter = atoi(argv[i+1]);
                 }
+                else if (std::string(argv[i]) == "-radius") {
+                    radius = atoi(argv[i+1]);
+                }
                 
                
 			}
-            else if (std::string(argv[i]) == "--xy") {
-                direc = XY;
-            }
-            else if (std::string(argv[i]) == "--yz") {
-                direc = YZ;
-            }
-            else if (std::string(argv[i]) == "--xz") {
-                direc = XZ;
-            }
 			
 		}
 	}
@@ -64,7 +78,14 @@ int main(int argc, char * argv[])
 			"\nfills holes in an image's pixels with mean of its non-zero neighbours"
 			"\n(Mandatory)\n\t-img <img> \n\t-o <new image filename>"
             "\n(Optional)\n\t-nn min neighbours required for mean"
-            "\n\t-iter number of iterations (default 1)\n";
+            "\n\t-iter number of iterations (default 1)"
+            "\n\t--xy, --yz, --xz fill within planes only"
+            "\n\t--telea one-pass fast-marching inpainting instead of the mean"
+            "\n\t-radius neighbourhood of --telea in voxels (default 3)"
+            "\n\t--laplace smooth harmonic fill (multigrid)"
+            "\n\t--biharmonic smoother biharmonic fill (two coupled multigrid Laplace solves)"
+            "\n\t--telea, --laplace and --biharmonic only fill holes enclosed by non-zero voxels,"
+            "\n\tzero voxels connected to the image border are left as background\n";
             
 		exit(1);
 	}
@@ -80,9 +101,11 @@ int main(int argc, char * argv[])
         algorithm->SetMinNeighboursForMean(nn);
         algorithm->SetNumberOfIterations(iter);
         algorithm->SetInterpolateDirection(direc);
+        algorithm->SetFillMethod(method);
+        algorithm->SetInpaintRadius(radius);
 
         std::cout << "Running algorithm with\n\tNeighour size = " << nn << "\n\tIterations"
-        "= " << iter << "\n\tdirection = " << direc << std::endl;
+        "= " << iter << "\n\tdirection = " << direc << "\n\tmethod = " << method << std::endl;
         algorithm->Update();
 
         
@@ -6,6 +6,7 @@
 
 #include "LaImageFeatures.h"
 #include <numeric> 
+#include <sstream>
 
 /*
 *      Author:
@@ -19,16 +20,28 @@
 int main(int argc, char * argv[])
 {
 	char* input_f1, *output_f, *input_f2; 
+	char* binary_output_f = NULL;
 	short pixel_value=1; 
 	
 	bool foundArgs1 = false, foundArgs2 = false, foundArgs3 = false;
 	bool isHaralick = false;
+	bool isHaralickMean = false;
+	int haralick_radius = 1, haralick_bins = 16, haralick_directions = 13;
+	std::vector<double> bank_scales;
 	int method = DO_OR; 
 	
 	if (argc >= 1)
 	{
 		for (int i = 1; i < argc; i++) {
-			if (i + 1 != argc) {
+			// switches first, so they can come anywhere on the command line
+			if (std::string(argv[i]) == "--haralick") {
+				isHaralick = true;
+			}
+			else if (std::string(argv[i]) == "--haralick-mean") {
+				isHaralick = true;
+				isHaralickMean = true;
+			}
+			else if (i + 1 != argc) {
 				if (std::string(argv[i]) == "-i") {
 					input_f1 = argv[i + 1];
 					foundArgs1 = true;
@@ -39,6 +52,14 @@ int main(int argc, char * argv[])
 					foundArgs2 = true; 
 				}
 
+				else if (std::string(argv[i]) == "-ob") {
+					binary_output_f = argv[i + 1];
+				}
+
+				else if (std::string(argv[i]) == "-cache") {
+					LaImageDistanceCache::SetCacheDirectory(argv[i + 1]);
+				}
+
 				else if (std::string(argv[i]) == "-m") {
 					input_f2 = argv[i + 1];
 					foundArgs3 = true;
@@ -49,11 +70,27 @@ int main(int argc, char * argv[])
 					
 				}
 
+				else if (std::string(argv[i]) == "-window") {
+					haralick_radius = atoi(argv[i + 1]);
+				}
+
+				else if (std::string(argv[i]) == "-bins") {
+					haralick_bins = atoi(argv[i + 1]);
+				}
+
+				else if (std::string(argv[i]) == "-directions") {
+					haralick_directions = atoi(argv[i + 1]);
+				}
+
+				else if (std::string(argv[i]) == "-scales") {
+					std::stringstream scales(argv[i + 1]);
+					std::string scale;
+					while (std::getline(scales, scale, ','))
+						bank_scales.push_back(atof(scale.c_str()));
+				}
+
 			
 			}
-			else if (std::string(argv[i]) == "--haralick") {
-				isHaralick = true;
-			}
 			
 		}
 	}
@@ -63,10 +100,23 @@ int main(int argc, char * argv[])
 		std::cerr << "Cheeck your parameters\n\nUsage:"
 			"\nExtract image features"
 			"\n(Mandatory)\n\t-i <img> \n\t-m <binary mask>\n\t-o <new csv filename>\n\t-p pixel value to read\n\n"
-			"(Optional)\n\t--haralick - For Haralick feature output" << std::endl;
+			"(Optional)\n\t-ob <binary filename.lft> - Also write the features as binary columns (not with --haralick)"
+			"\n\t-cache <dir> - Keep distance maps in this directory for later runs on the same mask"
+			"\n\t--haralick - For Haralick feature output"
+			"\n\t--haralick-mean - Haralick features averaged over the directions, one row per pixel"
+			"\n\t-window <r> - Haralick window half-width, window is (2r+1)^3 (default: 1)"
+			"\n\t-bins <n> - Haralick grey levels (default: 16)"
+			"\n\t-directions <1|13> - Haralick co-occurrence directions (default: 13)"
+			"\n\t-scales <s1,s2,..> - Also write Gaussian, LoG, Hessian eigenvalue and local mean/variance features at these scales" << std::endl;
 			
 		exit(1);
 	}
+	else if (isHaralick && binary_output_f != NULL)
+	{
+		// Haralick rows are per voxel and direction, the binary table has one row per mask voxel
+		std::cerr << "-ob is not supported with --haralick or --haralick-mean, write the CSV only" << std::endl;
+		exit(1);
+	}
 	else
 	{
 		std::cout << "Only reading pixels with value " << pixel_value << std::endl;
@@ -78,6 +128,15 @@ int main(int argc, char * argv[])
 		algorithm->SetInputData(org_img);
 		algorithm->SetInputData2(mask); 
 		algorithm->SetOutputFile(output_f);
+		if (binary_output_f)
+			algorithm->SetBinaryOutputFile(binary_output_f);
+		algorithm->SetPixelValue(pixel_value);
+		algorithm->SetHaralickWindowRadius(haralick_radius);
+		algorithm->SetHaralickBins(haralick_bins);
+		algorithm->SetHaralickAverageDirections(isHaralickMean);
+		if (haralick_directions == 1)
+			algorithm->SetHaralickDirections(std::vector<int>(1, 0));
+		algorithm->SetFeatureBankScales(bank_scales);
 		
 		
 		if (isHaralick)
@@ -20,7 +20,7 @@ int main(int argc, char * argv[])
 	char* input_bin_fn, *output_fn, *input_img_fn; 
 	
 	bool foundArgs1 = false, foundArgs2 = false, foundArgs3 = false;
-    int x,y,z,l=-1,w=-1,h=-1;
+    int x=0,y=0,z=0,l=-1,w=-1,h=-1;
 	
 	if (argc >= 1)
 	{
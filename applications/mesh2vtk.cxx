@@ -48,6 +48,7 @@ int main(int argc, char * argv[]){
 		std::cerr << "Check your parameters\n\nUsage:"
 			"\nVTK mesh turned into vtkPolyData"
 			"\n(Mandatory)\n\t-vtk <vtk file with mesh> \n\t-o <output filename>"
+			"\n\nFormats follow the extension: .vtk (legacy), .vtp (XML) or .lmsh (lassy mesh)"
        << std::endl;
 
 		exit(1);
@@ -0,0 +1,269 @@
+#define HAS_VTK 1
+
+#include "LaShell.h"
+#include "LaVolume.h"
+#include "LaImage.h"
+#include "LaImageNormalInterrogator.h"
+#include "LaMeshReordering.h"
+#include "LaVolumeGraphTraversal.h"
+
+#include <vtkPolyDataNormals.h>
+
+#include <iostream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/*
+ *  Measures the effect of space-filling-curve renumbering
+ *  (LaMeshReordering) on the traversal and normal-interrogation loops.
+ *
+ *  The same workload runs on the mesh as loaded and after Reorder():
+ *
+ *    graph build    LaVolumeGraphTraversal::Build() with Euclidean weights
+ *    bfs            GetNeighboursAroundPoint() around evenly spaced nodes
+ *    dijkstra       ShortestPath() between pairs of those nodes
+ *    interrogation  LaImageNormalInterrogator along every vertex normal
+ *                   (surfaces with -img only), as in
+ *                   LaImageSurfaceNormalAnalysis
+ *
+ *  Query nodes are picked in the original numbering and mapped through
+ *  the permutation, so both runs do the same work; the two checksums
+ *  agree up to summation order.  Each phase reports the best of -repeat
+ *  runs.
+ */
+
+using Clock = std::chrono::steady_clock;
+
+struct Timings {
+    double build_ms;
+    double bfs_ms;
+    double dijkstra_ms;
+    double interrogation_ms;
+    double checksum;
+};
+
+template <typename F>
+static double BestOf(int repeat, F&& f) {
+    double best = -1.0;
+    for (int r = 0; r < repeat; ++r) {
+        const Clock::time_point start = Clock::now();
+        f();
+        const double ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        if (best < 0.0 || ms < best) best = ms;
+    }
+    return best;
+}
+
+static Timings RunWorkload(vtkPointSet* mesh,
+                           const std::vector<vtkIdType>& queries,
+                           int hops,
+                           int repeat,
+                           LaImage* image) {
+    Timings t = {0.0, 0.0, 0.0, 0.0, 0.0};
+
+    LaVolumeGraphTraversal graph;
+    graph.SetInputGrid(mesh);
+    graph.SetEdgeWeightToEuclidean();
+    t.build_ms = BestOf(repeat, [&]() { graph.Build(); });
+
+    std::vector<std::pair<vtkIdType, int>> neighbours;
+    double bfs_sum = 0.0;
+    t.bfs_ms = BestOf(repeat, [&]() {
+        bfs_sum = 0.0;
+        for (const vtkIdType q : queries) {
+            graph.GetNeighboursAroundPoint(q, hops, neighbours);
+            bfs_sum += static_cast<double>(neighbours.size());
+        }
+    });
+
+    double path_sum = 0.0;
+    t.dijkstra_ms = BestOf(repeat, [&]() {
+        path_sum = 0.0;
+        for (size_t i = 0; i + 1 < queries.size(); i += 10) {
+            path_sum += static_cast<double>(
+                graph.ShortestPath(queries[i], queries[queries.size() - 1 - i]).size());
+        }
+    });
+
+    double intensity_sum = 0.0;
+    vtkDataArray* normals = mesh->GetPointData()->GetNormals();
+    if (image && normals) {
+        LaImageNormalInterrogator interrogator;
+        interrogator.SetInputData(image);
+
+        t.interrogation_ms = BestOf(repeat, [&]() {
+            intensity_sum = 0.0;
+            int directions[2] = {-1, 1};
+            for (vtkIdType i = 0; i < mesh->GetNumberOfPoints(); ++i) {
+                double n[3], x[3];
+                normals->GetTuple(i, n);
+                mesh->GetPoint(i, x);
+                image->WorldToImage(n[0], n[1], n[2]);
+                image->WorldToImage(x[0], x[1], x[2]);
+
+                interrogator.SetLineOrigin(x);
+                interrogator.SetDirectionVector(n);
+                interrogator.SetInterrogationDirections(directions);
+                interrogator.SetStepSize(4);
+                interrogator.Update();
+                intensity_sum += interrogator.GetIntensity();
+            }
+        });
+    }
+
+    t.checksum = bfs_sum + path_sum + intensity_sum;
+    return t;
+}
+
+static void PrintRow(const char* phase, double before, double after) {
+    std::cout << "  " << std::left << std::setw(15) << phase << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2) << before
+              << std::setw(12) << after
+              << std::setw(10) << std::setprecision(2)
+              << ((after > 0.0) ? before / after : 0.0) << "x" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const char* shell_fn  = nullptr;
+    const char* volume_fn = nullptr;
+    const char* image_fn  = nullptr;
+    const char* cache_fn  = nullptr;
+    int curve_mode  = 1;
+    int hops        = 10;
+    int num_queries = 200;
+    int repeat      = 3;
+
+    for (int i = 1; i + 1 < argc; ++i) {
+        const std::string arg(argv[i]);
+        if      (arg == "-shell")   { shell_fn    = argv[++i]; }
+        else if (arg == "-volume")  { volume_fn   = argv[++i]; }
+        else if (arg == "-img")     { image_fn    = argv[++i]; }
+        else if (arg == "-cache")   { cache_fn    = argv[++i]; }
+        else if (arg == "-curve")   { curve_mode  = atoi(argv[++i]); }
+        else if (arg == "-n")       { hops        = atoi(argv[++i]); }
+        else if (arg == "-queries") { num_queries = atoi(argv[++i]); }
+        else if (arg == "-repeat")  { repeat      = atoi(argv[++i]); }
+    }
+
+    if ((shell_fn == nullptr) == (volume_fn == nullptr)) {
+        std::cerr <<
+            "Benchmarks mesh traversal and normal interrogation before and after\n"
+            "space-filling-curve renumbering of points and cells.\n"
+            "\nUsage:\n"
+            "  reorderbenchmark -shell  <mesh.vtk> [-img <image.nii>] [options]\n"
+            "  reorderbenchmark -volume <mesh.vtk|vtu|pts> [options]\n"
+            "\n(Optional)\n"
+            "  -img     <image>  Image interrogated along the surface normals (shell only)\n"
+            "  -curve   <int>    1=Morton (default), 2=Hilbert\n"
+            "  -cache   <file>   Read/write the computed order here\n"
+            "  -n       <int>    BFS neighbourhood hops (default: 10)\n"
+            "  -queries <int>    BFS source nodes (default: 200; every 10th pair for Dijkstra)\n"
+            "  -repeat  <int>    Runs per phase, best reported (default: 3)\n"
+            << std::endl;
+        return 1;
+    }
+
+    const LaMeshReordering::Curve curve = (curve_mode == 2)
+        ? LaMeshReordering::Curve::Hilbert : LaMeshReordering::Curve::Morton;
+    repeat = std::max(1, repeat);
+
+    // ----------------------------------------------------------------
+    // Original and reordered copies of the mesh
+    // ----------------------------------------------------------------
+    vtkSmartPointer<vtkPointSet> original;
+    vtkSmartPointer<vtkPointSet> reordered;
+    LaMeshReordering::Permutation permutation;
+    LaImage* image = nullptr;
+
+    double reorder_ms = 0.0;
+
+    if (shell_fn) {
+        LaShell shell(shell_fn);
+        vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
+        shell.GetMesh3D(mesh);
+
+        if (image_fn && !mesh->GetPointData()->GetNormals()) {
+            vtkSmartPointer<vtkPolyDataNormals> normal_filter =
+                vtkSmartPointer<vtkPolyDataNormals>::New();
+            normal_filter->SetInputData(mesh);
+            normal_filter->SplittingOff();
+            normal_filter->Update();
+            mesh->DeepCopy(normal_filter->GetOutput());
+            shell.SetMesh3D(mesh);
+        }
+        original = mesh;
+
+        const Clock::time_point start = Clock::now();
+        shell.Reorder(curve, cache_fn);
+        reorder_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        reordered   = shell.GetMesh3DView();
+        permutation = shell.GetReordering();
+
+        if (image_fn) image = new LaImage(image_fn);
+    } else {
+        LaVolume volume(volume_fn);
+        vtkSmartPointer<vtkUnstructuredGrid> grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+        grid->DeepCopy(volume.GetGridPointer());
+        original = grid;
+
+        const Clock::time_point start = Clock::now();
+        volume.Reorder(curve, cache_fn);
+        reorder_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        vtkSmartPointer<vtkUnstructuredGrid> renumbered = vtkSmartPointer<vtkUnstructuredGrid>::New();
+        renumbered->ShallowCopy(volume.GetGridPointer());
+        reordered   = renumbered;
+        permutation = volume.GetReordering();
+    }
+
+    if (permutation.IsEmpty()) {
+        std::cerr << "reorderbenchmark: reordering failed." << std::endl;
+        return 1;
+    }
+
+    // ----------------------------------------------------------------
+    // Same physical query nodes in both numberings
+    // ----------------------------------------------------------------
+    const vtkIdType num_points = original->GetNumberOfPoints();
+    const std::vector<vtkIdType> new_id = LaMeshReordering::Inverse(permutation).point_order;
+
+    std::vector<vtkIdType> original_queries;
+    std::vector<vtkIdType> reordered_queries;
+    num_queries = std::max(1, std::min<int>(num_queries, static_cast<int>(num_points)));
+    for (int q = 0; q < num_queries; ++q) {
+        const vtkIdType id = num_points * q / num_queries;
+        original_queries.push_back(id);
+        reordered_queries.push_back(new_id[static_cast<size_t>(id)]);
+    }
+
+    // ----------------------------------------------------------------
+    // Run
+    // ----------------------------------------------------------------
+    const Timings before = RunWorkload(original,  original_queries,  hops, repeat, image);
+    const Timings after  = RunWorkload(reordered, reordered_queries, hops, repeat, image);
+
+    std::cout << "\nMesh: " << num_points << " points, " << original->GetNumberOfCells()
+              << " cells; " << (curve == LaMeshReordering::Curve::Hilbert ? "Hilbert" : "Morton")
+              << " reordering took " << std::fixed << std::setprecision(1) << reorder_ms << " ms\n"
+              << "Mean neighbour id gap: "
+              << LaMeshReordering::MeanNeighbourIdGap(original) << " -> "
+              << LaMeshReordering::MeanNeighbourIdGap(reordered) << "\n\n"
+              << "  " << std::left << std::setw(15) << "phase (ms)" << std::right
+              << std::setw(12) << "original" << std::setw(12) << "reordered"
+              << std::setw(11) << "speedup" << std::endl;
+
+    PrintRow("graph build", before.build_ms,    after.build_ms);
+    PrintRow("bfs",         before.bfs_ms,      after.bfs_ms);
+    PrintRow("dijkstra",    before.dijkstra_ms, after.dijkstra_ms);
+    if (image) PrintRow("interrogation", before.interrogation_ms, after.interrogation_ms);
+
+    std::cout << "\nChecksum: " << std::setprecision(3) << before.checksum << " / "
+              << after.checksum << std::endl;
+
+    delete image;
+    return 0;
+}
@@ -27,6 +27,11 @@
  *                  's' to confirm). Saves coordinates to <o>_seeds.txt
  *                  for reproducibility, then runs scar generation in
  *                  memory without a file read-back.
+ *
+ *  Sweep mode (-sweep-n / -sweep-f / -sweep-s) evaluates every
+ *  combination in a single run: the mesh, graph, paths and distance
+ *  field are built once.  All variants go into the output mesh as named
+ *  arrays, or into one file each with --sweep-split.
  */
 
 static void SaveCoordinates(const char* path,
@@ -51,13 +56,18 @@ int main(int argc, char* argv[]) {
     double sigma           = -1.0;
     int    falloff_mode    = 1;
     bool   interactive     = false;
+    bool   sweep_split     = false;
+    std::vector<int>    sweep_n;
+    std::vector<int>    sweep_f;
+    std::vector<double> sweep_s;
 
     bool found_input  = false;
     bool found_output = false;
 
     for (int i = 1; i < argc; ++i) {
         const std::string arg(argv[i]);
-        if (arg == "--pick") { interactive = true; continue; }
+        if (arg == "--pick")        { interactive = true; continue; }
+        if (arg == "--sweep-split") { sweep_split = true; continue; }
         if (i + 1 == argc)  continue;
         if      (arg == "-i")       { input_fn      = argv[++i]; found_input  = true; }
         else if (arg == "-pts")     { pts_fn        = argv[++i]; }
@@ -66,8 +76,13 @@ int main(int argc, char* argv[]) {
         else if (arg == "-sigma")   { sigma         = atof(argv[++i]); }
         else if (arg == "-falloff") { falloff_mode  = atoi(argv[++i]); }
         else if (arg == "-name")    { array_name    = argv[++i]; }
+        else if (arg == "-sweep-n") { sweep_n = LaSyntheticScarField::ParseList<int>(argv[++i]); }
+        else if (arg == "-sweep-f") { sweep_f = LaSyntheticScarField::ParseList<int>(argv[++i]); }
+        else if (arg == "-sweep-s") { sweep_s = LaSyntheticScarField::ParseList<double>(argv[++i]); }
     }
 
+    const bool sweep = !sweep_n.empty() || !sweep_f.empty() || !sweep_s.empty();
+
     const bool has_pts = (pts_fn != nullptr);
 
     if (!found_input || !found_output || (!has_pts && !interactive)) {
@@ -86,6 +101,12 @@ int main(int argc, char* argv[]) {
             "  -sigma    <float> Gaussian sigma in world units (default: auto)\n"
             "  -falloff  <int>   1=Gaussian (default), 2=Linear\n"
             "  -name     <str>   Output array name (default: synthetic_scar)\n"
+            "\n(Sweep mode, single run)\n"
+            "  -sweep-n  <list>  Comma-separated neighbourhood hops (default: -n)\n"
+            "  -sweep-f  <list>  Comma-separated falloff modes     (default: -falloff)\n"
+            "  -sweep-s  <list>  Comma-separated Gaussian sigmas   (default: -sigma)\n"
+            "  --sweep-split     One file per variant, <out>_n<N>_f<F>[_s<S>].<ext>\n"
+            "                    (default: all variants as arrays in <out>)\n"
             "  --pick            Interactive picking\n"
             << std::endl;
         return 1;
@@ -163,11 +184,40 @@ int main(int argc, char* argv[]) {
     // ----------------------------------------------------------------
     // Run
     // ----------------------------------------------------------------
-    algorithm->Update();
+    if (!sweep) {
+        algorithm->Update();
 
-    LaShell* output = algorithm->GetOutput();
-    output->ExportVTK(const_cast<char*>(output_fn));
-    std::cout << "Saved: " << output_fn << std::endl;
+        LaShell* output = algorithm->GetOutput();
+        output->ExportVTK(const_cast<char*>(output_fn));
+        std::cout << "Saved: " << output_fn << std::endl;
+    } else {
+        if (sweep_n.empty()) sweep_n.push_back(neighbourhood);
+        if (sweep_f.empty()) sweep_f.push_back(falloff_mode);
+        algorithm->UpdateSweep(sweep_n, sweep_f, sweep_s);
+
+        LaShell* output = algorithm->GetOutput();
+        const auto& variants = algorithm->GetSweepVariants();
+
+        if (!sweep_split) {
+            output->ExportVTK(const_cast<char*>(output_fn));
+            std::cout << "Saved: " << output_fn << " ("
+                      << variants.size() << " arrays)" << std::endl;
+        } else {
+            vtkSmartPointer<vtkPolyData> output_poly =
+                vtkSmartPointer<vtkPolyData>::New();
+            output->GetMesh3D(output_poly);
+
+            LaSyntheticScarField::SplitVariants(output_poly, variants, output_fn,
+                [](vtkDataSet* variant_poly, const std::string& variant_fn) {
+                    vtkSmartPointer<vtkPolyDataWriter> writer =
+                        vtkSmartPointer<vtkPolyDataWriter>::New();
+                    writer->SetInputData(variant_poly);
+                    writer->SetFileName(variant_fn.c_str());
+                    writer->Update();
+                    std::cout << "Saved: " << variant_fn << std::endl;
+                });
+        }
+    }
 
     delete algorithm;
     delete source_mesh;
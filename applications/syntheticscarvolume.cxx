@@ -1,6 +1,7 @@
 #define HAS_VTK 1
 
 #include "LaVolume.h"
+#include "LaFileName.h"
 #include "LaVolumeSyntheticScar.h"
 #include "LaShellGapsInBinary.h"
 
@@ -29,6 +30,15 @@
  *                  the VTK viewer (press 'x' to pick, 's' to confirm).
  *                  Saves coordinates to <o>_seeds.txt for reproducibility,
  *                  then resolves them to volumetric nodes in memory.
+ *
+ *  Sweep mode (-sweep-n / -sweep-f / -sweep-s) evaluates every
+ *  combination in a single run: the volume, graph, paths and distance
+ *  field are built once.  All variants go into the output mesh as named
+ *  arrays, or into one file each with --sweep-split.
+ *
+ *  CARP output: -o <out>.pts (or .elem) writes out.pts / out.elem plus one
+ *  out_<array>.dat per scar array; -o <out>.dat writes only the data
+ *  files.  CARP input (-i mesh.pts / mesh.elem) is read natively.
  */
 
 static void SaveCoordinates(const char* path,
@@ -49,17 +59,30 @@ int main(int argc, char* argv[]) {
     const char* pts_fn     = nullptr;
     const char* output_fn  = nullptr;
     const char* array_name = nullptr;
+    const char* cache_fn   = nullptr;
     int    neighbourhood   = 15;
     double sigma           = -1.0;
     int    falloff_mode    = 1;
+    int    partitions      = 1;
     bool   interactive     = false;
+    bool   sweep_split     = false;
+    bool   geodesic        = false;
+    bool   geodesic_kernel = false;
+    bool   reorder         = false;
+    std::vector<int>    sweep_n;
+    std::vector<int>    sweep_f;
+    std::vector<double> sweep_s;
 
     bool found_input  = false;
     bool found_output = false;
 
     for (int i = 1; i < argc; ++i) {
         const std::string arg(argv[i]);
-        if (arg == "--pick") { interactive = true; continue; }
+        if (arg == "--pick")        { interactive = true; continue; }
+        if (arg == "--sweep-split") { sweep_split = true; continue; }
+        if (arg == "--geodesic")    { geodesic    = true; continue; }
+        if (arg == "--geodesic-kernel") { geodesic_kernel = true; continue; }
+        if (arg == "--reorder")     { reorder     = true; continue; }
         if (i + 1 == argc)  continue;
         if      (arg == "-i")       { input_fn      = argv[++i]; found_input  = true; }
         else if (arg == "-pts")     { pts_fn        = argv[++i]; }
@@ -68,19 +91,27 @@ int main(int argc, char* argv[]) {
         else if (arg == "-sigma")   { sigma         = atof(argv[++i]); }
         else if (arg == "-falloff") { falloff_mode  = atoi(argv[++i]); }
         else if (arg == "-name")    { array_name    = argv[++i]; }
+        else if (arg == "-partitions") { partitions = atoi(argv[++i]); }
+        else if (arg == "-reorder-cache") { cache_fn = argv[++i]; reorder = true; }
+        else if (arg == "-sweep-n") { sweep_n = LaSyntheticScarField::ParseList<int>(argv[++i]); }
+        else if (arg == "-sweep-f") { sweep_f = LaSyntheticScarField::ParseList<int>(argv[++i]); }
+        else if (arg == "-sweep-s") { sweep_s = LaSyntheticScarField::ParseList<double>(argv[++i]); }
     }
 
+    const bool sweep = !sweep_n.empty() || !sweep_f.empty() || !sweep_s.empty();
+
     const bool has_pts = (pts_fn != nullptr);
 
     if (!found_input || !found_output || (!has_pts && !interactive)) {
         std::cerr <<
             "Generates a synthetic scar scalar field on a volumetric mesh.\n"
             "\nUsage:\n"
-            "  syntheticScarVolume -i <mesh.vtk|vtu> -pts <coords.txt> -o <out.vtk> [options]\n"
-            "  syntheticScarVolume -i <mesh.vtk|vtu> --pick             -o <out.vtk> [options]\n"
+            "  syntheticScarVolume -i <mesh.vtk|vtu|pts> -pts <coords.txt> -o <out.vtk> [options]\n"
+            "  syntheticScarVolume -i <mesh.vtk|vtu|pts> --pick             -o <out.vtk> [options]\n"
             "\n(Mandatory)\n"
-            "  -i   <mesh>       Input volumetric mesh (.vtk or .vtu)\n"
-            "  -o   <out>        Output mesh (.vtk or .vtu)\n"
+            "  -i   <mesh>       Input volumetric mesh (.vtk, .vtu or CARP .pts/.elem)\n"
+            "  -o   <out>        Output mesh (.vtk or .vtu), CARP mesh + data (.pts),\n"
+            "                    or CARP data only (.dat, one file per array)\n"
             "  -pts <coords.txt> Seed coordinate file (x y z per line)\n"
             "                    OR use --pick for interactive picking on extracted surface\n"
             "\n(Optional)\n"
@@ -88,6 +119,25 @@ int main(int argc, char* argv[]) {
             "  -sigma    <float> Gaussian sigma in world units (default: auto)\n"
             "  -falloff  <int>   1=Gaussian (default), 2=Linear\n"
             "  -name     <str>   Output array name (default: synthetic_scar)\n"
+            "  --geodesic        Also write <name>_geodesic, the along-mesh distance\n"
+            "                    to the path within the corridor (-1 outside)\n"
+            "  --geodesic-kernel Falloff on the along-mesh distance to each path\n"
+            "                    node instead of the straight-line distance\n"
+            "  -partitions <int> Build the scar field cache in this many spatial\n"
+            "                    chunks with ghost layers; shrinks the cache, not\n"
+            "                    the mesh or graph (default: 1)\n"
+            "  --reorder         Renumber nodes along a Morton curve while computing\n"
+            "                    (faster traversal); outputs keep the input numbering.\n"
+            "                    Use coordinate seeds (-pts x y z or --pick) with it.\n"
+            "                    The order is cached in <input>.order next to the mesh\n"
+            "  -reorder-cache <file>\n"
+            "                    As --reorder, caching the order in file instead\n"
+            "\n(Sweep mode, single run)\n"
+            "  -sweep-n  <list>  Comma-separated neighbourhood hops (default: -n)\n"
+            "  -sweep-f  <list>  Comma-separated falloff modes     (default: -falloff)\n"
+            "  -sweep-s  <list>  Comma-separated Gaussian sigmas   (default: -sigma)\n"
+            "  --sweep-split     One file per variant, <out>_n<N>_f<F>[_s<S>].<ext>\n"
+            "                    (default: all variants as arrays in <out>)\n"
             "  --pick            Interactive picking on extracted surface\n"
             << std::endl;
         return 1;
@@ -97,6 +147,12 @@ int main(int argc, char* argv[]) {
     // Load volume
     // ----------------------------------------------------------------
     LaVolume* volume = new LaVolume(input_fn);
+    if (reorder) {
+        // a matching cache skips the sort on the next run over this mesh
+        const std::string order_fn = cache_fn ? std::string(cache_fn)
+                                              : LaFileName::Stem(input_fn) + ".order";
+        volume->Reorder(LaMeshReordering::Curve::Morton, order_fn.c_str());
+    }
 
     // ----------------------------------------------------------------
     // Build algorithm
@@ -113,6 +169,9 @@ int main(int argc, char* argv[]) {
         algorithm->SetFalloffToGaussian();
     }
     if (array_name != nullptr) algorithm->SetOutputArrayName(array_name);
+    algorithm->SetGeodesicDistanceOutput(geodesic);
+    algorithm->SetGeodesicKernelDistance(geodesic_kernel);
+    algorithm->SetNumberOfPartitions(partitions);
 
     // ----------------------------------------------------------------
     // Seeds
@@ -140,18 +199,15 @@ int main(int argc, char* argv[]) {
         std::string seed_file = std::string(output_fn) + "_seeds.txt";
         SaveCoordinates(seed_file.c_str(), positions);
 
-        // Resolve directly to volumetric nodes in memory.
-        // Coordinates are in the same physical space — no surface mapping.
-        vtkSmartPointer<vtkPointLocator> locator =
-            vtkSmartPointer<vtkPointLocator>::New();
-        locator->SetDataSet(volume->GetGridPointer());
-        locator->BuildLocator();
+        // Picked surface vertices map straight back to their volume nodes
+        // through the ids kept by ConvertToSurface — no spatial search.
+        const std::vector<int>& picked_ids = picker->GetPickedPointIds();
 
         std::vector<vtkIdType> seed_ids;
-        seed_ids.reserve(positions.size());
-        for (const auto& p : positions) {
-            double pt[3] = {p[0], p[1], p[2]};
-            seed_ids.push_back(locator->FindClosestPoint(pt));
+        seed_ids.reserve(picked_ids.size());
+        for (const int surface_id : picked_ids) {
+            const vtkIdType node = volume->SurfaceToVolumePoint(surface_id);
+            if (node >= 0) seed_ids.push_back(node);
         }
         algorithm->SetNodeIDList(seed_ids);
 
@@ -165,15 +221,59 @@ int main(int argc, char* argv[]) {
     // ----------------------------------------------------------------
     // Run
     // ----------------------------------------------------------------
-    algorithm->Update();
+    // Scar arrays written by this run, for CARP .dat output
+    std::vector<std::string> scar_arrays;
+
+    // Back to the input numbering before anything is written
+    auto restore_order = [&](LaVolume* volume_out) {
+        if (!reorder) return;
+        LaMeshReordering::Apply(volume_out->GetGridPointer(),
+                                LaMeshReordering::Inverse(volume->GetReordering()));
+    };
+
+    auto export_volume = [&scar_arrays](LaVolume* volume_out, const std::string& fn) {
+        const std::string ext  = LaFileName::Extension(fn);
+        const std::string stem = LaFileName::Stem(fn);
 
-    LaVolume* output = algorithm->GetOutput();
-    const std::string out_str(output_fn);
-    if (out_str.size() >= 4 &&
-        out_str.substr(out_str.size() - 4) == ".vtu") {
-        output->ExportVTU(output_fn);
+        if (ext == ".pts" || ext == ".elem" || ext == ".dat") {
+            if (ext != ".dat") volume_out->ExportCARP(stem.c_str());
+            for (const std::string& name : scar_arrays) {
+                if (!volume_out->GetGridPointer()->GetPointData()->GetArray(name.c_str()))
+                    continue;
+                volume_out->ExportCARPData(name.c_str(), (stem + "_" + name + ".dat").c_str());
+            }
+        } else if (ext == ".vtu") {
+            volume_out->ExportVTU(fn.c_str());
+        } else {
+            volume_out->ExportVTK(fn.c_str());
+        }
+    };
+
+    if (!sweep) {
+        algorithm->Update();
+        scar_arrays = algorithm->GetWrittenArrayNames();
+        restore_order(algorithm->GetOutput());
+        export_volume(algorithm->GetOutput(), output_fn);
     } else {
-        output->ExportVTK(output_fn);
+        if (sweep_n.empty()) sweep_n.push_back(neighbourhood);
+        if (sweep_f.empty()) sweep_f.push_back(falloff_mode);
+        algorithm->UpdateSweep(sweep_n, sweep_f, sweep_s);
+
+        LaVolume* output = algorithm->GetOutput();
+        restore_order(output);
+        const auto& variants = algorithm->GetSweepVariants();
+        scar_arrays = algorithm->GetWrittenArrayNames();
+
+        if (!sweep_split) {
+            export_volume(output, output_fn);
+        } else {
+            LaSyntheticScarField::SplitVariants(output->GetGridPointer(), variants, output_fn,
+                [&export_volume](vtkDataSet* variant_grid, const std::string& variant_fn) {
+                    LaVolume variant_volume;
+                    variant_volume.SetGrid(vtkUnstructuredGrid::SafeDownCast(variant_grid));
+                    export_volume(&variant_volume, variant_fn);
+                });
+        }
     }
 
     delete algorithm;
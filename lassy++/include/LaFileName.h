@@ -0,0 +1,25 @@
+/*
+ *  LaFileName.h
+ *
+ *  File-name helpers shared by the readers and writers that choose a
+ *  format from the extension (LaShellIO, LaVolume, LaVolumeCarpIO).
+ */
+#pragma once
+
+#include <string>
+
+
+class LaFileName {
+
+public:
+
+    /*
+     * Lower-cased extension including the dot, e.g. ".elem"; empty if none.
+     */
+    static std::string Extension(const std::string& filename);
+
+    /*
+     * filename without its extension.
+     */
+    static std::string Stem(const std::string& filename);
+};
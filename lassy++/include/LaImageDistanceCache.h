@@ -0,0 +1,53 @@
+/*
+ *  LaImageDistanceCache.h
+ *
+ *  Signed Maurer distance maps of one label of a mask, computed on a
+ *  region of the mask and cached, used by LaImageFeatures.
+ *
+ *  The label is selected by itk::BinaryThresholdImageFilter (label -> 1,
+ *  everything else -> 0) on the region, and the map is
+ *  itk::SignedMaurerDistanceMapImageFilter with its default settings, as
+ *  LaImageFeatures has always used it.  Maps are keyed by a hash of the
+ *  region's voxels, its size and spacing, and the label — not by the
+ *  image object — so the same mask loaded twice hits the same entry.
+ *
+ *  The last MaxEntries maps are kept in memory for the whole process.
+ *  With a cache directory set, maps are also written there (NIfTI) and
+ *  read back on later runs, e.g. by several imagefeature invocations on
+ *  the same mask.
+ */
+#pragma once
+
+#include <string>
+
+#include "itkImage.h"
+
+
+class LaImageDistanceCache {
+
+public:
+
+    typedef itk::Image<unsigned short, 3> MaskImageType;
+    typedef itk::Image<float, 3>          DistanceImageType;
+
+    static const size_t MaxEntries = 4;
+
+    /*
+     * Distance map over region of mask (index 0 of the result is
+     * region.GetIndex()) to the voxels equal to label.
+     */
+    static DistanceImageType::Pointer SignedMaurerDistance(const MaskImageType* mask,
+                                                           unsigned short label,
+                                                           const MaskImageType::RegionType& region);
+
+    /*
+     * Directory the maps are also stored in; empty (default) for memory
+     * only.  The directory must exist.
+     */
+    static void SetCacheDirectory(const std::string& directory);
+
+    /*
+     * Drops the maps held in memory.
+     */
+    static void Clear();
+};
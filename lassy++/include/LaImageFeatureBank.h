@@ -0,0 +1,69 @@
+/*
+ *  LaImageFeatureBank.h
+ *
+ *  Multi-scale image features for every row of a LaImageFeatureTable,
+ *  used by LaImageFeatures.
+ *
+ *  At each scale s (mm, or voxels for unit spacing) the bank adds the
+ *  columns
+ *
+ *    Gauss_s<s>        intensity smoothed by a recursive Gaussian of sigma s
+ *    LoG_s<s>          scale-normalised Laplacian of Gaussian
+ *    HessEig1_s<s>     eigenvalues of the scale-normalised Hessian of
+ *    HessEig2_s<s>       Gaussian, in ascending order
+ *    HessEig3_s<s>
+ *    LocalMean_s<s>    mean and variance over a box of half-width
+ *    LocalVar_s<s>       max(1, round(s)) voxels
+ *
+ *  The filters are ITK's multithreaded recursive Gaussian and box filters,
+ *  run on the mask bounding box grown by 4s (and by at least the box
+ *  half-width) rather than on the whole image.  Each filter output is
+ *  copied into its columns as soon as it is computed (z-slabs in
+ *  parallel) and released, so no more than one cropped float image — or
+ *  one tensor image for the Hessian — is alive at a time, whatever the
+ *  number of scales.  The box statistics match the whole-image filters
+ *  exactly; the Gaussian features differ only by the Gaussian tail
+ *  beyond 4s that the crop cuts off.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <string>
+#include <vector>
+
+#include "itkImage.h"
+
+#include "LaImageFeatureTable.h"
+
+
+class LaImageFeatureBank {
+
+public:
+
+    typedef itk::Image<unsigned short, 3> ImageType;
+
+    LaImageFeatureBank();
+
+    void SetInputImage(const ImageType* image);
+
+    /*
+     * Gaussian sigmas.  Default: 1, 2, 4.
+     */
+    void SetScales(const std::vector<double>& scales);
+
+    /*
+     * Adds the columns of every scale to table, which must have been
+     * built on a mask of the same size as the input image.
+     */
+    void Update(LaImageFeatureTable& table);
+
+    /*
+     * Name of the column of feature (e.g. "LoG") at scale.
+     */
+    static std::string ColumnName(const char* feature, double scale);
+
+private:
+
+    const ImageType*    _image;
+    std::vector<double> _scales;
+};
@@ -0,0 +1,151 @@
+/*
+ *  LaImageFeatureTable.h
+ *
+ *  Sparse, column-oriented store of per-voxel image features, used by
+ *  LaImageFeatures.
+ *
+ *  Only the voxels inside a mask get a row.  Rows follow ITK's memory
+ *  order — z outermost, then y, then x — so a pass over the rows walks
+ *  the image buffers forwards, and a z-slab of the image is a contiguous
+ *  range of rows.  Rows are located through a compressed index over the
+ *  (y, z) scanlines: one row offset per scanline plus the x of every row,
+ *  instead of a full-size index image.  Each feature is a contiguous
+ *  float32 column added by name when its extractor runs, so a table of R
+ *  masked voxels and F features costs R * (F + 1) * 4 bytes plus 8 bytes
+ *  per scanline.
+ *
+ *  Missing values are NaN.
+ *
+ *  WriteBinary() stores the table as typed contiguous columns behind a
+ *  self-describing header (BinaryExtension, ".lft"), little-endian as
+ *  written on the host:
+ *
+ *    char[8]   "LAFEAT01"
+ *    uint32    byte-order mark 0x01020304
+ *    uint32    number of columns C
+ *    uint64    number of rows R
+ *    int32[3]  image size
+ *    uint32    0
+ *    C times:  uint32 type (1 = float32), uint32 name length,
+ *              uint64 byte offset of the column, name
+ *
+ *  Each column is R values starting at its offset, 64-byte aligned, so
+ *  it can be loaded with a single read or memory-mapped (e.g.
+ *  numpy.memmap, see python_scripts/read_feature_table.py).
+ */
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "itkImage.h"
+
+
+class LaImageFeatureTable {
+
+public:
+
+    typedef itk::Image<unsigned short, 3> MaskImageType;
+
+    LaImageFeatureTable();
+
+    /*
+     * One row per voxel of mask whose value, read as a short, is > 0.
+     * Drops all rows and columns first.
+     */
+    void Build(const MaskImageType* mask);
+
+    void Clear();
+
+    std::int64_t GetNumberOfRows() const;
+
+    // ------------------------------------------------------------------
+    // Columns
+    // ------------------------------------------------------------------
+
+    /*
+     * Index of the column called name, created and filled with NaN if it
+     * does not exist yet.
+     */
+    int AddColumn(const std::string& name);
+
+    /*
+     * Index of the column called name; -1 if there is none.
+     */
+    int FindColumn(const std::string& name) const;
+
+    int                GetNumberOfColumns() const;
+    const std::string& GetColumnName(int column) const;
+
+    float*       GetColumn(int column);
+    const float* GetColumn(int column) const;
+
+    // ------------------------------------------------------------------
+    // Voxels
+    // ------------------------------------------------------------------
+
+    /*
+     * Row of voxel (x, y, z); -1 if it lies outside the mask or the image.
+     */
+    std::int64_t FindRow(int x, int y, int z) const;
+
+    /*
+     * Calls f(row, x, y, z) for every row, in row order; the second form
+     * only for rows with z in [z_begin, z_end).
+     */
+    template <typename F>
+    void ForEachRow(F&& f) const;
+
+    template <typename F>
+    void ForEachRow(int z_begin, int z_end, F&& f) const;
+
+    /*
+     * Size of the image the table was built on, and the bounding box of
+     * its rows (lo > hi when the table is empty).
+     */
+    void GetImageSize(int& x, int& y, int& z) const;
+    void GetBoundingBox(int lo[3], int hi[3]) const;
+
+    // ------------------------------------------------------------------
+    // Output
+    // ------------------------------------------------------------------
+
+    static const char* BinaryExtension;     // ".lft"
+
+    /*
+     * Writes the given columns, in that order, in the binary layout above.
+     */
+    bool WriteBinary(const std::string& filename, const std::vector<int>& columns) const;
+
+private:
+
+    int _size[3];
+    int _bbox_lo[3];
+    int _bbox_hi[3];
+
+    // rows of scanline (y, z) are [_line_offsets[z * ny + y], _line_offsets[z * ny + y + 1])
+    std::vector<std::int64_t>  _line_offsets;
+    std::vector<std::int32_t>  _row_x;
+
+    std::vector<std::string>        _column_names;
+    std::vector<std::vector<float>> _columns;
+};
+
+
+template <typename F>
+void LaImageFeatureTable::ForEachRow(F&& f) const {
+    ForEachRow(0, _size[2], f);
+}
+
+template <typename F>
+void LaImageFeatureTable::ForEachRow(int z_begin, int z_end, F&& f) const {
+    for (int z = z_begin; z < z_end; ++z) {
+        for (int y = 0; y < _size[1]; ++y) {
+            const std::int64_t line = static_cast<std::int64_t>(z) * _size[1] + y;
+            for (std::int64_t row = _line_offsets[line]; row < _line_offsets[line + 1]; ++row) {
+                f(row, static_cast<int>(_row_x[row]), y, z);
+            }
+        }
+    }
+}
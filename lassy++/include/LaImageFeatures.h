@@ -43,6 +43,10 @@
 
 #include "LaImage.h"
 #include "LaImageAlgorithms.h"
+#include "LaImageFeatureTable.h"
+#include "LaImageFeatureBank.h"
+#include "LaImageDistanceCache.h"
+#include "LaImageGLCM.h"
 
 ;
 
@@ -54,23 +58,38 @@ private:
 	LaImage* _mask_image;
 	
 	std::string _csv_filename; 
+	std::string _binary_filename;	/* optional columnar copy of the CSV, see LaImageFeatureTable::WriteBinary */
 	short _which_value;
 	short _mask_val_SMD; /* which mask value for Signed Maurer Distance Filter */
 	int _max_features; 
-	long _total_size;
-	double _my_nan;			/* Our own NaN, just a large number telling us there is no number present */
-	std::vector<std::vector<double> > _image_features;
-	
-	typedef unsigned int PixelTypeInt;
-	typedef itk::Image< PixelTypeInt, 3 >  ImageTypeInt;
 
 	/*
-	*	The index location in _image_features storing this feature
-	*	Note this enumeration should not exceed _max_features (default is 15) unless set by SetMaxFeatures
+	*	Features of the voxels inside the mask only, one float32 column per feature
+	*	(see LaImageFeatureTable). Rows are created from the mask on first use.
+	*/
+	LaImageFeatureTable _feature_table;
+	bool _feature_table_built;
+
+	/*
+	*	Haralick texture settings, see LaImageGLCM
+	*/
+	int _haralick_radius;
+	int _haralick_bins;
+	int _haralick_min, _haralick_max;
+	std::vector<int> _haralick_directions;
+	bool _haralick_mean;
+
+	/*
+	*	Gaussian scales of the multi-scale feature bank, see LaImageFeatureBank. Empty: no bank
+	*/
+	std::vector<double> _bank_scales;
+
+	/*
+	*	The features this class extracts, in CSV column order
 	*/
 	enum _feature_list
 	{
-		intensity = 0,		/* at index 0 in _image_features, and so on */
+		intensity = 0,
 		pos_x = 1,	/* The xyz 3D co-ordinate of pixel is not a very useful feature but still needed for calculations */
 		pos_y = 2, 
 		pos_z = 3,
@@ -80,25 +99,62 @@ private:
 		Last		    /* keep it as the last feature in the list for iterating: https://goo.gl/rWSYBj */
 	};
 
+	static const char* FeatureName(int feature_index);
+
+	/*
+	*	Builds the rows of _feature_table from the mask if not done yet
+	*/
+	void PrepareFeatureTable();
+
 	/*
-	*	_Feature_index_map is the 3D input image with pixels that contain 
-	*	index to the _image_features vector that store a maximum of _max_features (default=10)
-	*	features for each pixel
+	*	Column of _feature_table holding feature_index, added on first use
 	*/
-	itk::SmartPointer<ImageTypeInt>  _feature_index_map;
+	int FeatureColumn(int feature_index);
+
+	/*
+	*	Columns of _feature_table in output order: _feature_list order, then the feature bank
+	*/
+	std::vector<int> OutputColumns() const;
+
+	/*
+	*	Intensity, position and class, gradient magnitude and/or Maurer distance of every voxel
+	*	in the mask, in a single pass
+	*/
+	void ExtractFeatures(bool intensity_pos, bool gradient, bool distance);
 	
 public:
 	
 	void SetInputData(LaImage* image); 			// intensity image 
 	void SetInputData2(LaImage* mask_img); 		// label image
 	void SetOutputFile(const char* output);
+	void SetBinaryOutputFile(const char* output);	// also writes the features as binary columns (.lft), Update() only
 	void SetPixelValue(short p); 
-	void SetMaxFeatures(int max);
+	void SetMaxFeatures(int max);				// no longer needed, columns are added as features are extracted
 
 	void SetFeatureValue(int x, int y, int z, int feature_index, double feature_value);
 	void ExtractFeature_Intensity_Pos();
 	void ExtractFeature_GradientMagnitude();
 	void ExtractFeature_SignedMaurerDistance();
+
+	const LaImageFeatureTable& GetFeatureTable() const;
+
+	/*
+	*	Haralick texture options: window half-width (default 1, i.e. 3x3x3), grey-level bins
+	*	(default 16) over an intensity range (default 0-255), directions 0..12 (default all 13)
+	*	and whether to write one row per voxel with the mean over directions (Offset = -1)
+	*	instead of one row per voxel and direction
+	*/
+	void SetHaralickWindowRadius(int radius);
+	void SetHaralickBins(int bins);
+	void SetHaralickIntensityRange(int min, int max);
+	void SetHaralickDirections(const std::vector<int>& directions);
+	void SetHaralickAverageDirections(bool mean);
+
+	/*
+	*	Adds smoothed intensity, LoG, Hessian eigenvalues and local mean and variance at
+	*	each of these scales to the columns written by Update() (default: none)
+	*/
+	void SetFeatureBankScales(const std::vector<double>& scales);
 	
 	void Update();
 	void Update_Haralick(); 
@@ -107,4 +163,4 @@ public:
 	LaImageFeatures();
 	~LaImageFeatures();
 	
-}; 
\ No newline at end of file
+};
\ No newline at end of file
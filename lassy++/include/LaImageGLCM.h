@@ -0,0 +1,145 @@
+/*
+ *  LaImageGLCM.h
+ *
+ *  Sliding-window grey-level co-occurrence (Haralick) texture features,
+ *  used by LaImageFeatures::Update_Haralick().
+ *
+ *  For every voxel with the selected mask label, a (2R+1)^3 window is
+ *  centred on it (clipped to the image) and, per direction, the pairs
+ *  (p, p + d) with both ends in the window are counted into a symmetric
+ *  co-occurrence matrix, as itk::ScalarImageToCooccurrenceMatrixFilter
+ *  does.  Intensities are quantised into NumberOfBins equal bins over
+ *  [min, max]; pixels outside that range are not counted.  The 13
+ *  directions are the first half of the 3x3x3 neighbourhood, numbered as
+ *  itk::Neighborhood offsets 0..12: d -> (d%3 - 1, d/3%3 - 1, d/9 - 1).
+ *
+ *  The matrices are not rebuilt per voxel.  Along a scanline (x) the
+ *  window moves one plane at a time: pairs leaving with the x = lo plane
+ *  are subtracted and pairs entering with the x = hi + 1 plane added,
+ *  (2R+1)^2 pairs per direction instead of (2R+1)^3.  Gaps longer than
+ *  the window between selected voxels restart the window.  Z-slabs run
+ *  in parallel (vtkSMPTools), each with its own matrices; the image is
+ *  quantised once, over the mask bounding box grown by the window.
+ *
+ *  Features are those of itk::HistogramToTextureFeaturesFilter, formulas
+ *  included, on bin indices of the normalised matrix p(i, j).  mu and
+ *  sigma^2 are the mean and variance of the index under the (symmetric)
+ *  marginal m(i) = sum_j p(i, j); m_mean and m_var are the mean and
+ *  (population) variance of the values m(0) .. m(bins - 1) themselves:
+ *
+ *    Energy                   sum p^2
+ *    Entropy                  -sum p log2 p, over p > 0.0001
+ *    Correlation              sum (i - mu)(j - mu) p / sigma^4
+ *    InverseDifferenceMoment  sum p / (1 + (i - j)^2)
+ *    Inertia                  sum (i - j)^2 p
+ *    ClusterShade             sum (i + j - 2 mu)^3 p
+ *    ClusterProminence        sum (i + j - 2 mu)^4 p
+ *    HaralickCorrelation      (sum i j p - m_mean^2) / m_var
+ *
+ *  The sigma^4 and the marginal statistics are ITK's definitions, kept so
+ *  the columns match those of the ITK-based implementation.  Undefined
+ *  values (empty matrix, zero variance) are 0 where ITK gives NaN or
+ *  infinity.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <vector>
+#include <cstdint>
+
+#include "itkImage.h"
+
+
+class LaImageGLCM {
+
+public:
+
+    typedef itk::Image<unsigned short, 3> ImageType;
+
+    enum Feature {
+        Energy = 0,
+        Entropy,
+        Correlation,
+        InverseDifferenceMoment,
+        Inertia,
+        ClusterShade,
+        ClusterProminence,
+        HaralickCorrelation,
+        NumberOfFeatures
+    };
+
+    static const int NumberOfDirections = 13;
+
+    static const char* FeatureName(int feature);
+    static void        GetDirection(int direction, int offset[3]);
+
+    LaImageGLCM();
+
+    // ------------------------------------------------------------------
+    // Setup
+    // ------------------------------------------------------------------
+
+    void SetInputImage(const ImageType* image);
+
+    /*
+     * Features are computed around voxels of mask equal to label.
+     */
+    void SetMask(const ImageType* mask, unsigned short label);
+
+    /*
+     * Half-width R of the (2R+1)^3 window.  Default: 1 (3x3x3).
+     */
+    void SetWindowRadius(int radius);
+
+    /*
+     * Grey levels per axis of the co-occurrence matrix.  Default: 16.
+     */
+    void SetNumberOfBins(int bins);
+
+    /*
+     * Intensity range quantised into the bins.  Default: [0, 255].
+     */
+    void SetIntensityRange(int min, int max);
+
+    /*
+     * Directions (0..12) to evaluate.  Default: all 13.
+     */
+    void SetDirections(const std::vector<int>& directions);
+
+    /*
+     * Computes the features of every selected voxel.
+     */
+    void Update();
+
+    // ------------------------------------------------------------------
+    // Results, voxels in memory order (z, then y, then x)
+    // ------------------------------------------------------------------
+
+    std::int64_t GetNumberOfVoxels() const;
+    void         GetVoxel(std::int64_t voxel, int& x, int& y, int& z) const;
+
+    const std::vector<int>& GetDirections() const;
+
+    /*
+     * Feature f of voxel along GetDirections()[slot].
+     */
+    float GetFeature(std::int64_t voxel, int slot, int feature) const;
+
+private:
+
+    const ImageType* _image;
+    const ImageType* _mask;
+    unsigned short   _label;
+    int              _radius;
+    int              _bins;
+    int              _min;
+    int              _max;
+    std::vector<int> _directions;
+
+    std::vector<std::int32_t> _voxel_x;
+    std::vector<std::int32_t> _voxel_y;
+    std::vector<std::int32_t> _voxel_z;
+
+    // [voxel][slot][feature]
+    std::vector<float> _features;
+};
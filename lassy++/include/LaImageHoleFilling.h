@@ -17,6 +17,11 @@
 #define XZ 3
 #define XYZ 4 
 
+#define FILL_MEAN 0             // iterated mean of the non-zero neighbours
+#define FILL_FAST_MARCHING 1    // one pass, ordered by distance to the known voxels (Telea)
+#define FILL_LAPLACE 2          // harmonic fill, multigrid V-cycles
+#define FILL_BIHARMONIC 3       // biharmonic fill, as two coupled multigrid Laplace solves
+
 #include <vtkSmartPointer.h>
 #include <vtkPoints.h>
 #include <vtkCellArray.h>
@@ -39,6 +44,10 @@
 
 class LaImageHoleFilling : public LaImageAlgorithms {
 
+public:
+
+    typedef itk::Image< float, 3 > ImageType;
+
 protected: 
 
     int _iter; 
@@ -46,15 +55,28 @@ protected:
     LaImageFloat* _input_img;
     int _min_neighbours;
     int _interpolate_direction;
+    int _fill_method;
+    int _inpaint_radius;
+
+    /*
+    *   The fill methods, in place on image (FillMean may hand back its other buffer). The
+    *   fast-marching and multigrid fills only fill the holes enclosed by non-zero voxels: zero
+    *   voxels connected to the border of the image are background and are left as they are.
+    */
+    void FillMean(ImageType::Pointer& image);
+    void FillFastMarching(ImageType::Pointer& image);
+    void FillMultigrid(ImageType::Pointer& image, int order);   // order 1: Laplace, 2: biharmonic
 
 public:
 		
 	void SetInputData(LaImageFloat* img);
-    void SetNumberOfIterations(int iterations); 
+    void SetNumberOfIterations(int iterations);     // FILL_MEAN only
     void SetOutputFileName(const char* output_fn);
-    void SetMinNeighboursForMean(int size);
+    void SetMinNeighboursForMean(int size);         // FILL_MEAN only
 	void Update();
     void SetInterpolateDirection(int dir);
+    void SetFillMethod(int method);                 // FILL_MEAN (default), FILL_FAST_MARCHING, FILL_LAPLACE or FILL_BIHARMONIC
+    void SetInpaintRadius(int radius);              // FILL_FAST_MARCHING neighbourhood, in voxels (default 3)
 	//LaShell* GetOutput();
 
     
@@ -10,6 +10,7 @@
 *	The LaImageInPaintMask in paints a mask into a greyscale image. It is assumed that mask was created from a cropped 
 *	version of the greyscale image 
 *   Cropping parameters are (x,y,z,l,w,h)
+*	The output takes the size, spacing, origin and direction of the greyscale image
 */
 #pragma once
 
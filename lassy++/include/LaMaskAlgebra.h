@@ -0,0 +1,141 @@
+/*
+ *  LaMaskAlgebra.h
+ *
+ *  Boolean and label algebra on any number of masks of the same size,
+ *  used by LaMaskBoolOperations.
+ *
+ *  Masks are named A, B, C, ... in the order they are added and combined
+ *  by an expression such as "(A|B)&~C":
+ *
+ *    A         voxels of mask A greater than 0
+ *    A=3       voxels of mask A equal to label 3
+ *    ~X  !X    not
+ *    X&Y       and            X-Y   and not (X&~Y)
+ *    X^Y       exclusive or   X|Y   or
+ *
+ *  in decreasing order of precedence, with parentheses.  Each distinct
+ *  term (mask and label) is packed once into a LaBitMask, one bit per
+ *  voxel, and the expression is evaluated on 64-voxel words, a block of
+ *  words at a time so the operands stay in cache; packing, evaluation and
+ *  unpacking run over contiguous ranges of the buffer (runs of z-slabs)
+ *  in parallel.  The result is written as OutputValue (default 1), or
+ *  with the labels of one of the masks (SetLabelSource), where the
+ *  expression holds and 0 elsewhere.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "itkImage.h"
+
+
+/*
+ * A mask of nx x ny x nz voxels at one bit per voxel, x fastest: voxel i
+ * is bit i % 64 of word i / 64.  Bits past the last voxel are 0.
+ */
+class LaBitMask {
+
+public:
+
+    typedef itk::Image<unsigned short, 3> MaskImageType;
+
+    LaBitMask();
+
+    void Resize(int nx, int ny, int nz);
+
+    /*
+     * Sets the voxels of image greater than 0 or, with label >= 0, equal
+     * to label.  Resizes to the buffered region of image.
+     */
+    void Pack(const MaskImageType* image, int label = -1);
+
+    /*
+     * Writes value where the bit is set and 0 elsewhere into image, whose
+     * buffered region must have the same size.  With labels, writes the
+     * voxel of labels instead of value.
+     */
+    void Unpack(MaskImageType* image, unsigned short value = 1,
+                const MaskImageType* labels = nullptr) const;
+
+    bool Get(int x, int y, int z) const;
+    void Set(int x, int y, int z, bool on);
+
+    /*
+     * Number of voxels set.
+     */
+    std::int64_t Count() const;
+
+    void GetSize(int& nx, int& ny, int& nz) const;
+    std::int64_t GetNumberOfVoxels() const { return _voxels; }
+    std::int64_t GetNumberOfWords() const { return static_cast<std::int64_t>(_words.size()); }
+
+    std::uint64_t* GetWords() { return _words.data(); }
+    const std::uint64_t* GetWords() const { return _words.data(); }
+
+    /*
+     * Zeroes the bits past the last voxel.
+     */
+    void ClearTail();
+
+private:
+
+    int                        _size[3];
+    std::int64_t               _voxels;
+    std::vector<std::uint64_t> _words;
+};
+
+
+class LaMaskAlgebra {
+
+public:
+
+    typedef LaBitMask::MaskImageType MaskImageType;
+
+    LaMaskAlgebra();
+
+    /*
+     * Adds the next mask (A, then B, ...); returns its index.
+     */
+    int AddInput(const MaskImageType* mask);
+
+    void SetExpression(const std::string& expression);
+
+    /*
+     * Value written where the expression holds.  Default: 1.
+     */
+    void SetOutputValue(unsigned short value);
+
+    /*
+     * Writes the labels of input index (0 for A) instead of OutputValue;
+     * -1 (default) for OutputValue.
+     */
+    void SetLabelSource(int index);
+
+    /*
+     * Evaluates the expression; false if it does not parse, names a mask
+     * that was not added, or the masks differ in size.
+     */
+    bool Update();
+
+    /*
+     * Result of the last Update.
+     */
+    const LaBitMask& GetBitMask() const { return _result; }
+
+    /*
+     * Allocates output with the geometry of input A and writes the result
+     * of the last Update into it.
+     */
+    void GetOutput(MaskImageType* output) const;
+
+private:
+
+    std::vector<const MaskImageType*> _inputs;
+    std::string                       _expression;
+    unsigned short                    _output_value;
+    int                               _label_source;
+    LaBitMask                         _result;
+};
@@ -9,6 +9,9 @@
 /*
 *	The LaMaskOperations performs simple boolean operations on two mask
 *
+*	More masks can be added with AddInputData and combined with an expression
+*	(see LaMaskAlgebra.h), the masks being named A, B, C, ... in the order
+*	SetInputData, SetInputData2, AddInputData. 
 */
 #pragma once
 #define BOOL_OR 1 
@@ -18,6 +21,9 @@
 
 #include "LaImageAlgorithms.h"
 
+#include <string>
+#include <vector>
+
 
 
 
@@ -27,7 +33,10 @@ private:
 	LaImage* _mask_img1; 
 	LaImage* _mask_img2;
 	LaImage* _output_img;
+	std::vector<LaImage*> _more_masks; 
 	int _which_operation; 
+	std::string _expression; 
+	bool _succeeded; 
 
 public:
 	// Constructor with default values for data members
@@ -35,16 +44,23 @@ public:
 	
 	void SetInputData(LaImage* image); 
 	void SetInputData2(LaImage* image);
+	void AddInputData(LaImage* image); 
 
 	void Update(); 
 
 	LaImage* GetOutput();
+
+	// false if the last Update() failed, GetOutput() is then unallocated 
+	bool Succeeded() const;
 	
 	void SetBooleanOperationToOR();
 	void SetBooleanOperationToAND();
 	void SetBooleanOperationToXOR();
 	void SetBooleanOperationToANOTB();
 
+	// e.g. "(A|B)&~C", overrides the boolean operation 
+	void SetExpression(const char* expression); 
+
 
 	LaMaskBoolOperations();
 	~LaMaskBoolOperations();
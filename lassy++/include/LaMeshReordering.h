@@ -0,0 +1,107 @@
+/*
+ *  LaMeshReordering.h
+ *
+ *  Space-filling-curve renumbering of the points and cells of a mesh,
+ *  shared by LaShell (vtkPolyData) and LaVolume (vtkUnstructuredGrid).
+ *
+ *  Marching-cubes surfaces and external meshers number vertices in
+ *  whatever order they were generated, so neighbours along the mesh are
+ *  often far apart in memory.  Sorting points by the Morton or Hilbert
+ *  index of their coordinates (21 bits per axis over the bounds), and
+ *  cells by the index of their centroid, puts spatial neighbours next to
+ *  each other — graph traversal, Dijkstra and per-vertex sampling loops
+ *  then walk memory mostly forwards.  Hilbert keeps locality slightly
+ *  better; Morton is cheaper to compute.
+ *
+ *  A Permutation stores new -> old ids.  Apply() permutes the points,
+ *  every point- and cell-data array (active attributes kept) and the
+ *  connectivity in place; Inverse() gives the permutation that restores
+ *  the original numbering, so results can be mapped back to input ids.
+ *  vtkPolyData cells stay grouped by kind (verts, lines, polys, strips)
+ *  as vtkPolyData requires.  Polyhedral cells are not supported.
+ *
+ *  Permutations can be cached on disk next to the mesh.  The cache
+ *  stores the counts and a hash of the point coordinates and is ignored
+ *  when they no longer match.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include <vtkSmartPointer.h>
+#include <vtkPointSet.h>
+#include <vtkPolyData.h>
+#include <vtkUnstructuredGrid.h>
+
+
+class LaMeshReordering {
+
+public:
+
+    enum class Curve {
+        Morton  = 1,
+        Hilbert = 2
+    };
+
+    /*
+     * point_order[new_id] = old_id, likewise for cells.  Empty when no
+     * reordering has been applied.
+     */
+    struct Permutation {
+        std::vector<vtkIdType> point_order;
+        std::vector<vtkIdType> cell_order;
+
+        bool IsEmpty() const { return point_order.empty(); }
+    };
+
+    /*
+     * Computes the curve order of the points and cells of mesh.
+     */
+    static Permutation ComputeOrder(vtkPointSet* mesh, Curve curve);
+
+    /*
+     * Renumbers mesh in place.  Returns false (mesh untouched) if the
+     * permutation does not match the mesh.
+     */
+    static bool Apply(vtkPolyData* mesh, const Permutation& permutation);
+    static bool Apply(vtkUnstructuredGrid* grid, const Permutation& permutation);
+
+    /*
+     * The permutation that undoes permutation.
+     */
+    static Permutation Inverse(const Permutation& permutation);
+
+    /*
+     * ComputeOrder() + Apply(), going through cache_file when it is not
+     * empty: a matching cache is reused, otherwise it is (re)written.
+     * Returns the applied permutation, empty on failure.
+     */
+    static Permutation Reorder(vtkPolyData* mesh, Curve curve,
+                               const std::string& cache_file = "");
+    static Permutation Reorder(vtkUnstructuredGrid* grid, Curve curve,
+                               const std::string& cache_file = "");
+
+    /*
+     * Binary cache of the order of mesh (before reordering).
+     * ReadCache() returns false if the file is missing or stale.
+     */
+    static bool ReadCache(const std::string& cache_file, vtkPointSet* mesh,
+                          Curve curve, Permutation& permutation);
+    static bool WriteCache(const std::string& cache_file, vtkPointSet* mesh,
+                           Curve curve, const Permutation& permutation);
+
+    /*
+     * Curve index of a point quantised to 21 bits per axis.
+     */
+    static std::uint64_t HilbertCode(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+    static std::uint64_t CurveCode(Curve curve, std::uint32_t x, std::uint32_t y, std::uint32_t z);
+
+    /*
+     * Mean |i - j| over consecutive point ids around every cell — a cheap
+     * measure of how far apart neighbouring points are stored.
+     */
+    static double MeanNeighbourIdGap(vtkPointSet* mesh);
+};
@@ -31,6 +31,8 @@
 #include <vtkPointSource.h>
 #include <string>
 #include "LaImage.h"
+#include "LaMeshReordering.h"
+#include "LaShellIO.h"
 
 
 ;
@@ -41,21 +43,48 @@ private:
 	vtkSmartPointer<vtkPolyData> _mesh_3d;
 	vtkSmartPointer<vtkUnstructuredGrid> _ugrid_3d;
 	std::vector<double> _mesh_vertex_values;
+	LaMeshReordering::Permutation _reordering;		// new -> original ids, empty if not reordered
 
 
 public:
 	// Constructor with default values for data members
 	LaShell();
-	LaShell(const char* vtk_filename, bool ugrid_bool=false);
+	LaShell(const char* vtk_filename, bool ugrid_bool=false);		// .vtk, .vtp or .lmsh (see LaShellIO)
 
 	void SetMesh3D(vtkSmartPointer<vtkPolyData> input);
 
 	void GetMesh3D(vtkSmartPointer<vtkPolyData> mesh_output);
+
+	/*
+	*	Zero-copy access to the mesh. GetMesh3DView() returns a new vtkPolyData that shares
+	*	the points, cells and arrays of the shell instead of deep-copying them like GetMesh3D().
+	*	Adding, removing or replacing arrays on the view does not affect the shell, and the shell
+	*	always replaces rather than edits its own data, so a view keeps the state it was taken in.
+	*	Values must not be changed in place through a view: call MakeWritable() on it first
+	*	(copy-on-write), or use GetMesh3D() for a private copy.
+	*/
+	vtkSmartPointer<vtkPolyData> GetMesh3DView() const;
+
+	/*
+	*	Takes input without copying it, e.g. an algorithm output built on a view. The caller must
+	*	not change input's values in place afterwards (MakeWritable() first if it has to).
+	*/
+	void AdoptMesh3D(vtkSmartPointer<vtkPolyData> input);
+
+	/*
+	*	Deep-copies the points, cell arrays and point/cell data of mesh that are still shared
+	*	with another owner, so they can be modified in place. Unshared parts are left alone.
+	*/
+	static void MakeWritable(vtkPolyData* mesh);
+
 	void GetMinimumMaximum(double &min, double& max);		// not implemented yet!
 	/*
-	*	Exports the VTK mesh to a file
+	*	Exports the VTK mesh to a file. The format follows the extension (see LaShellIO):
+	*	.vtk legacy, .vtp XML, .lmsh memory-mappable lassy mesh. Export() takes the
+	*	.vtp encoding and compression options.
 	*/
 	void ExportVTK(const char *vtk_fn);
+	void Export(const char *fn, const LaShellIO::WriteOptions& options = LaShellIO::WriteOptions());
 
 	/*
 	*	Converts a binary 3D image to a smooth mesh.
@@ -76,4 +105,14 @@ public:
 
 	void ComputeMeshNeighbourhoodTransform(vtkSmartPointer<vtkPolyData> new_mesh);
 
+	/*
+	*	Renumbers points and cells along a space-filling curve so that mesh neighbours
+	*	sit close in memory (see LaMeshReordering). The order is read from / written to
+	*	cache_fn when given. GetReordering() maps new ids back to the original ones and
+	*	RestoreOriginalOrder() undoes the renumbering, e.g. before export.
+	*/
+	void Reorder(LaMeshReordering::Curve curve = LaMeshReordering::Curve::Morton, const char* cache_fn = NULL);
+	void RestoreOriginalOrder();
+	const LaMeshReordering::Permutation& GetReordering() const;
+
 };
@@ -62,6 +62,7 @@
 #include <string>
 #include <sstream>
 #include <array>
+#include <map>
 #include <vtkPointPicker.h>
 
 #include "LaShellAlgorithms.h"
@@ -100,6 +101,18 @@ public:
     std::vector<std::array<double, 3> > _pickpositionarray;
     std::vector<int> _corridoridarray;
     std::vector<vtkSmartPointer<vtkPolyDataMapper> > _pathMappers;			// container to store shortest paths between points selected by user
+    std::vector<vtkSmartPointer<vtkActor> > _sphere_actors;				// one sphere per picked point, popped on undo
+
+    /*
+    *	A shortest path between two picked vertices together with the actor drawing it.
+    *	Segments are cached by (start, end) vertex so that pressing 'l' or 'c' again only
+    *	computes the segments touched by points added or removed since the last press.
+    */
+    struct PathSegment {
+        vtkSmartPointer<vtkDijkstraGraphGeodesicPath> dijkstra;
+        vtkSmartPointer<vtkActor> actor;
+    };
+    std::map<std::pair<vtkIdType, vtkIdType>, PathSegment> _segment_cache;
 
     // Helper Functions
     int RecursivePointNeighbours(vtkIdType pointId, int order);
@@ -117,11 +130,13 @@ public:
 		void ExtractCorridorData(std::vector<vtkSmartPointer<vtkDijkstraGraphGeodesicPath> > allShortestPaths);
 		void getCorridorPoints(std::vector<vtkSmartPointer<vtkDijkstraGraphGeodesicPath> > allShortestPaths);
 		bool InsertPointIntoVisitedList2(vtkIdType id, int order);
+		void UpdatePathSegments(vtkSmartPointer<vtkRenderer> renderer, bool close_loop);
+		void RemoveLastPickedPoint(vtkSmartPointer<vtkRenderer> renderer);
 
 
     // Static functions
     static void KeyPressEventHandler(vtkObject* obj, unsigned long,void *sr, void *v);
-    static void CreateSphere(vtkSmartPointer<vtkRenderer> iren, double radius, double position3D[]);
+    static vtkSmartPointer<vtkActor> CreateSphere(vtkSmartPointer<vtkRenderer> iren, double radius, double position3D[]);
 		static vtkIdType GetFirstCellVertex(vtkPolyData* poly, vtkIdType cellID, double point_xyz[]);
     // Get functions
     void GetConnectedVertices(vtkSmartPointer<vtkPolyData> mesh, int seed, vtkSmartPointer<vtkIdList> connectedVertices);
@@ -129,6 +144,7 @@ public:
     vtkSmartPointer<vtkRenderWindowInteractor> GetWindowInteractor();
     vtkSmartPointer<vtkCellPicker> GetCellPicker();
     const std::vector<std::array<double, 3>> &GetPickedPositions() const;
+    const std::vector<int> &GetPickedPointIds() const;
 
     void Run();
 		void CorridorFromPointList(std::vector<int> points);
@@ -0,0 +1,75 @@
+/*
+ *  LaShellIO.h
+ *
+ *  Reading and writing of LaShell meshes (vtkPolyData), format chosen
+ *  from the file extension:
+ *
+ *    .vtk   — legacy VTK (vtkPolyDataReader / vtkPolyDataWriter)
+ *    .vtp   — VTK XML PolyData, ascii, binary or appended, optionally
+ *             zlib-compressed
+ *    .lmsh  — lassy mesh: a raw binary container that is memory-mapped
+ *             on load
+ *
+ *  A .lmsh file is a table of contents followed by the raw payloads:
+ *
+ *    "LAMESH01"  uint32 byte-order mark 0x01020304  uint32 entry count
+ *    per entry   uint32 section, int32 VTK type, int32 components,
+ *                int32 attribute, int64 tuples, uint64 offset,
+ *                uint64 bytes, uint32 name length, uint32 0, name
+ *    payloads    each starting on a 4096-byte boundary
+ *
+ *  Sections are the points, the offsets and connectivity (int64) of
+ *  verts, lines, polys and strips, and the numeric point, cell and field
+ *  arrays; attribute is the vtkDataSetAttributes attribute type the
+ *  array is active for (-1 for none, or the cell block for cells).
+ *
+ *  On load every payload is mapped copy-on-write (MAP_PRIVATE) straight
+ *  into its VTK array, so opening a mesh costs no parsing and no copy:
+ *  pages are read on first access and written pages become private to
+ *  the process.  Payloads that cannot be mapped (page size above 4096,
+ *  Windows) are read instead.  Files are written in host byte order and
+ *  rejected on a host with the other one.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <string>
+
+#include <vtkPolyData.h>
+
+
+class LaShellIO {
+
+public:
+
+    struct WriteOptions {
+        enum class Encoding {
+            Default,        // .vtk ascii, .vtp appended
+            Ascii,
+            Binary,
+            Appended        // .vtp only; binary elsewhere
+        };
+
+        Encoding encoding;
+        bool     compress;  // .vtp: zlib-compress the data blocks
+
+        WriteOptions() : encoding(Encoding::Default), compress(true) {}
+    };
+
+    static const char* NativeExtension;     // ".lmsh"
+
+    /*
+     * Reads filename into mesh, replacing its contents.  Returns false
+     * (mesh untouched) if the file cannot be read.
+     */
+    static bool Read(const std::string& filename, vtkPolyData* mesh);
+
+    static bool Write(const std::string& filename, vtkPolyData* mesh,
+                      const WriteOptions& options = WriteOptions());
+
+    /*
+     * The lassy mesh container on its own, whatever the extension.
+     */
+    static bool ReadNative(const std::string& filename, vtkPolyData* mesh);
+    static bool WriteNative(const std::string& filename, vtkPolyData* mesh);
+};
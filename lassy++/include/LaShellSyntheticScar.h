@@ -17,6 +17,11 @@
  *  existing arrays are never overwritten.  Multiple calls on the same mesh
  *  can therefore layer independent scar regions.
  *
+ *  Neighbourhoods are expanded by BFS over a LaVolumeGraphTraversal
+ *  adjacency index built once per Update().  The per-vertex distances to
+ *  nearby path vertices are cached in a LaSyntheticScarField, which
+ *  applies the falloff kernel as a vectorised transform.
+ *
  *  Input mesh must be vtkPolyData.  UnstructuredGrid support is deferred
  *  to a future pass — use the ugrid2vtk application to convert beforehand.
  */
@@ -36,6 +41,8 @@
 #include <vtkMath.h>
 
 #include "LaShellAlgorithms.h"
+#include "LaVolumeGraphTraversal.h"
+#include "LaSyntheticScarField.h"
 #include "LaShell.h"
 
 enum class FalloffKernel : int {
@@ -58,36 +65,16 @@ private:
     FalloffKernel _falloff;         // kernel choice
     std::string _output_array_name; // base name, auto-suffixed when taken
 
-    // visited list used during recursive neighbourhood traversal —
-    // same pattern as LaShellGapsInBinary
-    std::vector<std::pair<vtkIdType, int>> _visited_point_list;
+    // adjacency index over _source_poly, shared read-only by all threads
+    std::unique_ptr<LaVolumeGraphTraversal> _graph;
+
+    // variants written by the last UpdateSweep() call
+    std::vector<LaSyntheticScarField::Variant> _sweep_variants;
 
     // ----------------------------------------------------------------
     // Internal helpers
     // ----------------------------------------------------------------
 
-    /*
-     * Recursively collects N-order neighbours of pointId into
-     * _visited_point_list.  Mirrors LaShellGapsInBinary::RecursivePointNeighbours
-     * exactly so behaviour is consistent with the rest of the library.
-     */
-    void RecursivePointNeighbours(vtkIdType point_id, int order);
-
-    /*
-     * Fills connectedVertices with the 1-ring neighbours of seed on mesh.
-     * Direct port of LaShellGapsInBinary::GetConnectedVertices.
-     */
-    void GetConnectedVertices(vtkSmartPointer<vtkPolyData> mesh,
-                              int seed,
-                              vtkSmartPointer<vtkIdList> connected_vertices);
-
-    /*
-     * Returns all vertices reachable within _neighbourhood_size hops of
-     * point_id, together with their traversal depth.
-     */
-    void GetNeighboursAroundPoint(int point_id,
-                                  std::vector<std::pair<int, int>> &neighbours);
-
     /*
      * Builds Dijkstra paths between consecutive seeds, closing the loop
      * back to seed[0].  Returns all vertex IDs lying on any path segment,
@@ -95,19 +82,6 @@ private:
      */
     std::vector<vtkIdType> BuildPathVertices();
 
-    /*
-     * Euclidean distance between two 3D points stored as double[3] arrays.
-     */
-    static double Euclidean(const double *a, const double *b);
-
-    /*
-     * Evaluates the chosen falloff kernel.
-     *   d         — distance from corridor point to nearest path vertex
-     *   max_d     — normalisation distance (neighbourhood radius in world units)
-     * Returns a value in [0, 1]; 1 at d == 0, decaying to 0 at d == max_d.
-     */
-    double EvaluateFalloff(double d, double max_d) const;
-
     /*
      * Scans existing point data arrays on poly for a name collision with
      * candidate.  If found, appends _1, _2, ... until the name is unique.
@@ -192,6 +166,24 @@ public:
 
     void Update();
 
+    /*
+     * Sweep mode.  Builds the path, the adjacency index and the
+     * distance-to-path field once, for the largest neighbourhood size,
+     * then evaluates every (neighbourhood, falloff, sigma) combination
+     * from the cached field.  Each variant is added to the output mesh as
+     * its own array, named <output_array_name>_n<N>_f<F>[_s<sigma>].
+     * Sigma only applies to the Gaussian falloff; an empty sigma list
+     * uses SetSigma() (or auto).  Replaces one process per combination.
+     */
+    void UpdateSweep(const std::vector<int> &neighbourhood_sizes,
+                     const std::vector<int> &falloffs,
+                     const std::vector<double> &sigmas);
+
+    /*
+     * Variants evaluated by the last UpdateSweep(), in output order.
+     */
+    const std::vector<LaSyntheticScarField::Variant> &GetSweepVariants() const;
+
     LaShell *GetOutput();
 
     LaShellSyntheticScar();
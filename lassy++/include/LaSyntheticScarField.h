@@ -0,0 +1,170 @@
+/*
+ *  LaSyntheticScarField.h
+ *
+ *  Cached distance-to-path field shared by LaShellSyntheticScar and
+ *  LaVolumeSyntheticScar.
+ *
+ *  Build() expands the neighbourhood of every path vertex once, for the
+ *  largest hop count of interest, and stores every (path vertex, node)
+ *  contribution grouped by the receiving node: its hop depth and its
+ *  distance to the path vertex — Euclidean by default, or geodesic
+ *  (along mesh edges, within the neighbourhood) when built with
+ *  geodesic = true, so every kernel falls off along the mesh.  The
+ *  entries of a node are sorted by hop depth, so the contributions for
+ *  any smaller neighbourhood form a prefix of its list.
+ *
+ *  Accumulate() then evaluates a falloff kernel for any neighbourhood
+ *  size up to the built one and any sigma, without touching the graph
+ *  again.  Update() in both synthetic-scar classes evaluates one kernel;
+ *  sweep mode evaluates every (neighbourhood, falloff, sigma) combination
+ *  from one Build().
+ *
+ *  Kernels are applied as transforms over the contiguous float distance
+ *  array (branch-free loops the compiler vectorises), followed by a
+ *  per-node sum.  Adding a kernel means adding a transform in
+ *  LaSyntheticScarField.cxx — the traversal code is not involved.
+ *
+ *  Kernels are identified by the integer values of FalloffKernel and
+ *  VolumeFalloffKernel (1 = Gaussian, 2 = Linear), which are also the
+ *  values accepted by the -falloff option of the command-line tools.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <vtkSmartPointer.h>
+#include <vtkDataSet.h>
+#include <vtkFloatArray.h>
+
+#include "LaVolumeGraphTraversal.h"
+
+
+class LaSyntheticScarField {
+
+public:
+
+    /*
+     * One evaluated combination in a parameter sweep, together with the
+     * name of the point-data array it was written to.
+     * sigma <= 0 means auto (corridor radius / 2); unused for Linear.
+     */
+    struct Variant {
+        int         neighbourhood_size;
+        int         falloff;
+        double      sigma;
+        std::string array_name;
+    };
+
+    LaSyntheticScarField();
+    ~LaSyntheticScarField() = default;
+
+    /*
+     * Expands max_hops around every path vertex using graph (which must
+     * already be built over points) and caches the contributions.
+     * geodesic: distances along graph edges instead of straight lines;
+     * graph must then use Euclidean edge weights.
+     * Path vertices are processed in parallel with vtkSMPTools.
+     */
+    void Build(const LaVolumeGraphTraversal& graph,
+               vtkDataSet* points,
+               const std::vector<vtkIdType>& path_vertices,
+               int max_hops,
+               bool geodesic = false);
+
+    /*
+     * Sums the kernel over every cached contribution within hops of a
+     * path vertex, writing one value per node into accumulator.
+     *   max_d — corridor radius in world units (linear cut-off)
+     *   sigma — Gaussian sigma; <= 0 selects max_d / 2
+     * hops is clamped to the value Build() was called with.
+     */
+    void Accumulate(int falloff,
+                    int hops,
+                    double max_d,
+                    double sigma,
+                    std::vector<double>& accumulator) const;
+
+    /*
+     * Distance from each node to its nearest path vertex within the built
+     * neighbourhood; -1 for nodes outside the corridor.
+     */
+    const std::vector<float>& GetNearestPathDistance() const;
+
+    vtkIdType GetNumberOfPoints() const;
+    size_t    GetNumberOfEntries() const;
+    int       GetMaxHops() const;
+
+    // ------------------------------------------------------------------
+    // Static utilities
+    // ------------------------------------------------------------------
+
+    /*
+     * Array name for a sweep variant, e.g. synthetic_scar_n15_f1_s3.
+     * The sigma suffix is omitted for Linear and reads "sauto" for auto.
+     */
+    static std::string VariantName(const std::string& base,
+                                   int neighbourhood_size,
+                                   int falloff,
+                                   double sigma);
+
+    /*
+     * Wraps accumulator, divided by its maximum, as a float point-data
+     * array.  Returns nullptr if every value is zero.
+     */
+    static vtkSmartPointer<vtkFloatArray> NormalisedArray(
+        const std::vector<double>& accumulator,
+        const std::string& name);
+
+    /*
+     * Comma-separated values of a sweep option, e.g. "5,10,15"; items
+     * that do not parse are skipped.
+     */
+    template <typename T>
+    static std::vector<T> ParseList(const std::string& csv);
+
+    /*
+     * One file per variant (--sweep-split): calls write(data, filename)
+     * with a shallow copy of data holding only that variant's array, for
+     * <stem>_n<N>_f<F>[_s<S>]<ext> built from filename (.vtk if it has
+     * no extension).
+     */
+    static void SplitVariants(
+        vtkDataSet* data,
+        const std::vector<Variant>& variants,
+        const std::string& filename,
+        const std::function<void(vtkDataSet*, const std::string&)>& write);
+
+private:
+
+    vtkIdType _num_points;
+    int       _max_hops;
+
+    /*
+     * CSR layout by receiving node: entries of node v are stored in
+     * [_offsets[v], _offsets[v + 1]) of _hops and _distances, sorted by
+     * (hop, distance).
+     */
+    std::vector<size_t>         _offsets;
+    std::vector<unsigned short> _hops;
+    std::vector<float>          _distances;
+    std::vector<float>          _nearest;
+};
+
+
+template <typename T>
+std::vector<T> LaSyntheticScarField::ParseList(const std::string& csv) {
+    std::vector<T> values;
+    std::stringstream ss(csv);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (item.empty()) continue;
+        std::istringstream item_ss(item);
+        T value;
+        if (item_ss >> value) values.push_back(value);
+    }
+    return values;
+}
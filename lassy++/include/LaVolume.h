@@ -7,14 +7,29 @@
  *  Supported I/O:
  *    .vtk  — legacy VTK unstructured grid format
  *    .vtu  — VTK XML unstructured grid format
+ *    .pts + .elem (+ .lon) — CARP mesh, read and written natively by
+ *            LaVolumeCarpIO; .dat files carry per-node or per-element data
  *
- *  CARP (.pts + .elem) support is deferred to a future pass.
+ *  VTK readers' output is shallow-copied into the grid: the arrays are
+ *  taken over by reference, so loading never holds two copies of the
+ *  mesh.  LaVolumePartition splits a loaded grid into Morton-ordered
+ *  chunks with ghost layers for algorithms that run chunk by chunk.
+ *
+ *  ConvertToSurface() keeps the volume point and cell id of every surface
+ *  point and cell, and stores both directions of the point mapping on the
+ *  volume, so picked surface points, surface scalars and surface cells
+ *  map back to the volume in O(1) without a spatial search.
+ *
+ *  Geodesic distance fields are computed over an edge graph of the grid
+ *  (LaVolumeGraphTraversal, Euclidean weights) that is built on first use
+ *  and kept until the grid is replaced.
  */
 #pragma once
 #define HAS_VTK 1
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <vtkSmartPointer.h>
 #include <vtkUnstructuredGrid.h>
@@ -29,12 +44,29 @@
 #include <vtkSmartPointer.h>
 
 #include "LaShell.h"
+#include "LaMeshReordering.h"
+#include "LaVolumeCarpIO.h"
+#include "LaVolumeGraphTraversal.h"
 
 class LaVolume {
 
 private:
     vtkSmartPointer<vtkUnstructuredGrid> _grid;
 
+    // edge graph over _grid, built lazily by GetGraph()
+    std::unique_ptr<LaVolumeGraphTraversal> _graph;
+
+    // new -> original ids after Reorder(); empty otherwise
+    LaMeshReordering::Permutation _reordering;
+
+    // Mappings recorded by the last ConvertToSurface(); cleared when the
+    // grid is replaced.  -1 marks interior volume nodes.
+    std::vector<vtkIdType> _surface_to_volume_points;
+    std::vector<vtkIdType> _volume_to_surface_points;
+    std::vector<vtkIdType> _surface_to_volume_cells;
+
+    void ClearSurfaceMapping();
+
     /*
      * Detects file format from extension.
      * Returns true for .vtu, false for .vtk.
@@ -47,7 +79,7 @@ public:
 
     /*
      * Loads a volumetric mesh from file.
-     * Supported extensions: .vtk, .vtu
+     * Supported extensions: .vtk, .vtu, .pts / .elem
      */
     explicit LaVolume(const char *filename);
 
@@ -75,10 +107,48 @@ public:
     // I/O
     // ------------------------------------------------------------------
 
+    /*
+     * .pts or .elem loads the CARP mesh stem.pts + stem.elem, plus the
+     * fibres of stem.lon when that file exists.
+     */
     void ImportFile(const char *filename);
     void ExportVTK(const char *filename) const;
     void ExportVTU(const char *filename) const;
 
+    /*
+     * Writes stem.pts and stem.elem.  Region tags come from the cell-data
+     * array "elemTag" when present.
+     */
+    void ExportCARP(const char *stem) const;
+
+    /*
+     * Writes the point- (or, failing that, cell-) data array array_name
+     * as a CARP .dat file, one value per line.
+     */
+    void ExportCARPData(const char *array_name, const char *filename) const;
+
+    /*
+     * Reads a .dat file as array_name: point data if it has one value per
+     * node, cell data if it has one per element.
+     */
+    void ImportCARPData(const char *filename, const char *array_name);
+
+    // ------------------------------------------------------------------
+    // Locality
+    // ------------------------------------------------------------------
+
+    /*
+     * Renumbers points and cells along a space-filling curve so traversal
+     * and per-node loops touch memory in order (LaMeshReordering).  The
+     * order is read from / written to cache_file when given.  Graph and
+     * surface mapping are reset.  GetReordering() maps the new ids back
+     * to the original ones; RestoreOriginalOrder() undoes the renumbering.
+     */
+    void Reorder(LaMeshReordering::Curve curve = LaMeshReordering::Curve::Morton,
+                 const char *cache_file = nullptr);
+    void RestoreOriginalOrder();
+    const LaMeshReordering::Permutation &GetReordering() const;
+
     // ------------------------------------------------------------------
     // Conversion
     // ------------------------------------------------------------------
@@ -87,7 +157,46 @@ public:
      * Extracts the outer surface of the volumetric mesh using
      * vtkDataSetSurfaceFilter and returns it as a LaShell.
      * Replaces the ugrid2vtk application workflow programmatically.
+     * The surface carries vtkOriginalPointIds / vtkOriginalCellIds, and
+     * the point and cell mappings are stored on this volume.
      * Caller owns the returned pointer.
      */
-    LaShell *ConvertToSurface() const;
+    LaShell *ConvertToSurface();
+
+    /*
+     * Lookups into the mapping of the last ConvertToSurface().
+     * Return -1 for ids out of range, interior nodes, or no mapping.
+     */
+    bool HasSurfaceMapping() const;
+    vtkIdType SurfaceToVolumePoint(vtkIdType surface_point_id) const;
+    vtkIdType VolumeToSurfacePoint(vtkIdType volume_point_id) const;
+    vtkIdType SurfaceToVolumeCell(vtkIdType surface_cell_id) const;
+
+    /*
+     * Copies a point-data array of the extracted surface onto the volume
+     * nodes it came from, adding (or replacing) a point-data array of the
+     * same name and type.  Interior nodes get fill_value.
+     */
+    void ScatterSurfaceArray(vtkDataArray *surface_array, double fill_value = 0.0);
+
+    // ------------------------------------------------------------------
+    // Geodesic distance
+    // ------------------------------------------------------------------
+
+    /*
+     * Edge graph of the grid with Euclidean weights, built on first call
+     * and reused until SetGrid() / ImportFile() replace the grid.
+     */
+    const LaVolumeGraphTraversal &GetGraph();
+
+    /*
+     * Adds a float point-data array array_name holding the distance along
+     * mesh edges from each node to the nearest of seed_ids — unlike the
+     * straight-line distance it does not cut through cavities.  Nodes
+     * beyond max_distance (<= 0: no limit) get -1.  Seed groups are
+     * searched in parallel.  An existing array of that name is replaced.
+     */
+    void ComputeGeodesicDistance(const std::vector<vtkIdType> &seed_ids,
+                                 double max_distance,
+                                 const char *array_name = "geodesic_distance");
 };
\ No newline at end of file
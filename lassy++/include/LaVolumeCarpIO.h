@@ -0,0 +1,83 @@
+/*
+ *  LaVolumeCarpIO.h
+ *
+ *  Streaming reader and writer for CARP (openCARP / CARPentry) meshes,
+ *  used by LaVolume for .pts / .elem input and output.
+ *
+ *    .pts   — "N", then N lines "x y z"
+ *    .elem  — "M", then M lines "<type> n0 .. nk [region]"
+ *             types: Ln Tr Qd Tt Py Pr Hx
+ *    .lon   — optional "1" / "2" header, then M lines of 3 (fibre) or
+ *             6 (fibre + sheet) components
+ *    .dat   — one value per line, per node or per element
+ *
+ *  Input files are memory-mapped and parsed in parallel chunks split at
+ *  line boundaries (vtkSMPTools): a counting pass gives every chunk the
+ *  index of its first record, then each chunk parses with std::from_chars
+ *  straight into the points, connectivity, offsets and cell-type arrays
+ *  of the grid — no vtkIdList or intermediate container per cell.
+ *  Writers format chunks in parallel and write them in order.
+ *
+ *  Node order within an element is read as VTK's (first face, then the
+ *  apex or the matching corners of the opposite face); 3D elements whose
+ *  first face is wound against VTK's convention are mirrored into it, so
+ *  cells have positive volume.  Writing keeps VTK's order.
+ *  Region tags are kept as the int cell-data array "elemTag"; fibres as
+ *  "fibres" and, for two-direction .lon files, "sheets".
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <string>
+
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+#include <vtkDataArray.h>
+#include <vtkFloatArray.h>
+
+
+class LaVolumeCarpIO {
+
+public:
+
+    static const char* RegionArrayName;     // "elemTag"
+    static const char* FibreArrayName;      // "fibres"
+    static const char* SheetArrayName;      // "sheets"
+
+    /*
+     * Reads pts_file and elem_file into grid, replacing its contents.
+     * Returns false (grid untouched) on any parse or consistency error.
+     */
+    static bool ReadMesh(const std::string& pts_file,
+                         const std::string& elem_file,
+                         vtkUnstructuredGrid* grid);
+
+    /*
+     * Reads a .lon file with one record per cell of grid and adds the
+     * fibre (and sheet) directions as cell data.
+     */
+    static bool ReadFibres(const std::string& lon_file,
+                           vtkUnstructuredGrid* grid);
+
+    /*
+     * Reads a .dat file as a single-component float array named name.
+     * Returns nullptr on error.
+     */
+    static vtkSmartPointer<vtkFloatArray> ReadData(const std::string& dat_file,
+                                                   const char* name);
+
+    /*
+     * Writes the points and cells of grid.  Cells without a CARP type
+     * (vertices, polygons, quadratic cells, ...) are skipped with a
+     * warning.  Region tags come from "elemTag" when present, else 0.
+     */
+    static bool WriteMesh(vtkUnstructuredGrid* grid,
+                          const std::string& pts_file,
+                          const std::string& elem_file);
+
+    /*
+     * Writes one tuple of array per line (components space-separated).
+     */
+    static bool WriteData(vtkDataArray* array,
+                          const std::string& dat_file);
+};
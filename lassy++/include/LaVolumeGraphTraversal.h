@@ -5,17 +5,40 @@
  *
  *  VTK provides vtkDijkstraGraphGeodesicPath for vtkPolyData but has no
  *  equivalent for vtkUnstructuredGrid.  This class fills that gap by
- *  building an adjacency list from cell connectivity and exposing:
+ *  building a graph from the cell edges and exposing:
  *
  *    - Dijkstra shortest paths between two nodes
+ *    - Geodesic (edge-path) distance fields from many sources
  *    - N-order neighbourhood expansion around a node
  *    - Euclidean edge weighting (optional; topology-only by default)
+ *    - Edge length statistics (mean, median, per-node local length),
+ *      cached until the next Build()
  *
  *  Build() must be called once after SetInputGrid() before any queries.
  *  The graph is invalidated if the grid changes — call Build() again.
  *
- *  Implementation uses std::priority_queue (standard library only,
- *  no additional dependencies).
+ *  Any vtkDataSet is accepted, so LaShellSyntheticScar shares the same
+ *  adjacency index for vtkPolyData surfaces.  All queries are const and
+ *  safe to call concurrently from several threads once Build() returns.
+ *
+ *  The graph is stored in compressed sparse row (CSR) form: the
+ *  neighbours of node i are _targets[_offsets[i] .. _offsets[i + 1]),
+ *  sorted by id, with float weights alongside.  Node ids are stored as
+ *  32-bit NodeIndex values, which halves the footprint of the index on
+ *  large grids; the public API still speaks vtkIdType.
+ *
+ *  Only true cell edges are inserted (tetra: 6, hexahedron: 12, ...),
+ *  taken from per-type edge tables for the common linear cells and from
+ *  vtkCell::GetEdge() for everything else — so hexahedron face and body
+ *  diagonals are not edges.  Build() runs over cells in parallel with
+ *  vtkSMPTools.
+ *
+ *  Queries run in a per-thread workspace (vtkSMPThreadLocal) that is
+ *  allocated once per graph and reset lazily: only the nodes a query
+ *  touched are cleared afterwards, so a short path on a large grid costs
+ *  what it explores, not O(N).  Dijkstra uses a radix heap keyed on the
+ *  bit pattern of the (non-negative, float) tentative distance; BFS marks
+ *  visited nodes with a generation stamp, so it needs no reset at all.
  */
 #pragma once
 #define HAS_VTK 1
@@ -24,8 +47,11 @@
 #include <utility>
 #include <limits>
 #include <cmath>
+#include <cstdint>
 
 #include <vtkSmartPointer.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkDataSet.h>
 #include <vtkUnstructuredGrid.h>
 #include <vtkIdList.h>
 
@@ -44,6 +70,27 @@ public:
         Topological = 2
     };
 
+    /*
+     * Node id as stored in the CSR arrays.  Grids with more than
+     * 2^31 - 1 points are rejected by Build().
+     */
+    using NodeIndex = std::int32_t;
+
+    /*
+     * Euclidean edge length statistics over the unique edges of the graph.
+     * local[i] is the mean length of the edges incident to node i (0 for
+     * isolated nodes) and converts a hop count around node i to world
+     * units; mean / median do the same for the whole mesh.
+     */
+    struct EdgeStatistics {
+        double              mean;
+        double              median;
+        double              min;
+        double              max;
+        size_t              num_edges;
+        std::vector<double> local;
+    };
+
     LaVolumeGraphTraversal();
     ~LaVolumeGraphTraversal() = default;
 
@@ -51,12 +98,12 @@ public:
     // Setup
     // ------------------------------------------------------------------
 
-    void SetInputGrid(vtkUnstructuredGrid* grid);
+    void SetInputGrid(vtkDataSet* grid);
 
     /*
-     * Builds the adjacency list from cell connectivity.
+     * Builds the CSR graph from the cell edges.
      * Must be called before ShortestPath() or GetNeighboursAroundPoint().
-     * Complexity: O(C * V_per_cell) where C = number of cells.
+     * Complexity: O(E log E) where E = number of cell edges, in parallel.
      */
     void Build();
 
@@ -76,6 +123,28 @@ public:
     std::vector<vtkIdType> ShortestPath(vtkIdType start_id,
                                         vtkIdType end_id) const;
 
+    /*
+     * One Dijkstra search from source_id that stops once every target is
+     * settled.  Returns one path per entry of target_ids, in the same
+     * order, each from source_id to the target inclusive; a path is empty
+     * if the target is unreachable or out of range.
+     */
+    std::vector<std::vector<vtkIdType>> ShortestPaths(
+        vtkIdType                     source_id,
+        const std::vector<vtkIdType>& target_ids) const;
+
+    /*
+     * Distance along graph edges from every node to the nearest of
+     * source_ids, and that source's id.  Nodes further than max_distance
+     * (<= 0: no limit) get distance -1 and source -1.  Sources are split
+     * into one group per thread, each searched with a single multi-source
+     * Dijkstra; results are merged by minimum (ties to the lower id).
+     */
+    void GetDistanceToPoints(const std::vector<vtkIdType>& source_ids,
+                             double                        max_distance,
+                             std::vector<float>&           distance,
+                             std::vector<vtkIdType>&       nearest_source) const;
+
     /*
      * Returns all nodes reachable within max_hops topological hops of
      * point_id, paired with their hop depth.
@@ -85,12 +154,59 @@ public:
         vtkIdType point_id,
         int       max_hops) const;
 
+    /*
+     * As above, writing into result (cleared first) so callers that
+     * expand many points can reuse one buffer and allocate nothing.
+     */
+    void GetNeighboursAroundPoint(vtkIdType point_id,
+                                  int       max_hops,
+                                  std::vector<std::pair<vtkIdType, int>>& result) const;
+
+    /*
+     * As above, with distance[i] the distance along graph edges from
+     * point_id to result[i], through nodes of the neighbourhood only —
+     * the geodesic distance in world units with Euclidean edge weights.
+     */
+    void GetNeighboursAroundPoint(vtkIdType point_id,
+                                  int       max_hops,
+                                  std::vector<std::pair<vtkIdType, int>>& result,
+                                  std::vector<float>& distance) const;
+
+    /*
+     * One BFS from all of source_ids at once.  For every node, hops gets
+     * its hop distance to the nearest source and nearest_source that
+     * source's id; both are -1 for nodes further than max_hops.  Between
+     * equidistant sources the one listed first wins.
+     */
+    void GetNeighboursAroundPoints(const std::vector<vtkIdType>& source_ids,
+                                   int                           max_hops,
+                                   std::vector<int>&             hops,
+                                   std::vector<vtkIdType>&       nearest_source) const;
+
+    /*
+     * Edge length statistics, computed in one parallel pass over the
+     * adjacency on first use and cached until Build() is called again.
+     * Not thread-safe on the first call — call once before sharing the
+     * graph between threads.
+     */
+    const EdgeStatistics& GetEdgeStatistics();
+
+    /*
+     * World-space length of hops edges, using the mean edge length.
+     */
+    double HopsToDistance(int hops);
+
     /*
      * Returns the number of nodes in the graph.
      * 0 if Build() has not been called.
      */
     vtkIdType GetNumberOfNodes() const;
 
+    /*
+     * Returns the number of unique undirected edges in the graph.
+     */
+    size_t GetNumberOfEdges() const;
+
     // ------------------------------------------------------------------
     // Static utilities
     // ------------------------------------------------------------------
@@ -99,20 +215,117 @@ public:
 
 private:
 
-    vtkUnstructuredGrid* _grid;     // non-owning, caller retains ownership
+    /*
+     * Monotone min-priority queue for Dijkstra: keys are the IEEE bit
+     * patterns of non-negative floats, which order like the floats, and
+     * are never smaller than the last key popped.  Bucket b > 0 holds keys
+     * whose highest bit differing from the last popped key is bit b - 1.
+     */
+    class RadixHeap {
+    public:
+        RadixHeap();
+        void      Push(float key, NodeIndex node);
+        NodeIndex Pop(float& key);
+        bool      Empty() const { return _size == 0; }
+        void      Clear();
+    private:
+        std::vector<std::pair<std::uint32_t, NodeIndex>> _buckets[33];
+        std::uint32_t _last;
+        size_t        _size;
+    };
+
+    /*
+     * Per-thread query state sized to the graph, allocated per kind on the
+     * first query that needs it — Dijkstra state (dist, predecessor,
+     * origin, target) and BFS state (stamp, queue) — and released by
+     * Build() and with the traversal.  Between queries dist is +inf,
+     * predecessor -1 and target 0 everywhere; touched lists the entries a
+     * query changed so they can be restored.  origin is the source a node
+     * was reached from; it is only read where dist is set, so it is never
+     * reset.  BFS treats a node as visited when stamp equals the current
+     * generation, and uses queue as its FIFO: every node enters at most
+     * once, so N slots never wrap.  level_starts[d] is where depth d
+     * begins in queue.
+     */
+    struct QueryWorkspace {
+        std::vector<float>         dist;
+        std::vector<NodeIndex>     predecessor;
+        std::vector<NodeIndex>     origin;
+        std::vector<unsigned char> target;
+        std::vector<NodeIndex>     touched;
+        RadixHeap                  heap;
+
+        std::vector<std::uint32_t> stamp;
+        std::uint32_t              generation = 0;
+        std::vector<NodeIndex>     queue;
+        std::vector<size_t>        level_starts;
+    };
+
+    enum WorkspaceState : unsigned {
+        DijkstraState = 1,
+        BFSState      = 2
+    };
+
+    /*
+     * This thread's workspace with the given states allocated.
+     */
+    QueryWorkspace& LocalWorkspace(unsigned parts) const;
+
+    /*
+     * Frees every thread's workspace.
+     */
+    void ReleaseWorkspaces();
+
+    /*
+     * Dijkstra in three steps: seed one or more sources at distance 0,
+     * run (relaxing only up to cutoff, and stopping once remaining marked
+     * targets are settled if remaining > 0), then lazily reset.
+     */
+    void SeedDijkstra(QueryWorkspace& ws, NodeIndex source) const;
+    void RunDijkstra(QueryWorkspace& ws, float cutoff, size_t remaining) const;
+    void ResetDijkstra(QueryWorkspace& ws) const;
+
+    /*
+     * Starts a BFS: bumps the generation, clearing the stamps only when
+     * the counter wraps.
+     */
+    static void NextGeneration(QueryWorkspace& ws);
+
+    /*
+     * Expands ws.queue[0, num_seeds) — already stamped — level by level
+     * up to max_hops and fills ws.level_starts.  If nearest_source is
+     * given, each new node inherits the entry of the node it was reached
+     * from.  Returns the number of nodes visited.
+     */
+    size_t ExpandBFS(QueryWorkspace& ws,
+                     size_t          num_seeds,
+                     int             max_hops,
+                     vtkIdType*      nearest_source) const;
+
+    vtkDataSet*          _grid;     // non-owning, caller retains ownership
     EdgeWeight           _weight_mode;
     bool                 _built;
 
     /*
-     * Adjacency list: _adj[i] = list of (neighbour_id, edge_weight) pairs.
+     * CSR adjacency: neighbours of node i are _targets[k] with weight
+     * _weights[k] for k in [_offsets[i], _offsets[i + 1]).
      */
-    std::vector<std::vector<std::pair<vtkIdType, double>>> _adj;
+    std::vector<size_t>    _offsets;
+    std::vector<NodeIndex> _targets;
+    std::vector<float>     _weights;
 
     vtkIdType _num_nodes;
 
+    EdgeStatistics _edge_stats;
+    bool           _edge_stats_valid;
+
+    mutable vtkSMPThreadLocal<QueryWorkspace> _workspaces;
+
+    void ComputeEdgeStatistics();
+
     /*
-     * Extracts the unique edges from a single cell's point list and
-     * inserts them into _adj bidirectionally.
+     * Collects the unique undirected edges of every cell as packed
+     * (low id << 32 | high id) keys, sorted.
      */
-    void InsertCellEdges(vtkIdList* point_ids);
+    std::vector<std::uint64_t> CollectCellEdges() const;
 };
\ No newline at end of file
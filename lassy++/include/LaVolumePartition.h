@@ -0,0 +1,127 @@
+/*
+ *  LaVolumePartition.h
+ *
+ *  Spatial partition of a vtkUnstructuredGrid into chunks of contiguous
+ *  cells, so neighbourhood algorithms can work on one chunk at a time.
+ *
+ *  Build() sorts the cells by the Morton (Z-order) code of their
+ *  centroid, quantised to 21 bits per axis over the grid bounds, and
+ *  cuts the sorted order into equally sized chunks.  Cells close in the
+ *  order are close in space, so every chunk is a compact region with a
+ *  small boundary.
+ *
+ *  ExtractChunk() returns a chunk as a self-contained grid: its owned
+ *  cells first, followed by GhostLayers rings of neighbouring cells
+ *  (cells sharing a node with the previous ring).  Any node within
+ *  GhostLayers edge hops of an owned node is present, with all edges of
+ *  the hop paths, so a BFS up to that depth gives the same result on the
+ *  chunk as on the whole grid.  Each point of a cell is owned by exactly
+ *  one chunk — that of its first incident cell in Morton order — so
+ *  results on owned points can be scattered back without overlap.
+ *
+ *  Ghost cells and non-owned points are flagged in the standard
+ *  vtkGhostType arrays; input point and cell data are copied across, and
+ *  vtkOriginalPointIds / vtkOriginalCellIds map back to the input.
+ *
+ *  Only the node-to-cell index (one id per connectivity entry) is kept
+ *  for the whole grid; per-chunk memory is proportional to the chunk.
+ *  Polyhedral cells are not supported.
+ */
+#pragma once
+#define HAS_VTK 1
+
+#include <vector>
+#include <cstdint>
+
+#include <vtkSmartPointer.h>
+#include <vtkUnstructuredGrid.h>
+
+
+class LaVolumePartition {
+
+public:
+
+    struct Chunk {
+        vtkSmartPointer<vtkUnstructuredGrid> grid;
+
+        // local -> input ids; cells [0, num_owned_cells) are owned
+        std::vector<vtkIdType> point_ids;
+        std::vector<vtkIdType> cell_ids;
+        vtkIdType              num_owned_cells;
+
+        // 1 where this chunk owns the local point
+        std::vector<unsigned char> owned_points;
+    };
+
+    LaVolumePartition();
+    ~LaVolumePartition() = default;
+
+    // ------------------------------------------------------------------
+    // Setup
+    // ------------------------------------------------------------------
+
+    void SetInputGrid(vtkUnstructuredGrid* grid);
+
+    /*
+     * Number of chunks.  Default: 8.  Clamped to the number of cells.
+     */
+    void SetNumberOfChunks(int num_chunks);
+
+    /*
+     * Rings of neighbouring cells added around each chunk.  Set it to the
+     * largest hop count the per-chunk algorithm expands.  Default: 1.
+     */
+    void SetGhostLayers(int layers);
+
+    /*
+     * Sorts the cells in Morton order and assigns cells and points to
+     * chunks.  Must be called after SetInputGrid() and before any query.
+     */
+    void Build();
+
+    // ------------------------------------------------------------------
+    // Queries
+    // ------------------------------------------------------------------
+
+    int GetNumberOfChunks() const;
+
+    /*
+     * Fills chunk with chunk number index: grid, id maps and ownership.
+     */
+    void ExtractChunk(int index, Chunk& chunk) const;
+
+    /*
+     * Input cell ids in Morton order; chunk c owns the range
+     * [GetChunkOffset(c), GetChunkOffset(c + 1)).
+     */
+    const std::vector<vtkIdType>& GetCellOrder() const;
+    vtkIdType GetChunkOffset(int index) const;
+
+    /*
+     * Chunk owning input point point_id; -1 if no cell uses it.
+     */
+    int GetPointOwner(vtkIdType point_id) const;
+
+    /*
+     * Interleaves the low 21 bits of x, y and z (x in the lowest bit).
+     */
+    static std::uint64_t MortonCode(std::uint32_t x, std::uint32_t y, std::uint32_t z);
+
+private:
+
+    vtkSmartPointer<vtkUnstructuredGrid> _grid;
+    int                                  _num_chunks;
+    int                                  _ghost_layers;
+
+    std::vector<vtkIdType> _cell_order;
+    std::vector<vtkIdType> _chunk_offsets;
+    std::vector<int>       _cell_chunk;
+    std::vector<int>       _point_owner;
+
+    // CSR node -> incident cells
+    std::vector<vtkIdType> _point_cell_offsets;
+    std::vector<vtkIdType> _point_cells;
+
+    void SortCellsByMortonCode();
+    void BuildPointCells();
+};
@@ -21,6 +21,22 @@
  *  Falloff kernels and accumulation behaviour are identical to
  *  LaShellSyntheticScar: contributions are summed (not maximised) so
  *  converging path segments produce higher intensity naturally.
+ *  Distances to nearby path nodes are cached in a LaSyntheticScarField
+ *  built in parallel with vtkSMPTools; the kernel is then applied as a
+ *  vectorised transform over the cached distances.
+ *
+ *  With SetNumberOfPartitions(k > 1) the field is built and evaluated
+ *  one LaVolumePartition chunk at a time, with ghost layers enough for
+ *  every contribution to an owned node, so the cached contributions —
+ *  one per path node and node within reach, the largest buffer — follow
+ *  the largest chunk.  Kernels are evaluated one after the other, each
+ *  over every chunk, so a sweep holds one full-size accumulator at a
+ *  time, as unpartitioned; the price is one chunk pass per kernel.  This
+ *  is ghost-layer chunking, not out-of-core: the grid and the full-grid
+ *  graph used for paths stay in memory.  Results match the whole-grid
+ *  field: max_hops ghost layers for Euclidean kernels, 2 * max_hops + 1
+ *  for geodesic ones, whose shortest paths run anywhere in the hop ball
+ *  of a path node.
  */
 #pragma once
 
@@ -28,6 +44,7 @@
 #include <vector>
 #include <cmath>
 #include <memory>
+#include <functional>
 
 #include <vtkSmartPointer.h>
 #include <vtkPointLocator.h>
@@ -36,7 +53,9 @@
 
 #include "LaVolumeAlgorithms.h"
 #include "LaVolumeGraphTraversal.h"
+#include "LaSyntheticScarField.h"
 #include "LaVolume.h"
+#include "LaVolumePartition.h"
 #include "LaShell.h"
 
 
@@ -60,17 +79,58 @@ private:
     double               _sigma;
     VolumeFalloffKernel  _falloff;
     std::string          _output_array_name;
+    bool                 _geodesic_output;
+    bool                 _geodesic_kernels;
+    int                  _num_partitions;
+
+    std::vector<LaSyntheticScarField::Variant> _sweep_variants;
+
+    // arrays added by the last Update / UpdateSweep, as named on the output
+    std::vector<std::string> _written_arrays;
 
     // ------------------------------------------------------------------
     // Internal helpers
     // ------------------------------------------------------------------
 
-    double EvaluateFalloff(double d, double max_d) const;
-
     static std::string UniqueArrayName(vtkUnstructuredGrid* grid,
                                        const std::string& candidate);
 
-    double EstimateMeanEdgeLength() const;
+    // One kernel evaluation over the distance-to-path field
+    struct KernelSpec {
+        int    falloff;
+        int    hops;
+        double max_d;
+        double sigma;
+    };
+
+    /*
+     * Evaluates every kernel over the field of path_vertices built for
+     * max_hops and hands each accumulator to consume(kernel index, values),
+     * in kernel order, one accumulator alive at a time.  Partitioned, each
+     * kernel makes its own pass over the chunks.
+     * Requires _graph built.
+     */
+    void AccumulateKernels(vtkUnstructuredGrid* grid,
+                           const std::vector<vtkIdType>& path_vertices,
+                           int max_hops,
+                           const std::vector<KernelSpec>& kernels,
+                           const std::function<void(size_t, const std::vector<double>&)>& consume) const;
+
+    /*
+     * Dijkstra paths between consecutive seeds, closing the loop.
+     * Returns the deduplicated path nodes.  Requires _graph built.
+     */
+    std::vector<vtkIdType> BuildPathVertices() const;
+
+    /*
+     * Adds <output_array_name>_geodesic to grid: distance along mesh edges
+     * to the nearest path node, -1 beyond max_d.  Returns the name it was
+     * written under (suffixed if taken), empty if none was written.
+     * Requires _graph built.
+     */
+    std::string AddGeodesicDistance(vtkUnstructuredGrid* grid,
+                                    const std::vector<vtkIdType>& path_vertices,
+                                    double max_d) const;
 
 public:
 
@@ -141,9 +201,51 @@ public:
      * present on the mesh.  Default: "synthetic_scar".
      */
     void SetOutputArrayName(const char* name);
+    const std::string& GetOutputArrayName() const;
+
+    /*
+     * Also write the geodesic distance to the path (within the corridor
+     * radius) as <output_array_name>_geodesic.  Default: off.
+     */
+    void SetGeodesicDistanceOutput(bool enable);
+
+    /*
+     * Evaluate the falloff kernels on the geodesic distance (along mesh
+     * edges) from each path node instead of the Euclidean one, so the
+     * scar follows the mesh around folds and thin walls.  Default: off.
+     */
+    void SetGeodesicKernelDistance(bool enable);
+
+    /*
+     * Builds the distance-to-path field in this many spatial chunks
+     * (LaVolumePartition), so the field cache follows the largest chunk;
+     * the grid, graph and the one live accumulator are still whole.
+     * Default: 1.
+     */
+    void SetNumberOfPartitions(int num_partitions);
 
     void Update();
 
+    /*
+     * Sweep mode — mirrors LaShellSyntheticScar::UpdateSweep.  The graph,
+     * the paths, the edge length and the distance-to-path field for the
+     * largest neighbourhood are computed once; every (neighbourhood,
+     * falloff, sigma) combination is then evaluated from the cached field
+     * and added to the output as <output_array_name>_n<N>_f<F>[_s<sigma>].
+     */
+    void UpdateSweep(const std::vector<int>& neighbourhood_sizes,
+                     const std::vector<int>& falloffs,
+                     const std::vector<double>& sigmas);
+
+    const std::vector<LaSyntheticScarField::Variant>& GetSweepVariants() const;
+
+    /*
+     * Point-data arrays the last Update / UpdateSweep added to the output,
+     * under the names actually used — an existing array of the requested
+     * name makes UniqueArrayName add a suffix.
+     */
+    const std::vector<std::string>& GetWrittenArrayNames() const;
+
     LaVolume* GetOutput();
 
     LaVolumeSyntheticScar();
@@ -0,0 +1,21 @@
+#include <string>
+#include <algorithm>
+#include <cctype>
+
+#include "../include/LaFileName.h"
+
+
+std::string LaFileName::Extension(const std::string& filename) {
+    const size_t slash = filename.find_last_of("/\\");
+    const size_t dot   = filename.find_last_of('.');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return "";
+
+    std::string ext = filename.substr(dot);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext;
+}
+
+std::string LaFileName::Stem(const std::string& filename) {
+    return filename.substr(0, filename.size() - Extension(filename).size());
+}
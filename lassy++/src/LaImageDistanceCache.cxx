@@ -0,0 +1,209 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <mutex>
+#include <deque>
+#include <utility>
+#include <cstdint>
+#include <cstring>
+
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkBinaryThresholdImageFilter.h"
+#include "itkSignedMaurerDistanceMapImageFilter.h"
+#include "itkImageFileReader.h"
+#include "itkImageFileWriter.h"
+
+#include "../include/LaImageDistanceCache.h"
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+typedef LaImageDistanceCache::MaskImageType     MaskImageType;
+typedef LaImageDistanceCache::DistanceImageType DistanceImageType;
+
+std::mutex& CacheMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// most recently used last
+std::deque<std::pair<std::string, DistanceImageType::Pointer>>& CacheEntries() {
+    static std::deque<std::pair<std::string, DistanceImageType::Pointer>> entries;
+    return entries;
+}
+
+std::string& CacheDirectory() {
+    static std::string directory;
+    return directory;
+}
+
+const std::uint64_t kFnvOffset = 1469598103934665603ull;
+const std::uint64_t kFnvPrime  = 1099511628211ull;
+
+void HashBytes(std::uint64_t& hash, const void* data, size_t bytes) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+
+    // FNV-1a over 8-byte words, then the tail
+    size_t i = 0;
+    for (; i + 8 <= bytes; i += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, p + i, 8);
+        hash = (hash ^ word) * kFnvPrime;
+    }
+    for (; i < bytes; ++i)
+        hash = (hash ^ p[i]) * kFnvPrime;
+}
+
+/*
+ * Key of the map of label over region of mask: everything the map depends on.
+ */
+std::string Key(const MaskImageType* mask, unsigned short label, const MaskImageType::RegionType& region) {
+    std::uint64_t hash = kFnvOffset;
+
+    const MaskImageType::SizeType size = mask->GetBufferedRegion().GetSize();
+    const MaskImageType::IndexType index = region.GetIndex();
+    const std::int64_t row_length = region.GetSize(0);
+    const unsigned short* buffer = mask->GetBufferPointer();
+    for (std::int64_t z = index[2]; z < index[2] + static_cast<std::int64_t>(region.GetSize(2)); ++z) {
+        for (std::int64_t y = index[1]; y < index[1] + static_cast<std::int64_t>(region.GetSize(1)); ++y) {
+            const unsigned short* row = buffer + index[0] + static_cast<std::int64_t>(size[0]) * (y + static_cast<std::int64_t>(size[1]) * z);
+            HashBytes(hash, row, static_cast<size_t>(row_length) * sizeof(unsigned short));
+        }
+    }
+
+    for (int a = 0; a < 3; ++a) {
+        const std::uint64_t extent = region.GetSize(a);
+        const double spacing = mask->GetSpacing()[a];
+        HashBytes(hash, &extent, sizeof(extent));
+        HashBytes(hash, &spacing, sizeof(spacing));
+    }
+
+    std::ostringstream key;
+    key << "smd_" << std::hex << std::setw(16) << std::setfill('0') << hash << std::dec << "_" << label;
+    return key.str();
+}
+
+DistanceImageType::Pointer Compute(const MaskImageType* mask, unsigned short label,
+                                   const MaskImageType::RegionType& region) {
+    typedef itk::RegionOfInterestImageFilter<MaskImageType, MaskImageType> CropFilterType;
+    typedef itk::BinaryThresholdImageFilter<MaskImageType, MaskImageType> ThresholdFilterType;
+    typedef itk::SignedMaurerDistanceMapImageFilter<MaskImageType, DistanceImageType> DistanceFilterType;
+
+    CropFilterType::Pointer crop = CropFilterType::New();
+    crop->SetInput(mask);
+    crop->SetRegionOfInterest(region);
+    crop->ReleaseDataFlagOn();
+
+    ThresholdFilterType::Pointer threshold = ThresholdFilterType::New();
+    threshold->SetInput(crop->GetOutput());
+    threshold->SetLowerThreshold(label);
+    threshold->SetUpperThreshold(label);
+    threshold->SetInsideValue(1);
+    threshold->SetOutsideValue(0);
+    threshold->ReleaseDataFlagOn();
+
+    DistanceFilterType::Pointer distance = DistanceFilterType::New();
+    distance->SetInput(threshold->GetOutput());
+    distance->Update();
+
+    DistanceImageType::Pointer map = distance->GetOutput();
+    map->DisconnectPipeline();
+    return map;
+}
+
+DistanceImageType::Pointer ReadFromDirectory(const std::string& filename, const MaskImageType::RegionType& region) {
+    if (!std::ifstream(filename).good()) return nullptr;
+
+    typedef itk::ImageFileReader<DistanceImageType> ReaderType;
+    ReaderType::Pointer reader = ReaderType::New();
+    reader->SetFileName(filename);
+    try {
+        reader->Update();
+    }
+    catch (itk::ExceptionObject& err) {
+        std::cerr << "LaImageDistanceCache — cannot read " << filename << ": " << err << std::endl;
+        return nullptr;
+    }
+
+    DistanceImageType::Pointer map = reader->GetOutput();
+    if (map->GetBufferedRegion().GetSize() != region.GetSize()) return nullptr;
+    map->DisconnectPipeline();
+    return map;
+}
+
+void WriteToDirectory(const std::string& filename, const DistanceImageType* map) {
+    typedef itk::ImageFileWriter<DistanceImageType> WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(filename);
+    writer->SetInput(map);
+    try {
+        writer->Update();
+    }
+    catch (itk::ExceptionObject& err) {
+        std::cerr << "LaImageDistanceCache — cannot write " << filename << ": " << err << std::endl;
+    }
+}
+
+} // namespace
+
+
+// ============================================================
+// LaImageDistanceCache
+// ============================================================
+
+LaImageDistanceCache::DistanceImageType::Pointer
+LaImageDistanceCache::SignedMaurerDistance(const MaskImageType* mask, unsigned short label,
+                                           const MaskImageType::RegionType& region) {
+    const std::string key = Key(mask, label, region);
+
+    std::string filename;
+    {
+        std::lock_guard<std::mutex> lock(CacheMutex());
+        auto& entries = CacheEntries();
+        for (auto it = entries.begin(); it != entries.end(); ++it) {
+            if (it->first == key) {
+                std::pair<std::string, DistanceImageType::Pointer> entry = *it;
+                entries.erase(it);
+                entries.push_back(entry);
+                return entry.second;
+            }
+        }
+        if (!CacheDirectory().empty())
+            filename = CacheDirectory() + "/" + key + ".nii";
+    }
+
+    DistanceImageType::Pointer map;
+    if (!filename.empty())
+        map = ReadFromDirectory(filename, region);
+
+    if (map) {
+        std::cout << "Distance map read from cache: " << filename << std::endl;
+    }
+    else {
+        map = Compute(mask, label, region);
+        if (!filename.empty())
+            WriteToDirectory(filename, map);
+    }
+
+    std::lock_guard<std::mutex> lock(CacheMutex());
+    auto& entries = CacheEntries();
+    entries.emplace_back(key, map);
+    while (entries.size() > MaxEntries)
+        entries.pop_front();
+    return map;
+}
+
+void LaImageDistanceCache::SetCacheDirectory(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(CacheMutex());
+    CacheDirectory() = directory;
+}
+
+void LaImageDistanceCache::Clear() {
+    std::lock_guard<std::mutex> lock(CacheMutex());
+    CacheEntries().clear();
+}
@@ -0,0 +1,221 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+#include <vtkSMPTools.h>
+
+#include "itkRegionOfInterestImageFilter.h"
+#include "itkSmoothingRecursiveGaussianImageFilter.h"
+#include "itkLaplacianRecursiveGaussianImageFilter.h"
+#include "itkHessianRecursiveGaussianImageFilter.h"
+#include "itkBoxMeanImageFilter.h"
+#include "itkBoxSigmaImageFilter.h"
+
+#include "../include/LaImageFeatureBank.h"
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+typedef LaImageFeatureBank::ImageType      ImageType;
+typedef itk::Image<float, 3>                FloatImageType;
+
+/*
+ * Region of the image a cropped filter output covers, x fastest.
+ */
+struct Crop {
+    int origin[3];
+    int size[3];
+
+    std::int64_t Offset(int x, int y, int z) const {
+        return (x - origin[0]) + static_cast<std::int64_t>(size[0]) *
+               ((y - origin[1]) + static_cast<std::int64_t>(size[1]) * (z - origin[2]));
+    }
+};
+
+/*
+ * Calls f(row, offset into the crop) for every row of table, z-slabs of
+ * the rows in parallel.
+ */
+template <typename F>
+void ForEachRowInCrop(const LaImageFeatureTable& table, const Crop& crop, F&& f) {
+    int lo[3], hi[3];
+    table.GetBoundingBox(lo, hi);
+
+    vtkSMPTools::For(lo[2], hi[2] + 1, [&](vtkIdType z_begin, vtkIdType z_end) {
+        table.ForEachRow(static_cast<int>(z_begin), static_cast<int>(z_end),
+                         [&](std::int64_t row, int x, int y, int z) {
+            f(row, crop.Offset(x, y, z));
+        });
+    });
+}
+
+/*
+ * Copies a cropped float image into column.
+ */
+void StoreColumn(LaImageFeatureTable& table, const Crop& crop, const FloatImageType* image,
+                 int column) {
+    const float* buffer = image->GetBufferPointer();
+    float* values = table.GetColumn(column);
+    ForEachRowInCrop(table, crop, [&](std::int64_t row, std::int64_t offset) {
+        values[row] = buffer[offset];
+    });
+}
+
+}  // namespace
+
+
+// ============================================================
+// LaImageFeatureBank
+// ============================================================
+
+LaImageFeatureBank::LaImageFeatureBank()
+    : _image(nullptr) {
+    _scales.push_back(1.0);
+    _scales.push_back(2.0);
+    _scales.push_back(4.0);
+}
+
+void LaImageFeatureBank::SetInputImage(const ImageType* image) {
+    _image = image;
+}
+
+void LaImageFeatureBank::SetScales(const std::vector<double>& scales) {
+    _scales = scales;
+}
+
+std::string LaImageFeatureBank::ColumnName(const char* feature, double scale) {
+    std::ostringstream name;
+    name << feature << "_s" << scale;
+    return name.str();
+}
+
+void LaImageFeatureBank::Update(LaImageFeatureTable& table) {
+    if (!_image) {
+        std::cerr << "LaImageFeatureBank::Update — no input image" << std::endl;
+        return;
+    }
+
+    int image_size[3];
+    table.GetImageSize(image_size[0], image_size[1], image_size[2]);
+
+    const ImageType::SizeType size = _image->GetBufferedRegion().GetSize();
+    for (int a = 0; a < 3; ++a) {
+        if (static_cast<int>(size[a]) != image_size[a]) {
+            std::cerr << "LaImageFeatureBank::Update — image and feature table sizes differ" << std::endl;
+            return;
+        }
+    }
+    if (table.GetNumberOfRows() == 0) return;
+
+    int bbox_lo[3], bbox_hi[3];
+    table.GetBoundingBox(bbox_lo, bbox_hi);
+
+    for (double scale : _scales) {
+        if (!(scale > 0)) {
+            std::cerr << "LaImageFeatureBank::Update — skipping scale " << scale << std::endl;
+            continue;
+        }
+
+        // the mask bounding box grown by the Gaussian support; sigma is in physical units
+        Crop crop;
+        ImageType::RegionType region;
+        for (int a = 0; a < 3; ++a) {
+            const int margin = std::max(static_cast<int>(std::ceil(4.0 * scale / _image->GetSpacing()[a])),
+                                        static_cast<int>(std::lround(scale)) + 1);
+            const int lo = std::max(bbox_lo[a] - margin, 0);
+            const int hi = std::min(bbox_hi[a] + margin, image_size[a] - 1);
+            crop.origin[a] = lo;
+            crop.size[a]   = hi - lo + 1;
+            region.SetIndex(a, lo);
+            region.SetSize(a, crop.size[a]);
+        }
+
+        typedef itk::RegionOfInterestImageFilter<ImageType, ImageType> CropFilterType;
+        CropFilterType::Pointer crop_filter = CropFilterType::New();
+        crop_filter->SetInput(_image);
+        crop_filter->SetRegionOfInterest(region);
+        crop_filter->Update();
+        ImageType::Pointer cropped = crop_filter->GetOutput();
+
+        std::cout << "Feature bank: scale " << scale << ", " << crop.size[0] << "x" << crop.size[1]
+                  << "x" << crop.size[2] << " voxels" << std::endl;
+
+        // Gaussian
+        {
+            typedef itk::SmoothingRecursiveGaussianImageFilter<ImageType, FloatImageType> FilterType;
+            FilterType::Pointer filter = FilterType::New();
+            filter->SetInput(cropped);
+            filter->SetSigma(scale);
+            filter->Update();
+            StoreColumn(table, crop, filter->GetOutput(), table.AddColumn(ColumnName("Gauss", scale)));
+        }
+
+        // Laplacian of Gaussian
+        {
+            typedef itk::LaplacianRecursiveGaussianImageFilter<ImageType, FloatImageType> FilterType;
+            FilterType::Pointer filter = FilterType::New();
+            filter->SetInput(cropped);
+            filter->SetSigma(scale);
+            filter->SetNormalizeAcrossScale(true);
+            filter->Update();
+            StoreColumn(table, crop, filter->GetOutput(), table.AddColumn(ColumnName("LoG", scale)));
+        }
+
+        // Hessian eigenvalues, solved per masked voxel instead of as an eigenvalue image
+        {
+            typedef itk::HessianRecursiveGaussianImageFilter<ImageType> FilterType;
+            FilterType::Pointer filter = FilterType::New();
+            filter->SetInput(cropped);
+            filter->SetSigma(scale);
+            filter->SetNormalizeAcrossScale(true);
+            filter->Update();
+
+            const FilterType::OutputPixelType* hessian = filter->GetOutput()->GetBufferPointer();
+            float* eigen[3] = {
+                table.GetColumn(table.AddColumn(ColumnName("HessEig1", scale))),
+                table.GetColumn(table.AddColumn(ColumnName("HessEig2", scale))),
+                table.GetColumn(table.AddColumn(ColumnName("HessEig3", scale)))
+            };
+            ForEachRowInCrop(table, crop, [&](std::int64_t row, std::int64_t offset) {
+                FilterType::OutputPixelType::EigenValuesArrayType values;
+                hessian[offset].ComputeEigenValues(values);
+                for (int k = 0; k < 3; ++k)
+                    eigen[k][row] = static_cast<float>(values[k]);
+            });
+        }
+
+        // local statistics
+        {
+            const unsigned int radius = static_cast<unsigned int>(std::max(1L, std::lround(scale)));
+            ImageType::SizeType box;
+            box.Fill(radius);
+
+            typedef itk::BoxMeanImageFilter<ImageType, FloatImageType> MeanFilterType;
+            MeanFilterType::Pointer mean = MeanFilterType::New();
+            mean->SetInput(cropped);
+            mean->SetRadius(box);
+            mean->Update();
+            StoreColumn(table, crop, mean->GetOutput(), table.AddColumn(ColumnName("LocalMean", scale)));
+            mean = nullptr;
+
+            typedef itk::BoxSigmaImageFilter<ImageType, FloatImageType> SigmaFilterType;
+            SigmaFilterType::Pointer sigma = SigmaFilterType::New();
+            sigma->SetInput(cropped);
+            sigma->SetRadius(box);
+            sigma->Update();
+
+            const float* buffer = sigma->GetOutput()->GetBufferPointer();
+            float* variance = table.GetColumn(table.AddColumn(ColumnName("LocalVar", scale)));
+            ForEachRowInCrop(table, crop, [&](std::int64_t row, std::int64_t offset) {
+                variance[row] = buffer[offset] * buffer[offset];
+            });
+        }
+    }
+}
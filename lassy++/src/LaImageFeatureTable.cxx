@@ -0,0 +1,212 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <limits>
+
+#include "../include/LaImageFeatureTable.h"
+
+
+const char* LaImageFeatureTable::BinaryExtension = ".lft";
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+const char          kMagic[8]        = {'L', 'A', 'F', 'E', 'A', 'T', '0', '1'};
+const std::uint32_t kByteOrderMark   = 0x01020304u;
+const std::uint32_t kFloat32         = 1;
+const std::uint64_t kColumnAlignment = 64;
+
+template <typename T>
+void WritePod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+std::uint64_t AlignUp(std::uint64_t value) {
+    return (value + kColumnAlignment - 1) / kColumnAlignment * kColumnAlignment;
+}
+
+} // namespace
+
+
+// ============================================================
+// LaImageFeatureTable
+// ============================================================
+
+
+LaImageFeatureTable::LaImageFeatureTable() {
+    Clear();
+}
+
+void LaImageFeatureTable::Clear() {
+    for (int a = 0; a < 3; ++a) {
+        _size[a]    = 0;
+        _bbox_lo[a] = 0;
+        _bbox_hi[a] = -1;
+    }
+    _line_offsets.assign(1, 0);
+    _row_x.clear();
+    _column_names.clear();
+    _columns.clear();
+}
+
+void LaImageFeatureTable::Build(const MaskImageType* mask) {
+    Clear();
+    if (!mask) return;
+
+    const MaskImageType::SizeType size = mask->GetBufferedRegion().GetSize();
+    for (int i = 0; i < 3; ++i) _size[i] = static_cast<int>(size[i]);
+
+    const std::int64_t nx = _size[0], ny = _size[1], nz = _size[2];
+    const unsigned short* buffer = mask->GetBufferPointer();
+
+    for (int a = 0; a < 3; ++a) {
+        _bbox_lo[a] = _size[a];
+        _bbox_hi[a] = -1;
+    }
+
+    _line_offsets.assign(static_cast<size_t>(ny * nz + 1), 0);
+    for (std::int64_t z = 0; z < nz; ++z) {
+        for (std::int64_t y = 0; y < ny; ++y) {
+            const std::int64_t line = z * ny + y;
+            const unsigned short* scanline = buffer + nx * line;
+            for (std::int64_t x = 0; x < nx; ++x) {
+                if (static_cast<short>(scanline[x]) > 0)
+                    _row_x.push_back(static_cast<std::int32_t>(x));
+            }
+            _line_offsets[static_cast<size_t>(line + 1)] = static_cast<std::int64_t>(_row_x.size());
+
+            if (_line_offsets[line + 1] > _line_offsets[line]) {
+                const int xyz_lo[3] = {_row_x[_line_offsets[line]], static_cast<int>(y), static_cast<int>(z)};
+                const int xyz_hi[3] = {_row_x[_line_offsets[line + 1] - 1], static_cast<int>(y), static_cast<int>(z)};
+                for (int a = 0; a < 3; ++a) {
+                    _bbox_lo[a] = std::min(_bbox_lo[a], xyz_lo[a]);
+                    _bbox_hi[a] = std::max(_bbox_hi[a], xyz_hi[a]);
+                }
+            }
+        }
+    }
+    _row_x.shrink_to_fit();
+}
+
+std::int64_t LaImageFeatureTable::GetNumberOfRows() const {
+    return static_cast<std::int64_t>(_row_x.size());
+}
+
+int LaImageFeatureTable::AddColumn(const std::string& name) {
+    const int existing = FindColumn(name);
+    if (existing >= 0) return existing;
+
+    _column_names.push_back(name);
+    _columns.emplace_back(_row_x.size(), std::numeric_limits<float>::quiet_NaN());
+    return static_cast<int>(_columns.size()) - 1;
+}
+
+int LaImageFeatureTable::FindColumn(const std::string& name) const {
+    const auto it = std::find(_column_names.begin(), _column_names.end(), name);
+    return (it == _column_names.end()) ? -1 : static_cast<int>(it - _column_names.begin());
+}
+
+int LaImageFeatureTable::GetNumberOfColumns() const {
+    return static_cast<int>(_columns.size());
+}
+
+const std::string& LaImageFeatureTable::GetColumnName(int column) const {
+    return _column_names[column];
+}
+
+float* LaImageFeatureTable::GetColumn(int column) {
+    return _columns[column].data();
+}
+
+const float* LaImageFeatureTable::GetColumn(int column) const {
+    return _columns[column].data();
+}
+
+std::int64_t LaImageFeatureTable::FindRow(int x, int y, int z) const {
+    if (x < 0 || y < 0 || z < 0 || x >= _size[0] || y >= _size[1] || z >= _size[2])
+        return -1;
+
+    const std::int64_t line = static_cast<std::int64_t>(z) * _size[1] + y;
+    const auto first = _row_x.begin() + _line_offsets[line];
+    const auto last  = _row_x.begin() + _line_offsets[line + 1];
+    const auto it    = std::lower_bound(first, last, x);
+    return (it != last && *it == x) ? static_cast<std::int64_t>(it - _row_x.begin()) : -1;
+}
+
+void LaImageFeatureTable::GetImageSize(int& x, int& y, int& z) const {
+    x = _size[0];
+    y = _size[1];
+    z = _size[2];
+}
+
+void LaImageFeatureTable::GetBoundingBox(int lo[3], int hi[3]) const {
+    for (int a = 0; a < 3; ++a) {
+        lo[a] = _bbox_lo[a];
+        hi[a] = _bbox_hi[a];
+    }
+}
+
+bool LaImageFeatureTable::WriteBinary(const std::string& filename, const std::vector<int>& columns) const {
+    const std::string INFO = "LaImageFeatureTable::WriteBinary — ";
+
+    for (int column : columns) {
+        if (column < 0 || column >= GetNumberOfColumns()) {
+            std::cerr << INFO << "no column " << column << std::endl;
+            return false;
+        }
+    }
+
+    // ---- Lay out: header, column directory, then aligned columns -----------
+    std::uint64_t header_bytes = sizeof(kMagic) + 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t)
+                               + 4 * sizeof(std::int32_t);
+    for (int column : columns)
+        header_bytes += 2 * sizeof(std::uint32_t) + sizeof(std::uint64_t) + _column_names[column].size();
+
+    const std::uint64_t column_bytes = static_cast<std::uint64_t>(_row_x.size()) * sizeof(float);
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t position = AlignUp(header_bytes);
+    for (size_t c = 0; c < columns.size(); ++c) {
+        offsets.push_back(position);
+        position = AlignUp(position + column_bytes);
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << INFO << "cannot open: " << filename << std::endl;
+        return false;
+    }
+
+    out.write(kMagic, sizeof(kMagic));
+    WritePod(out, kByteOrderMark);
+    WritePod(out, static_cast<std::uint32_t>(columns.size()));
+    WritePod(out, static_cast<std::uint64_t>(_row_x.size()));
+    for (int a = 0; a < 3; ++a)
+        WritePod(out, static_cast<std::int32_t>(_size[a]));
+    WritePod(out, static_cast<std::uint32_t>(0));
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const std::string& name = _column_names[columns[c]];
+        WritePod(out, kFloat32);
+        WritePod(out, static_cast<std::uint32_t>(name.size()));
+        WritePod(out, offsets[c]);
+        out.write(name.data(), static_cast<std::streamsize>(name.size()));
+    }
+
+    const char padding[kColumnAlignment] = {0};
+    std::uint64_t written = header_bytes;
+    for (size_t c = 0; c < columns.size(); ++c) {
+        out.write(padding, static_cast<std::streamsize>(offsets[c] - written));
+        out.write(reinterpret_cast<const char*>(_columns[columns[c]].data()),
+                  static_cast<std::streamsize>(column_bytes));
+        written = offsets[c] + column_bytes;
+    }
+
+    if (!out) {
+        std::cerr << INFO << "write failed: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -1,4 +1,7 @@
 #include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <vtkSMPTools.h>
 #include "../include/LaImageFeatures.h"
 
 ;
@@ -6,73 +9,37 @@
 
 LaImageFeatures::LaImageFeatures()
 {
-	
-	_feature_index_map = ImageTypeInt::New();
+	_image = NULL;
+	_mask_image = NULL;
 	_max_features = 15;
-	_total_size = 0;
-	_my_nan = -1e9;
 	_mask_val_SMD = 1; 
+	_feature_table_built = false;
+	_which_value = 1;
+
+	_haralick_radius = 1;
+	_haralick_bins = 16;
+	_haralick_min = 0;
+	_haralick_max = 255;
+	for (int d = 0; d < LaImageGLCM::NumberOfDirections; d++)
+		_haralick_directions.push_back(d);
+	_haralick_mean = false;
 }
 
 LaImageFeatures::~LaImageFeatures() {
 
-	// Remove memory allocated on heap
-	//delete _index_image; 
 }
 
 
 void LaImageFeatures::SetInputData(LaImage* img) {
 	_image = img; 
-
-	int max_x, max_y, max_z; 
-	 _image->GetImageSize(max_x,max_y,max_z);
-	_total_size = max_x*max_y*max_z;
-	
-	 // copy structure for index image 
- 	ImageTypeInt::RegionType region;
-  	ImageTypeInt::IndexType start;
-	start[0] = 0; start[1] = 0; start[2] = 0;
-	ImageTypeInt::SizeType size;
-	size[0] = max_x; size[1] = max_y; size[2] = max_z; 
-	region.SetSize(size);
-	region.SetIndex(start);
-
-  	_feature_index_map->SetRegions(region);
-  	_feature_index_map->Allocate();
-
-	// reset index image values
-	int index=0;
-
-
-	// Set pixels in a square to one value
-	for(int x = 0; x < max_x; x++)
-	{
-		for(int y = 0; y < max_y; y++)
-		{
-			for(int z = 0; z < max_z; z++) { 
-				
-				ImageTypeInt::IndexType pixelIndex;
-				pixelIndex[0] = x; pixelIndex[1] = y; pixelIndex[2] = z;
-		
-				_feature_index_map->SetPixel(pixelIndex, index++);	// storing index to _image_features vector 
-			}
-		}
-	}
-
-	// set feature vector 
-	_image_features = std::vector<std::vector<double> >(_total_size, std::vector<double>(_max_features));
-
-	for (int i = 0; i < _total_size; i++)
-	{
-		for (int j = 0; j < _max_features; j++)
-		{
-			_image_features[i][j] = _my_nan;
-		}
-	}
+	_feature_table.Clear();
+	_feature_table_built = false;
 }
 
 void LaImageFeatures::SetInputData2(LaImage* img) {
 	_mask_image = img;
+	_feature_table.Clear();
+	_feature_table_built = false;
 }
 
 void LaImageFeatures::SetMaxFeatures(int max)
@@ -89,248 +56,279 @@ void LaImageFeatures::SetOutputFile(const char* csv_filename)
 	_csv_filename = std::string(csv_filename);
 }
 
-void LaImageFeatures::SetFeatureValue(int x, int y, int z, int feature_index, double feature_value)
+void LaImageFeatures::SetBinaryOutputFile(const char* filename)
 {
-	ImageTypeInt::IndexType pixelIndex;
-
-	pixelIndex[0] = x;      
-	pixelIndex[1] = y;      
-	pixelIndex[2] = z; 
-
-	double index = _feature_index_map->GetPixel(pixelIndex);
+	_binary_filename = std::string(filename);
+}
 
-	if (index >= 0 && index < _total_size) {
-		if (feature_index < _max_features)
-		{
-			_image_features[index][feature_index] = feature_value;
-			return; 
-		}
+const char* LaImageFeatures::FeatureName(int feature_index)
+{
+	switch (feature_index)
+	{
+		case intensity:			return "Intensity";
+		case pos_x:				return "X";
+		case pos_y:				return "Y";
+		case pos_z:				return "Z";
+		case grad_mag:			return "GradMag";
+		case maurer_distance:	return "MaurerDist";
+		case which_class:		return "Class";
 	}
-	std::cout << "\nError in SetFeatureValue(): Could not assign feature value - out of bounds" << std::endl;
+	return "";
+}
 
+void LaImageFeatures::PrepareFeatureTable()
+{
+	if (_feature_table_built) return;
+
+	// only voxels inside the mask get a row
+	_feature_table.Build(_mask_image->GetImage());
+	_feature_table_built = true;
+	std::cout << "Feature table: " << _feature_table.GetNumberOfRows() << " voxels in mask" << std::endl;
 }
 
-/*
-*	The first discerning feature (i.e. intensity) 
-*	to determine whether a pixel has any listed features at all 
-*/
-void LaImageFeatures::ExtractFeature_Intensity_Pos()
+int LaImageFeatures::FeatureColumn(int feature_index)
 {
-	int max_x, max_y, max_z; 
-	short mask_value, intensity_value;
+	PrepareFeatureTable();
+	return _feature_table.AddColumn(FeatureName(feature_index));
+}
 
-	_image->GetImageSize(max_x, max_y, max_z);
-	for (int x = 0; x < max_x; x++)
+std::vector<int> LaImageFeatures::OutputColumns() const
+{
+	std::vector<int> column_order;
+	for (int k = LaImageFeatures::intensity; k != LaImageFeatures::Last; k++)
 	{
-		for (int y = 0; y < max_y; y++)
-		{
-			for (int z = 0; z < max_z; z++) {
-				
-				_mask_image->GetIntensityAt(x, y, z, mask_value);
-				_image->GetIntensityAt(x, y, z, intensity_value); 
-
-				if (mask_value > 0)
-				{
-					int index_of_intensity_feature = LaImageFeatures::intensity;
-					this->SetFeatureValue(x, y, z, index_of_intensity_feature, intensity_value);
-
-					// Set XYZ 3D position 
-					int index_pos_X = LaImageFeatures::pos_x;
-					int index_pos_Y = LaImageFeatures::pos_y;
-					int index_pos_Z = LaImageFeatures::pos_z;
-					int index_pos_mask = LaImageFeatures::which_class;
-
-					this->SetFeatureValue(x, y, z, index_pos_X, x);
-					this->SetFeatureValue(x, y, z, index_pos_Y, y);
-					this->SetFeatureValue(x, y, z, index_pos_Z, z);
-
-					this->SetFeatureValue(x, y, z, index_pos_mask, mask_value);
-				}
-
-			}
-		}
+		const int column = _feature_table.FindColumn(FeatureName(k));
+		if (column >= 0)
+			column_order.push_back(column);
+	}
+	for (int column = 0; column < _feature_table.GetNumberOfColumns(); column++)
+	{
+		if (std::find(column_order.begin(), column_order.end(), column) == column_order.end())
+			column_order.push_back(column);
 	}
+	return column_order;
 }
 
-
-void LaImageFeatures::ExtractFeature_GradientMagnitude()
+const LaImageFeatureTable& LaImageFeatures::GetFeatureTable() const
 {
-	// Setup types
-	int max_x, max_y, max_z; 
-	short mask_value;
+	return _feature_table;
+}
 
-	typedef itk::Image< float, 3 >   FloatImageType;
-	typedef itk::Image< unsigned short, 3 >    InputImageType;
-	
-	// First compute gradient magnitude of entire image 
-	typedef itk::GradientMagnitudeImageFilter<InputImageType, FloatImageType >  filterType;
-	filterType::Pointer gradientFilter = filterType::New();
-	gradientFilter->SetInput(_image->GetImage()); 
-	gradientFilter->Update();
+void LaImageFeatures::SetHaralickWindowRadius(int radius)
+{
+	_haralick_radius = radius;
+}
 
-	FloatImageType::Pointer gradient_image = gradientFilter->GetOutput(); 
-	FloatImageType::IndexType pixelIndex;
+void LaImageFeatures::SetHaralickBins(int bins)
+{
+	_haralick_bins = bins;
+}
 
-	_image->GetImageSize(max_x, max_y, max_z);
+void LaImageFeatures::SetHaralickIntensityRange(int min, int max)
+{
+	_haralick_min = min;
+	_haralick_max = max;
+}
 
-	// Now store magnitude for pixels in mask
-	for (int x = 0; x < max_x; x++)
-	{
-		for (int y = 0; y < max_y; y++)
-		{
-			for (int z = 0; z < max_z; z++) {
+void LaImageFeatures::SetHaralickDirections(const std::vector<int>& directions)
+{
+	_haralick_directions = directions;
+}
 
-				_mask_image->GetIntensityAt(x, y, z, mask_value);
+void LaImageFeatures::SetHaralickAverageDirections(bool mean)
+{
+	_haralick_mean = mean;
+}
 
-				if (mask_value > 0) {
-				
-					pixelIndex[0] = x;      // x position of the pixel
-					pixelIndex[1] = y;      // y position of the pixel
-					pixelIndex[2] = z;
+void LaImageFeatures::SetFeatureBankScales(const std::vector<double>& scales)
+{
+	_bank_scales = scales;
+}
 
-					FloatImageType::PixelType pixelValue = gradient_image->GetPixel(pixelIndex);
-					int index_pos = LaImageFeatures::grad_mag;
-					this->SetFeatureValue(x, y, z, index_pos, pixelValue);
-				}
+void LaImageFeatures::SetFeatureValue(int x, int y, int z, int feature_index, double feature_value)
+{
+	if (feature_index >= 0 && feature_index < LaImageFeatures::Last)
+	{
+		const int column = FeatureColumn(feature_index);
+		const std::int64_t row = _feature_table.FindRow(x, y, z);
 
-			}
+		if (row >= 0) {
+			_feature_table.GetColumn(column)[row] = static_cast<float>(feature_value);
+			return;
 		}
 	}
+	std::cout << "\nError in SetFeatureValue(): Could not assign feature value - out of bounds" << std::endl;
+
 }
 
-void LaImageFeatures::ExtractFeature_SignedMaurerDistance()
+/*
+*	The first discerning feature (i.e. intensity) 
+*	to determine whether a pixel has any listed features at all 
+*/
+void LaImageFeatures::ExtractFeature_Intensity_Pos()
 {
-	typedef itk::Image< unsigned short, 3 >    InputImageType;
-	typedef itk::Image< float, 3 >   FloatImageType;
-	typedef  itk::SignedMaurerDistanceMapImageFilter< InputImageType, FloatImageType  > SignedMaurerDistanceMapImageFilterType;
-
-	
-	
-	int max_x, max_y, max_z; 
-	short mask_value;
-	_mask_image->GetImageSize(max_x, max_y, max_z); 
-
-	// create a copy of mask image 
-	/*InputImageType::Pointer mask_copy = InputImageType::New();
-	InputImageType::IndexType start;
-	start[0] = 0;  start[1] = 0;  start[2] = 0;
-	InputImageType::SizeType  size;
-	size[0] = max_y;  size[1] = max_x;  size[2] = max_z;  // size along Z
-	InputImageType::RegionType region;
-	region.SetSize(size);
-	region.SetIndex(start);
-	mask_copy->SetRegions(region);
-	mask_copy->Allocate();*/
-
-	typedef itk::ImageDuplicator< InputImageType > DuplicatorType;
-	DuplicatorType::Pointer duplicator = DuplicatorType::New();
-	duplicator->SetInputImage(_mask_image->GetImage());
-	duplicator->Update();
-	InputImageType::Pointer mask_copy = duplicator->GetOutput();
-	
-
-	for (int x = 0; x < max_x; x++)
-	{
-		for (int y = 0; y < max_y; y++)
-		{
-			for (int z = 0; z < max_z; z++) {
-				
-				ImageTypeInt::IndexType pixelIndex;
-				pixelIndex[0] = x; pixelIndex[1] = y; pixelIndex[2] = z; 
-				
-				if (mask_copy->GetPixel(pixelIndex) != _mask_val_SMD)
-					mask_copy->SetPixel(pixelIndex, 0);
+	ExtractFeatures(true, false, false);
+}
 
-			}
-		}
-	}
+void LaImageFeatures::ExtractFeature_GradientMagnitude()
+{
+	ExtractFeatures(false, true, false);
+}
 
-	
-	SignedMaurerDistanceMapImageFilterType::Pointer distanceMapImageFilter = SignedMaurerDistanceMapImageFilterType::New();
-	distanceMapImageFilter->SetInput(mask_copy);
-	distanceMapImageFilter->Update(); 
-	FloatImageType::Pointer distance_image = distanceMapImageFilter->GetOutput();
-	FloatImageType::IndexType pixelIndex;
-	
-	// Now store magnitude for pixels in mask
-	for (int x = 0; x < max_x; x++)
-	{
-		for (int y = 0; y < max_y; y++)
-		{
-			for (int z = 0; z < max_z; z++) {
+void LaImageFeatures::ExtractFeature_SignedMaurerDistance()
+{
+	ExtractFeatures(false, false, true);
+}
 
-				_mask_image->GetIntensityAt(x, y, z, mask_value);
+/*
+*	Fills the requested feature columns in one pass over the rows of _feature_table, which
+*	are in memory order, so the image buffers are read forwards; z-slabs run in parallel.
+*	The gradient and distance filters only run on the mask bounding box grown by one voxel:
+*	that keeps the central differences at the box border and the nearest boundary voxel of
+*	every masked voxel inside the crop, so the values are those of the whole-image filters.
+*/
+void LaImageFeatures::ExtractFeatures(bool intensity_pos, bool gradient, bool distance)
+{
+	typedef itk::Image< unsigned short, 3 >    InputImageType;
+	typedef itk::Image< float, 3 >   FloatImageType;
+	typedef itk::RegionOfInterestImageFilter< InputImageType, InputImageType > CropFilterType;
+	typedef itk::GradientMagnitudeImageFilter< InputImageType, FloatImageType > GradientFilterType;
 
-				if (mask_value > 0) {
+	PrepareFeatureTable();
+	if (_feature_table.GetNumberOfRows() == 0) return;
 
-					pixelIndex[0] = x;      // x position of the pixel
-					pixelIndex[1] = y;      // y position of the pixel
-					pixelIndex[2] = z;
+	int max_x, max_y, max_z;
+	_feature_table.GetImageSize(max_x, max_y, max_z);
+	const int image_size[3] = { max_x, max_y, max_z };
 
-					FloatImageType::PixelType pixelValue = distance_image->GetPixel(pixelIndex);
-					int index_pos = LaImageFeatures::maurer_distance;
+	int bbox_lo[3], bbox_hi[3];
+	_feature_table.GetBoundingBox(bbox_lo, bbox_hi);
 
-					if (pixelValue < 0)
-						pixelValue = 0;			// regularize
-					
-					this->SetFeatureValue(x, y, z, index_pos, pixelValue);
-					
-				}
+	InputImageType::RegionType crop_region;
+	for (int i = 0; i < 3; i++)
+	{
+		const int lo = std::max(bbox_lo[i] - 1, 0);
+		const int hi = std::min(bbox_hi[i] + 1, image_size[i] - 1);
+		crop_region.SetIndex(i, lo);
+		crop_region.SetSize(i, hi - lo + 1);
+	}
+	const std::int64_t crop_x = crop_region.GetSize(0), crop_y = crop_region.GetSize(1);
+	const int crop_lo[3] = { static_cast<int>(crop_region.GetIndex(0)), static_cast<int>(crop_region.GetIndex(1)), static_cast<int>(crop_region.GetIndex(2)) };
 
-			}
-		}
+	FloatImageType::Pointer gradient_image;
+	if (gradient)
+	{
+		CropFilterType::Pointer crop = CropFilterType::New();
+		crop->SetInput(_image->GetImage());
+		crop->SetRegionOfInterest(crop_region);
+
+		GradientFilterType::Pointer gradientFilter = GradientFilterType::New();
+		gradientFilter->SetInput(crop->GetOutput());
+		gradientFilter->Update();
+		gradient_image = gradientFilter->GetOutput();
 	}
 
-	
+	// the map of the label over the same crop, shared with earlier runs on the same mask
+	FloatImageType::Pointer distance_image;
+	if (distance)
+		distance_image = LaImageDistanceCache::SignedMaurerDistance(_mask_image->GetImage(), _mask_val_SMD, crop_region);
+
+	float* intensity_column = intensity_pos ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::intensity)) : NULL;
+	float* x_column = intensity_pos ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::pos_x)) : NULL;
+	float* y_column = intensity_pos ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::pos_y)) : NULL;
+	float* z_column = intensity_pos ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::pos_z)) : NULL;
+	float* class_column = intensity_pos ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::which_class)) : NULL;
+	float* gradient_column = gradient ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::grad_mag)) : NULL;
+	float* distance_column = distance ? _feature_table.GetColumn(FeatureColumn(LaImageFeatures::maurer_distance)) : NULL;
+
+	const unsigned short* image_buffer = _image->GetImage()->GetBufferPointer();
+	const unsigned short* mask_buffer = _mask_image->GetImage()->GetBufferPointer();
+	const float* gradient_buffer = gradient ? gradient_image->GetBufferPointer() : NULL;
+	const float* distance_buffer = distance ? distance_image->GetBufferPointer() : NULL;
+
+	vtkSMPTools::For(bbox_lo[2], bbox_hi[2] + 1, [&](vtkIdType z_begin, vtkIdType z_end) {
+		_feature_table.ForEachRow(static_cast<int>(z_begin), static_cast<int>(z_end), [&](std::int64_t row, int x, int y, int z) {
+			if (intensity_pos)
+			{
+				const std::int64_t offset = x + static_cast<std::int64_t>(max_x) * (y + static_cast<std::int64_t>(max_y) * z);
+				intensity_column[row] = static_cast<short>(image_buffer[offset]);
+				x_column[row] = x;
+				y_column[row] = y;
+				z_column[row] = z;
+				class_column[row] = static_cast<short>(mask_buffer[offset]);
+			}
 
+			const std::int64_t crop_offset = (x - crop_lo[0]) + crop_x * ((y - crop_lo[1]) + crop_y * (z - crop_lo[2]));
+			if (gradient)
+				gradient_column[row] = gradient_buffer[crop_offset];
+			if (distance)
+				distance_column[row] = std::max(distance_buffer[crop_offset], 0.0f);		// regularize
+		});
+	});
 }
 
 
 void LaImageFeatures::Update()
 {
 
-	// First Extract features 
-	ExtractFeature_Intensity_Pos();
-	ExtractFeature_GradientMagnitude();
-	ExtractFeature_SignedMaurerDistance();
+	// First Extract features, all in one pass
+	ExtractFeatures(true, true, true);
 
-	// Write Features to File 
+	if (!_bank_scales.empty())
+	{
+		LaImageFeatureBank bank;
+		bank.SetInputImage(_image->GetImage());
+		bank.SetScales(_bank_scales);
+		bank.Update(_feature_table);
+	}
+
+	// Write Features to File, straight from the feature columns
+	const std::vector<int> column_order = OutputColumns();
+
+	if (!_binary_filename.empty())
+	{
+		if (_feature_table.WriteBinary(_binary_filename, column_order))
+			std::cout << "Features written to " << _binary_filename << std::endl;
+	}
+	if (_csv_filename.empty())
+		return;
+
+	std::vector<const float*> columns;
 	std::ofstream out;
 	out.open(_csv_filename, std::fstream::out | std::fstream::trunc);
-	out << "Seq,Intensity,X,Y,Z,GradMag,MaurerDist,Class" << std::endl;
+	out << "Seq";
+	for (size_t c = 0; c < column_order.size(); c++)
+	{
+		columns.push_back(_feature_table.GetColumn(column_order[c]));
+		out << "," << _feature_table.GetColumnName(column_order[c]);
+	}
+	out << std::endl;
+
 	std::stringstream ss; 
-	
-	int icount = 0;
+	const std::int64_t num_rows = _feature_table.GetNumberOfRows();
 
-	for (int i = 0; i < _total_size; i++)
+	for (std::int64_t i = 0; i < num_rows; i++)
 	{
-		double intensity_feature = _image_features[i][0];
-
-		for (int j = 0; j < _max_features && intensity_feature != _my_nan ; j++)
+		ss << i;
+		for (size_t c = 0; c < columns.size(); c++)
 		{
-			
-			// running through all available features, taking index from our enumeration
-			// see enum: _feature_list
-			for (int k = LaImageFeatures::intensity; k != LaImageFeatures::Last; k++)
-			{
-				_feature_list feature_index = static_cast<_feature_list>(k);
-				double feature_value = _image_features[i][feature_index];
-				
-				if (feature_value != _my_nan)
-				{
-					if (k == 0)
-						ss << icount++ << "," << feature_value;
-					else 
-						ss << "," <<  std::setprecision(4) << feature_value;
-				}
+			// intensity is integral, the rest is rounded to 4 significant digits
+			if (c == 0)
+				ss << "," << std::setprecision(6) << columns[c][i];
+			else if (!std::isnan(columns[c][i]))
+				ss << "," << std::setprecision(4) << columns[c][i];
+			else
+				ss << ",";
+		}
+		ss << "\n";
 
-			}
-			ss << std::endl; 
-			out << ss.str().c_str(); 
+		// flushed in blocks rather than per row
+		if ((i & 4095) == 4095) {
+			out << ss.str();
 			ss.str(std::string());
-			
 		}
 	}
+	out << ss.str();
 	out.close();
 
 }
@@ -338,96 +336,71 @@ void LaImageFeatures::Update()
 
 void LaImageFeatures::Update_Haralick()
 {
-	typedef itk::Image< unsigned short, 3 >    InputImageType;
-	typedef itk::Neighborhood<unsigned short, 3> NeighborhoodType;
-	typedef itk::ImageRegionIterator<InputImageType>  IteratorType;
-	typedef itk::RegionOfInterestImageFilter<InputImageType, InputImageType> roiType;
-	typedef itk::Statistics::ScalarImageToCooccurrenceMatrixFilter<InputImageType> Image2CoOccuranceType;
-	typedef Image2CoOccuranceType::HistogramType HistogramType;
-	typedef itk::Statistics::HistogramToTextureFeaturesFilter<HistogramType> Hist2FeaturesType;
-	typedef InputImageType::OffsetType OffsetType;
-
-
-	InputImageType::Pointer mask = _mask_image->GetImage();
-	InputImageType::Pointer org_image = _image->GetImage();
-	
+	if (!_binary_filename.empty())
+		std::cerr << "LaImageFeatures::Update_Haralick — binary output is not supported for Haralick features, only the CSV is written" << std::endl;
+
+	// co-occurrence matrices slide with the window, see LaImageGLCM
+	LaImageGLCM glcm;
+	glcm.SetInputImage(_image->GetImage());
+	glcm.SetMask(_mask_image->GetImage(), _which_value);		// only selected pixels with a certain value
+	glcm.SetWindowRadius(_haralick_radius);
+	glcm.SetNumberOfBins(_haralick_bins);
+	glcm.SetIntensityRange(_haralick_min, _haralick_max);
+	glcm.SetDirections(_haralick_directions);
+	glcm.Update();
+
+	const std::int64_t num_voxels = glcm.GetNumberOfVoxels();
+	const int num_slots = static_cast<int>(glcm.GetDirections().size());
+	std::cout << "Haralick features: " << num_voxels << " voxels, " << num_slots << " directions" << std::endl;
+
 	std::ofstream out;
 	out.open(_csv_filename, std::fstream::out | std::fstream::trunc);
+	out << "Offset,X,Y,Z,inertia,correlation,energy,intensity,entropy,inverse_difference_moment,"
+		"cluster_shade,cluster_prominence,haralick_correlation" << std::endl;
+
+	const unsigned short* image_buffer = _image->GetImage()->GetBufferPointer();
+	int max_x, max_y, max_z;
+	_image->GetImageSize(max_x, max_y, max_z);
 
-	roiType::Pointer roi = roiType::New();
-	roi->SetInput(org_image);
-	
-	InputImageType::RegionType window;
-	InputImageType::RegionType::SizeType size;
-	
-	//window size=3x3x3, do not change without changng for loop 
-	// for further info: https://public.kitware.com/pipermail/insight-users/2014-October/051018.html
-	size.Fill(3); 
-	window.SetSize(size);
-	InputImageType::IndexType pi; //pixel index
-
-	NeighborhoodType neighborhood;
-	neighborhood.SetRadius(1);
-	unsigned int centerIndex = neighborhood.GetCenterNeighborhoodIndex();
-	OffsetType offset;
-	short mask_value; 
-
-	centerIndex = 1;		// only one direction 
-	
-	out << "Offset,X,Y,Z,inertia,correlation,energy,intensity" << std::endl;
-	for (unsigned int d = 0; d < centerIndex; d++)		// 13 offsets  i.e. 13 directions 
+	std::stringstream ss;
+	const int num_rows_per_voxel = _haralick_mean ? 1 : num_slots;
+	float features[LaImageGLCM::NumberOfFeatures];
+
+	for (int r = 0; r < num_rows_per_voxel; r++)
 	{
-		offset = neighborhood.GetOffset(d);
-		Image2CoOccuranceType::Pointer glcmGenerator = Image2CoOccuranceType::New();
-		glcmGenerator->SetOffset(offset);
-		glcmGenerator->SetNumberOfBinsPerAxis(16); //reasonable number of bins
-		glcmGenerator->SetPixelValueMinMax(0, 255); //for input UCHAR pixel type
-		Hist2FeaturesType::Pointer featureCalc = Hist2FeaturesType::New();
-
-		//slide window over the entire image
-		for (unsigned x = 1; x < org_image->GetLargestPossibleRegion().GetSize(0) - 1; x++)
+		for (std::int64_t v = 0; v < num_voxels; v++)
 		{
-			pi.SetElement(0, x);
-			window.SetIndex(0, x - 1);
-			for (unsigned y = 1; y < org_image->GetLargestPossibleRegion().GetSize(1) - 1; y++)
+			int x, y, z;
+			glcm.GetVoxel(v, x, y, z);
+
+			for (int f = 0; f < LaImageGLCM::NumberOfFeatures; f++)
 			{
-				
-				pi.SetElement(1, y);
-				window.SetIndex(1, y - 1);
-				for (unsigned z = 1; z < org_image->GetLargestPossibleRegion().GetSize(2) - 1; z++)
-				{
-					_mask_image->GetIntensityAt(x, y, z, mask_value);
-
-					if (mask_value == _which_value)		// only selected pixels with a certain value
-					{
-					pi.SetElement(2, z);
-						window.SetIndex(2, z - 1);		// window placed at top-left of current pixel 
-						roi->SetRegionOfInterest(window);
-						roi->Update();
-						glcmGenerator->SetInput(roi->GetOutput());
-						glcmGenerator->Update();
-						featureCalc->SetInput(glcmGenerator->GetOutput());
-						featureCalc->Update();
-
-						// total 9 features
-						double inertia = featureCalc->GetFeature(Hist2FeaturesType::TextureFeatureEnum::Inertia);
-						double correlation = featureCalc->GetFeature(Hist2FeaturesType::TextureFeatureEnum::Correlation);
-						double energy = featureCalc->GetFeature(Hist2FeaturesType::TextureFeatureEnum::Energy);
-						short intensity; 
-						_image->GetIntensityAt(x, y, z, intensity);
-
-						out << d << "," << x << "," << y << "," << z << "," << inertia << "," << correlation << "," << energy <<"," << intensity << std::endl;
-					
-					}	// end if 
-				}		// end for 
-				
-
-			} // end for 
-
-		} // end for 
-	}
+				if (_haralick_mean) {
+					double sum = 0;
+					for (int s = 0; s < num_slots; s++)
+						sum += glcm.GetFeature(v, s, f);
+					features[f] = static_cast<float>(sum / num_slots);
+				}
+				else
+					features[f] = glcm.GetFeature(v, r, f);
+			}
 
-	out.close();
+			const short intensity = static_cast<short>(image_buffer[x + static_cast<std::int64_t>(max_x) * (y + static_cast<std::int64_t>(max_y) * z)]);
 
-	
-}
\ No newline at end of file
+			// the original columns first, the other features after them
+			ss << (_haralick_mean ? -1 : glcm.GetDirections()[r]) << "," << x << "," << y << "," << z
+				<< "," << features[LaImageGLCM::Inertia] << "," << features[LaImageGLCM::Correlation]
+				<< "," << features[LaImageGLCM::Energy] << "," << intensity
+				<< "," << features[LaImageGLCM::Entropy] << "," << features[LaImageGLCM::InverseDifferenceMoment]
+				<< "," << features[LaImageGLCM::ClusterShade] << "," << features[LaImageGLCM::ClusterProminence]
+				<< "," << features[LaImageGLCM::HaralickCorrelation] << "\n";
+
+			if ((v & 4095) == 4095) {
+				out << ss.str();
+				ss.str(std::string());
+			}
+		}
+	}
+	out << ss.str();
+	out.close();
+}
@@ -0,0 +1,378 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <vtkSMPTools.h>
+
+#include "../include/LaImageGLCM.h"
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+const unsigned char kExcluded = 255;     // quantised value outside [min, max]
+
+/*
+ * Quantised intensities over a box of the image, x fastest.
+ */
+struct QuantisedBox {
+    int origin[3];
+    int size[3];
+    std::vector<unsigned char> bins;
+
+    unsigned char At(int x, int y, int z) const {
+        return bins[static_cast<size_t>(x - origin[0]) +
+                    static_cast<size_t>(size[0]) * (static_cast<size_t>(y - origin[1]) +
+                    static_cast<size_t>(size[1]) * static_cast<size_t>(z - origin[2]))];
+    }
+};
+
+/*
+ * Window of the current voxel: x in [lo, hi], y in [ylo, yhi],
+ * z in [zlo, zhi].
+ */
+struct Window {
+    int lo, hi;
+    int ylo, yhi;
+    int zlo, zhi;
+};
+
+/*
+ * Adds sign to the symmetric counts of every pair (p, p + d) with p.x == px,
+ * both ends inside window and both intensities in range.
+ */
+void CountPairs(const QuantisedBox& box, const Window& w, const int d[3], int px,
+                int bins, int sign, std::int32_t* counts) {
+    const int qx = px + d[0];
+    if (px < w.lo || px > w.hi || qx < w.lo || qx > w.hi) return;
+
+    for (int pz = w.zlo; pz <= w.zhi; ++pz) {
+        const int qz = pz + d[2];
+        if (qz < w.zlo || qz > w.zhi) continue;
+        for (int py = w.ylo; py <= w.yhi; ++py) {
+            const int qy = py + d[1];
+            if (qy < w.ylo || qy > w.yhi) continue;
+
+            const unsigned char a = box.At(px, py, pz);
+            const unsigned char b = box.At(qx, qy, qz);
+            if (a == kExcluded || b == kExcluded) continue;
+            counts[a * bins + b] += sign;
+            counts[b * bins + a] += sign;
+        }
+    }
+}
+
+void ComputeFeatures(const std::int32_t* counts, int bins, std::vector<double>& marginal,
+                     float* features) {
+    std::int64_t total = 0;
+    for (int k = 0; k < bins * bins; ++k) total += counts[k];
+    if (total == 0) {
+        std::fill(features, features + LaImageGLCM::NumberOfFeatures, 0.0f);
+        return;
+    }
+    const double inv_total = 1.0 / static_cast<double>(total);
+
+    marginal.assign(static_cast<size_t>(bins), 0.0);
+    for (int i = 0; i < bins; ++i) {
+        std::int64_t row = 0;
+        for (int j = 0; j < bins; ++j) row += counts[i * bins + j];
+        marginal[i] = row * inv_total;
+    }
+    double mu = 0.0, variance = 0.0;
+    for (int i = 0; i < bins; ++i) mu += i * marginal[i];
+    for (int i = 0; i < bins; ++i) variance += (i - mu) * (i - mu) * marginal[i];
+
+    // mean and variance of the marginal sums themselves, as ITK's HaralickCorrelation uses them
+    double marginal_mean = 0.0, marginal_variance = 0.0;
+    for (int i = 0; i < bins; ++i) marginal_mean += marginal[i];
+    marginal_mean /= bins;
+    for (int i = 0; i < bins; ++i) marginal_variance += (marginal[i] - marginal_mean) * (marginal[i] - marginal_mean);
+    marginal_variance /= bins;
+
+    double energy = 0.0, entropy = 0.0, correlation = 0.0, idm = 0.0;
+    double inertia = 0.0, shade = 0.0, prominence = 0.0, ij_sum = 0.0;
+    for (int i = 0; i < bins; ++i) {
+        for (int j = 0; j < bins; ++j) {
+            const std::int32_t c = counts[i * bins + j];
+            if (c == 0) continue;
+            const double p    = c * inv_total;
+            const double diff = static_cast<double>(i - j);
+            const double s    = i + j - 2.0 * mu;
+
+            energy      += p * p;
+            if (p > 0.0001) entropy -= p * std::log2(p);      // ITK's cut-off
+            correlation += (i - mu) * (j - mu) * p;
+            idm         += p / (1.0 + diff * diff);
+            inertia     += diff * diff * p;
+            shade       += s * s * s * p;
+            prominence  += s * s * s * s * p;
+            ij_sum      += static_cast<double>(i) * j * p;
+        }
+    }
+
+    features[LaImageGLCM::Energy]                  = static_cast<float>(energy);
+    features[LaImageGLCM::Entropy]                 = static_cast<float>(entropy);
+    features[LaImageGLCM::Correlation]             = static_cast<float>(variance > 0.0 ? correlation / (variance * variance) : 0.0);
+    features[LaImageGLCM::InverseDifferenceMoment] = static_cast<float>(idm);
+    features[LaImageGLCM::Inertia]                 = static_cast<float>(inertia);
+    features[LaImageGLCM::ClusterShade]            = static_cast<float>(shade);
+    features[LaImageGLCM::ClusterProminence]       = static_cast<float>(prominence);
+    features[LaImageGLCM::HaralickCorrelation]     = static_cast<float>(marginal_variance > 0.0 ?
+                                                     (ij_sum - marginal_mean * marginal_mean) / marginal_variance : 0.0);
+}
+
+} // namespace
+
+
+// ============================================================
+// Construction and setup
+// ============================================================
+
+const char* LaImageGLCM::FeatureName(int feature) {
+    switch (feature) {
+        case Energy:                  return "energy";
+        case Entropy:                 return "entropy";
+        case Correlation:             return "correlation";
+        case InverseDifferenceMoment: return "inverse_difference_moment";
+        case Inertia:                 return "inertia";
+        case ClusterShade:            return "cluster_shade";
+        case ClusterProminence:       return "cluster_prominence";
+        case HaralickCorrelation:     return "haralick_correlation";
+    }
+    return "";
+}
+
+void LaImageGLCM::GetDirection(int direction, int offset[3]) {
+    offset[0] = direction % 3 - 1;
+    offset[1] = direction / 3 % 3 - 1;
+    offset[2] = direction / 9 - 1;
+}
+
+LaImageGLCM::LaImageGLCM() :
+    _image(nullptr),
+    _mask(nullptr),
+    _label(1),
+    _radius(1),
+    _bins(16),
+    _min(0),
+    _max(255) {
+    for (int d = 0; d < NumberOfDirections; ++d) _directions.push_back(d);
+}
+
+void LaImageGLCM::SetInputImage(const ImageType* image) {
+    _image = image;
+}
+
+void LaImageGLCM::SetMask(const ImageType* mask, unsigned short label) {
+    _mask  = mask;
+    _label = label;
+}
+
+void LaImageGLCM::SetWindowRadius(int radius) {
+    _radius = std::max(1, radius);
+}
+
+void LaImageGLCM::SetNumberOfBins(int bins) {
+    _bins = std::max(2, std::min(bins, static_cast<int>(kExcluded)));
+}
+
+void LaImageGLCM::SetIntensityRange(int min, int max) {
+    _min = std::min(min, max);
+    _max = std::max(min, max);
+}
+
+void LaImageGLCM::SetDirections(const std::vector<int>& directions) {
+    _directions.clear();
+    for (const int d : directions) {
+        if (d >= 0 && d < NumberOfDirections) _directions.push_back(d);
+    }
+}
+
+
+// ============================================================
+// Update
+// ============================================================
+
+void LaImageGLCM::Update() {
+    const std::string INFO = "LaImageGLCM::Update — ";
+
+    _voxel_x.clear();
+    _voxel_y.clear();
+    _voxel_z.clear();
+    _features.clear();
+
+    if (!_image || !_mask) {
+        std::cerr << INFO << "set the image and the mask first." << std::endl;
+        return;
+    }
+    const ImageType::SizeType size = _image->GetBufferedRegion().GetSize();
+    if (size != _mask->GetBufferedRegion().GetSize()) {
+        std::cerr << INFO << "image and mask differ in size." << std::endl;
+        return;
+    }
+    if (_directions.empty()) {
+        std::cerr << INFO << "no directions selected." << std::endl;
+        return;
+    }
+
+    const int nx = static_cast<int>(size[0]);
+    const int ny = static_cast<int>(size[1]);
+    const int nz = static_cast<int>(size[2]);
+    const unsigned short* mask = _mask->GetBufferPointer();
+
+    // ---- Selected voxels in memory order, grouped by scanline ---------------
+    std::vector<std::int64_t> line_offsets(static_cast<size_t>(ny) * nz + 1, 0);
+    int bbox_lo[3] = {nx, ny, nz};
+    int bbox_hi[3] = {-1, -1, -1};
+    for (int z = 0; z < nz; ++z) {
+        for (int y = 0; y < ny; ++y) {
+            const unsigned short* row = mask + static_cast<size_t>(nx) * (y + static_cast<size_t>(ny) * z);
+            for (int x = 0; x < nx; ++x) {
+                if (row[x] != _label) continue;
+                _voxel_x.push_back(x);
+                _voxel_y.push_back(y);
+                _voxel_z.push_back(z);
+                const int xyz[3] = {x, y, z};
+                for (int a = 0; a < 3; ++a) {
+                    bbox_lo[a] = std::min(bbox_lo[a], xyz[a]);
+                    bbox_hi[a] = std::max(bbox_hi[a], xyz[a]);
+                }
+            }
+            line_offsets[static_cast<size_t>(z) * ny + y + 1] = static_cast<std::int64_t>(_voxel_x.size());
+        }
+    }
+
+    const std::int64_t num_voxels = GetNumberOfVoxels();
+    if (num_voxels == 0) {
+        std::cerr << INFO << "no voxels with label " << _label << " in the mask." << std::endl;
+        return;
+    }
+
+    // ---- Quantise the bounding box grown by the window ---------------------
+    const int image_size[3] = {nx, ny, nz};
+    QuantisedBox box;
+    for (int a = 0; a < 3; ++a) {
+        box.origin[a] = std::max(0, bbox_lo[a] - _radius);
+        box.size[a]   = std::min(image_size[a] - 1, bbox_hi[a] + _radius) - box.origin[a] + 1;
+    }
+    box.bins.resize(static_cast<size_t>(box.size[0]) * box.size[1] * box.size[2]);
+
+    const unsigned short* image = _image->GetBufferPointer();
+    const double bin_scale = static_cast<double>(_bins) / (static_cast<double>(_max) - _min + 1.0);
+    vtkSMPTools::For(0, box.size[2], [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType bz = begin; bz < end; ++bz) {
+            for (int by = 0; by < box.size[1]; ++by) {
+                const unsigned short* src = image + box.origin[0] + static_cast<size_t>(nx) *
+                    ((box.origin[1] + by) + static_cast<size_t>(ny) * (box.origin[2] + bz));
+                unsigned char* dst = &box.bins[static_cast<size_t>(box.size[0]) * (by + static_cast<size_t>(box.size[1]) * bz)];
+                for (int bx = 0; bx < box.size[0]; ++bx) {
+                    const int v = src[bx];
+                    dst[bx] = (v < _min || v > _max)
+                        ? kExcluded
+                        : static_cast<unsigned char>(std::min(_bins - 1, static_cast<int>((v - _min) * bin_scale)));
+                }
+            }
+        }
+    });
+
+    // ---- Slide the window along each scanline, z-slabs in parallel --------
+    const int num_slots  = static_cast<int>(_directions.size());
+    const int matrix     = _bins * _bins;
+    const int max_gap    = 2 * _radius + 1;
+    _features.assign(static_cast<size_t>(num_voxels) * num_slots * NumberOfFeatures, 0.0f);
+
+    std::vector<int> offsets(static_cast<size_t>(3 * num_slots));
+    for (int s = 0; s < num_slots; ++s) GetDirection(_directions[s], &offsets[3 * s]);
+
+    vtkSMPTools::For(bbox_lo[2], bbox_hi[2] + 1, [&](vtkIdType z_begin, vtkIdType z_end) {
+        std::vector<std::int32_t> counts(static_cast<size_t>(num_slots) * matrix);
+        std::vector<double> marginal;
+
+        for (vtkIdType z = z_begin; z < z_end; ++z) {
+            for (int y = bbox_lo[1]; y <= bbox_hi[1]; ++y) {
+                const size_t line = static_cast<size_t>(z) * ny + y;
+                if (line_offsets[line] == line_offsets[line + 1]) continue;
+
+                Window w;
+                w.ylo = std::max(box.origin[1], y - _radius);
+                w.yhi = std::min(box.origin[1] + box.size[1] - 1, y + _radius);
+                w.zlo = std::max(box.origin[2], static_cast<int>(z) - _radius);
+                w.zhi = std::min(box.origin[2] + box.size[2] - 1, static_cast<int>(z) + _radius);
+
+                bool valid = false;
+                int  previous_x = 0;
+
+                for (std::int64_t v = line_offsets[line]; v < line_offsets[line + 1]; ++v) {
+                    const int x    = _voxel_x[v];
+                    const int lo_t = std::max(box.origin[0], x - _radius);
+                    const int hi_t = std::min(box.origin[0] + box.size[0] - 1, x + _radius);
+
+                    if (!valid || x - previous_x > max_gap) {
+                        // restart: count the whole window
+                        std::fill(counts.begin(), counts.end(), 0);
+                        w.lo = lo_t;
+                        w.hi = hi_t;
+                        for (int s = 0; s < num_slots; ++s) {
+                            for (int px = w.lo; px <= w.hi; ++px)
+                                CountPairs(box, w, &offsets[3 * s], px, _bins, 1, &counts[static_cast<size_t>(s) * matrix]);
+                        }
+                        valid = true;
+                    } else {
+                        // slide: drop the pairs starting at plane lo, add those ending at hi + 1
+                        while (w.lo < lo_t) {
+                            for (int s = 0; s < num_slots; ++s) {
+                                const int* d = &offsets[3 * s];
+                                CountPairs(box, w, d, (d[0] >= 0) ? w.lo : w.lo - d[0], _bins, -1,
+                                           &counts[static_cast<size_t>(s) * matrix]);
+                            }
+                            ++w.lo;
+                        }
+                        while (w.hi < hi_t) {
+                            ++w.hi;
+                            for (int s = 0; s < num_slots; ++s) {
+                                const int* d = &offsets[3 * s];
+                                CountPairs(box, w, d, (d[0] <= 0) ? w.hi : w.hi - d[0], _bins, 1,
+                                           &counts[static_cast<size_t>(s) * matrix]);
+                            }
+                        }
+                    }
+                    previous_x = x;
+
+                    for (int s = 0; s < num_slots; ++s) {
+                        ComputeFeatures(&counts[static_cast<size_t>(s) * matrix], _bins, marginal,
+                                        &_features[(static_cast<size_t>(v) * num_slots + s) * NumberOfFeatures]);
+                    }
+                }
+            }
+        }
+    });
+}
+
+
+// ============================================================
+// Results
+// ============================================================
+
+std::int64_t LaImageGLCM::GetNumberOfVoxels() const {
+    return static_cast<std::int64_t>(_voxel_x.size());
+}
+
+void LaImageGLCM::GetVoxel(std::int64_t voxel, int& x, int& y, int& z) const {
+    x = _voxel_x[voxel];
+    y = _voxel_y[voxel];
+    z = _voxel_z[voxel];
+}
+
+const std::vector<int>& LaImageGLCM::GetDirections() const {
+    return _directions;
+}
+
+float LaImageGLCM::GetFeature(std::int64_t voxel, int slot, int feature) const {
+    return _features[(static_cast<size_t>(voxel) * _directions.size() + slot) * NumberOfFeatures + feature];
+}
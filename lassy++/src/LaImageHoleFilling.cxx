@@ -2,17 +2,479 @@
 
 #include <iostream>    // using IO functions
 #include <string>      // using string
+#include <vector>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <functional>
+#include <utility>
+#include <vtkSMPTools.h>
 #include "../include/LaImageHoleFilling.h"
 
 
 ;
 
 
+namespace {
+
+/*
+*   Neighbourhood of the hole filling, in itk::Neighborhood order (z outermost, x fastest)
+*/
+struct Neighbourhood {
+    int radius[3];
+    std::vector<int> dx, dy, dz;
+    std::vector<std::int64_t> offset;
+};
+
+Neighbourhood MakeNeighbourhood(int direction, std::int64_t nx, std::int64_t ny)
+{
+    Neighbourhood n;
+    n.radius[0] = (direction == YZ) ? 0 : 1;
+    n.radius[1] = (direction == XZ) ? 0 : 1;
+    n.radius[2] = (direction == XY) ? 0 : 1;
+
+    for (int z = -n.radius[2]; z <= n.radius[2]; z++)
+        for (int y = -n.radius[1]; y <= n.radius[1]; y++)
+            for (int x = -n.radius[0]; x <= n.radius[0]; x++)
+            {
+                n.dx.push_back(x);
+                n.dy.push_back(y);
+                n.dz.push_back(z);
+                n.offset.push_back(x + nx * (y + ny * z));
+            }
+    return n;
+}
+
+
+/*
+*   Axes the fill works along, from the interpolation direction
+*/
+void ActiveAxes(int direction, bool active[3])
+{
+    active[0] = (direction != YZ);
+    active[1] = (direction != XZ);
+    active[2] = (direction != XY);
+}
+
+/*
+*   Holes of the fast-marching and multigrid fills: the zero voxels that are not connected, along
+*   the active axes, to the border of the image, i.e. that are enclosed by positive or negative
+*   voxels. Zero background reaching the border is left as it is. The border holes are found in
+*   z-slabs in parallel and flooded from there.
+*/
+std::vector<unsigned char> EnclosedHoles(const float* values, const std::int64_t n[3], const bool active[3])
+{
+    const std::int64_t stride[3] = { 1, n[0], n[0] * n[1] };
+    std::vector<unsigned char> enclosed(static_cast<size_t>(n[0] * n[1] * n[2]));
+    std::vector<std::vector<std::int64_t>> slab_seeds(static_cast<size_t>(n[2]));
+
+    vtkSMPTools::For(0, n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < n[1]; y++)
+                for (std::int64_t x = 0; x < n[0]; x++)
+                {
+                    const std::int64_t p = x + stride[1] * y + stride[2] * z;
+                    enclosed[p] = (values[p] == 0);
+                    if (!enclosed[p]) continue;
+
+                    const std::int64_t c[3] = { x, y, z };
+                    for (int a = 0; a < 3; a++)
+                    {
+                        if (active[a] && (c[a] == 0 || c[a] == n[a] - 1))
+                        {
+                            enclosed[p] = 0;
+                            slab_seeds[z].push_back(p);
+                            break;
+                        }
+                    }
+                }
+    });
+
+    std::vector<std::int64_t> stack;
+    for (std::int64_t z = 0; z < n[2]; z++)
+        stack.insert(stack.end(), slab_seeds[z].begin(), slab_seeds[z].end());
+
+    while (!stack.empty())
+    {
+        const std::int64_t p = stack.back();
+        stack.pop_back();
+
+        const std::int64_t c[3] = { p % n[0], (p / n[0]) % n[1], p / stride[2] };
+        for (int a = 0; a < 3; a++)
+        {
+            if (!active[a]) continue;
+            if (c[a] > 0 && enclosed[p - stride[a]])
+            {
+                enclosed[p - stride[a]] = 0;
+                stack.push_back(p - stride[a]);
+            }
+            if (c[a] < n[a] - 1 && enclosed[p + stride[a]])
+            {
+                enclosed[p + stride[a]] = 0;
+                stack.push_back(p + stride[a]);
+            }
+        }
+    }
+    return enclosed;
+}
+
+// ---- Fast marching ----------------------------------------------------------
+
+const unsigned char kInside = 0;    // hole not reached yet
+const unsigned char kBand = 1;      // hole reached and filled, arrival time not final
+const unsigned char kKnown = 2;     // known voxel, or hole with a final arrival time
+const unsigned char kIgnored = 3;   // negative voxel, or zero background
+
+/*
+*   Arrival time at p from the known voxels along the active axes, first-order upwind
+*/
+float SolveEikonal(const std::vector<float>& arrival, const std::vector<unsigned char>& state,
+                   std::int64_t p, const std::int64_t c[3], const std::int64_t n[3],
+                   const std::int64_t stride[3], const bool active[3])
+{
+    double t[3];
+    int m = 0;
+    for (int a = 0; a < 3; a++)
+    {
+        if (!active[a]) continue;
+
+        double t_min = std::numeric_limits<double>::infinity();
+        if (c[a] > 0 && state[p - stride[a]] == kKnown)
+            t_min = std::min(t_min, static_cast<double>(arrival[p - stride[a]]));
+        if (c[a] < n[a] - 1 && state[p + stride[a]] == kKnown)
+            t_min = std::min(t_min, static_cast<double>(arrival[p + stride[a]]));
+        if (std::isfinite(t_min))
+            t[m++] = t_min;
+    }
+    if (m == 0)
+        return std::numeric_limits<float>::infinity();
+    for (int i = 1; i < m; i++)
+        for (int j = i; j > 0 && t[j] < t[j - 1]; j--)
+            std::swap(t[j], t[j - 1]);
+
+    double solution = t[0] + 1;
+    if (m >= 2 && solution > t[1])
+    {
+        solution = 0.5 * (t[0] + t[1] + std::sqrt(2 - (t[0] - t[1]) * (t[0] - t[1])));
+        if (m == 3 && solution > t[2])
+        {
+            const double sum = t[0] + t[1] + t[2];
+            const double sum_sq = t[0] * t[0] + t[1] * t[1] + t[2] * t[2];
+            solution = (sum + std::sqrt(std::max(sum * sum - 3 * (sum_sq - 1), 0.0))) / 3;
+        }
+    }
+    return static_cast<float>(solution);
+}
+
+// ---- Multigrid --------------------------------------------------------------
+
+const unsigned char kUnknown = 0;   // hole
+const unsigned char kFixed = 1;     // known voxel, Dirichlet value
+const unsigned char kLeftOut = 2;   // negative voxel or zero background, no coupling
+
+/*
+*   One level of the multigrid hierarchy; coarser levels halve the active axes
+*/
+struct GridLevel {
+    std::int64_t n[3];
+    std::int64_t factor[3];         // cells of the finer level per cell of this one
+    float w[3];                     // 1/h^2 along the active axes, 0 along the others
+    std::vector<unsigned char> type;
+    std::vector<float> u, f, diag, tmp, au;
+
+    std::int64_t Count() const { return n[0] * n[1] * n[2]; }
+};
+
+/*
+*   out = L in, the 7-point Laplacian, at every cell that is not left out. Neighbours outside
+*   the grid or left out do not couple (zero flux).
+*/
+void ApplyLaplacian(const GridLevel& g, const float* in, float* out)
+{
+    const std::int64_t stride[3] = { 1, g.n[0], g.n[0] * g.n[1] };
+
+    vtkSMPTools::For(0, g.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < g.n[1]; y++)
+                for (std::int64_t x = 0; x < g.n[0]; x++)
+                {
+                    const std::int64_t p = x + stride[1] * y + stride[2] * z;
+                    if (g.type[p] == kLeftOut)
+                    {
+                        out[p] = 0;
+                        continue;
+                    }
+
+                    const std::int64_t c[3] = { x, y, z };
+                    float sum = 0;
+                    for (int a = 0; a < 3; a++)
+                    {
+                        if (g.w[a] == 0) continue;
+                        if (c[a] > 0 && g.type[p - stride[a]] != kLeftOut)
+                            sum += g.w[a] * (in[p - stride[a]] - in[p]);
+                        if (c[a] < g.n[a] - 1 && g.type[p + stride[a]] != kLeftOut)
+                            sum += g.w[a] * (in[p + stride[a]] - in[p]);
+                    }
+                    out[p] = sum;
+                }
+    });
+}
+
+/*
+*   Diagonal of L: minus the sum of the coupling weights
+*/
+void ComputeDiagonal(GridLevel& g)
+{
+    const std::int64_t stride[3] = { 1, g.n[0], g.n[0] * g.n[1] };
+
+    vtkSMPTools::For(0, g.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < g.n[1]; y++)
+                for (std::int64_t x = 0; x < g.n[0]; x++)
+                {
+                    const std::int64_t p = x + stride[1] * y + stride[2] * z;
+                    const std::int64_t c[3] = { x, y, z };
+                    float sum = 0;
+                    for (int a = 0; a < 3; a++)
+                    {
+                        if (g.w[a] == 0) continue;
+                        const int couplings = (c[a] > 0 && g.type[p - stride[a]] != kLeftOut)
+                                            + (c[a] < g.n[a] - 1 && g.type[p + stride[a]] != kLeftOut);
+                        sum += couplings * g.w[a];
+                    }
+                    g.diag[p] = -sum;
+                }
+    });
+}
+
+/*
+*   Damped Jacobi on the unknown cells
+*/
+void Smooth(GridLevel& g, int iterations)
+{
+    const float omega = 0.8f;
+
+    for (int it = 0; it < iterations; it++)
+    {
+        ApplyLaplacian(g, g.u.data(), g.au.data());
+        vtkSMPTools::For(0, g.Count(), [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType p = begin; p < end; p++)
+            {
+                if (g.type[p] == kUnknown && g.diag[p] != 0)
+                    g.u[p] += omega * (g.f[p] - g.au[p]) / g.diag[p];
+            }
+        });
+    }
+}
+
+/*
+*   |f - A u| over the unknown cells for A = L, or A = L L with biharmonic, z-slabs summed in
+*   parallel
+*/
+double ResidualNorm(GridLevel& g, bool biharmonic = false)
+{
+    if (biharmonic)
+    {
+        ApplyLaplacian(g, g.u.data(), g.tmp.data());
+        ApplyLaplacian(g, g.tmp.data(), g.au.data());
+    }
+    else
+        ApplyLaplacian(g, g.u.data(), g.au.data());
+
+    const std::int64_t slab = g.n[0] * g.n[1];
+    std::vector<double> slab_sums(static_cast<size_t>(g.n[2]), 0.0);
+    vtkSMPTools::For(0, g.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t p = z * slab; p < (z + 1) * slab; p++)
+            {
+                if (g.type[p] != kUnknown) continue;
+                const double r = g.f[p] - g.au[p];
+                slab_sums[z] += r * r;
+            }
+    });
+
+    double sum = 0;
+    for (size_t z = 0; z < slab_sums.size(); z++)
+        sum += slab_sums[z];
+    return std::sqrt(sum);
+}
+
+/*
+*   Next coarser level: a cell is fixed if any of its cells is, else unknown if any is. Cells
+*   along the edge of the holes stay fixed, so the coarse corrections vanish there.
+*/
+GridLevel Coarsen(const GridLevel& fine)
+{
+    GridLevel coarse;
+    for (int a = 0; a < 3; a++)
+    {
+        coarse.factor[a] = (fine.w[a] > 0 && fine.n[a] > 1) ? 2 : 1;
+        coarse.n[a] = (fine.n[a] + coarse.factor[a] - 1) / coarse.factor[a];
+        coarse.w[a] = fine.w[a] / static_cast<float>(coarse.factor[a] * coarse.factor[a]);
+    }
+
+    const std::int64_t count = coarse.Count();
+    coarse.type.assign(static_cast<size_t>(count), kLeftOut);
+    for (std::int64_t z = 0; z < fine.n[2]; z++)
+        for (std::int64_t y = 0; y < fine.n[1]; y++)
+            for (std::int64_t x = 0; x < fine.n[0]; x++)
+            {
+                const std::int64_t p = x + fine.n[0] * (y + fine.n[1] * z);
+                const std::int64_t parent = x / coarse.factor[0] + coarse.n[0] * (y / coarse.factor[1] + coarse.n[1] * (z / coarse.factor[2]));
+                unsigned char& type = coarse.type[parent];
+                if (fine.type[p] == kFixed || (fine.type[p] == kUnknown && type == kLeftOut))
+                    type = fine.type[p];
+            }
+
+    coarse.u.assign(static_cast<size_t>(count), 0.0f);
+    coarse.f.assign(static_cast<size_t>(count), 0.0f);
+    coarse.diag.assign(static_cast<size_t>(count), 0.0f);
+    coarse.tmp.assign(static_cast<size_t>(count), 0.0f);
+    coarse.au.assign(static_cast<size_t>(count), 0.0f);
+    return coarse;
+}
+
+/*
+*   coarse.f = mean of f - A u (in fine.au) over the unknown cells of each coarse cell
+*/
+void RestrictResidual(const GridLevel& fine, GridLevel& coarse)
+{
+    vtkSMPTools::For(0, coarse.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t Z = z_begin; Z < z_end; Z++)
+            for (std::int64_t Y = 0; Y < coarse.n[1]; Y++)
+                for (std::int64_t X = 0; X < coarse.n[0]; X++)
+                {
+                    const std::int64_t P = X + coarse.n[0] * (Y + coarse.n[1] * Z);
+                    float sum = 0;
+                    int count = 0;
+                    for (std::int64_t z = Z * coarse.factor[2]; z < std::min((Z + 1) * coarse.factor[2], fine.n[2]); z++)
+                        for (std::int64_t y = Y * coarse.factor[1]; y < std::min((Y + 1) * coarse.factor[1], fine.n[1]); y++)
+                            for (std::int64_t x = X * coarse.factor[0]; x < std::min((X + 1) * coarse.factor[0], fine.n[0]); x++)
+                            {
+                                const std::int64_t p = x + fine.n[0] * (y + fine.n[1] * z);
+                                if (fine.type[p] != kUnknown) continue;
+                                sum += fine.f[p] - fine.au[p];
+                                count++;
+                            }
+                    coarse.f[P] = (count > 0) ? sum / count : 0.0f;
+                }
+    });
+}
+
+/*
+*   fine.u += coarse.u on the unknown cells, piecewise constant
+*/
+void ProlongAndCorrect(const GridLevel& coarse, GridLevel& fine)
+{
+    vtkSMPTools::For(0, fine.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < fine.n[1]; y++)
+                for (std::int64_t x = 0; x < fine.n[0]; x++)
+                {
+                    const std::int64_t p = x + fine.n[0] * (y + fine.n[1] * z);
+                    if (fine.type[p] != kUnknown) continue;
+                    fine.u[p] += coarse.u[x / coarse.factor[0] + coarse.n[0] * (y / coarse.factor[1] + coarse.n[1] * (z / coarse.factor[2]))];
+                }
+    });
+}
+
+/*
+*   Initial guess by nested iteration: the known values are averaged down the levels, the
+*   coarsest level is smoothed to convergence, and every finer level starts from the level
+*   below, piecewise constant, and is smoothed in turn
+*/
+void NestedIteration(std::vector<GridLevel>& levels)
+{
+    for (size_t l = 1; l < levels.size(); l++)
+    {
+        const GridLevel& fine = levels[l - 1];
+        GridLevel& coarse = levels[l];
+        std::vector<float> sums(coarse.u.size(), 0.0f), counts(coarse.u.size(), 0.0f);
+        for (std::int64_t z = 0; z < fine.n[2]; z++)
+            for (std::int64_t y = 0; y < fine.n[1]; y++)
+                for (std::int64_t x = 0; x < fine.n[0]; x++)
+                {
+                    const std::int64_t p = x + fine.n[0] * (y + fine.n[1] * z);
+                    const std::int64_t parent = x / coarse.factor[0] + coarse.n[0] * (y / coarse.factor[1] + coarse.n[1] * (z / coarse.factor[2]));
+                    if (fine.type[p] != coarse.type[parent]) continue;
+                    sums[parent] += fine.u[p];
+                    counts[parent] += 1;
+                }
+        for (size_t P = 0; P < coarse.u.size(); P++)
+        {
+            coarse.u[P] = (counts[P] > 0) ? sums[P] / counts[P] : 0.0f;
+            coarse.f[P] = 0;
+        }
+    }
+
+    Smooth(levels.back(), 100);
+    for (size_t l = levels.size() - 1; l > 0; l--)
+    {
+        const GridLevel& coarse = levels[l];
+        GridLevel& fine = levels[l - 1];
+        vtkSMPTools::For(0, fine.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+            for (std::int64_t z = z_begin; z < z_end; z++)
+                for (std::int64_t y = 0; y < fine.n[1]; y++)
+                    for (std::int64_t x = 0; x < fine.n[0]; x++)
+                    {
+                        const std::int64_t p = x + fine.n[0] * (y + fine.n[1] * z);
+                        if (fine.type[p] != kUnknown) continue;
+                        fine.u[p] = coarse.u[x / coarse.factor[0] + coarse.n[0] * (y / coarse.factor[1] + coarse.n[1] * (z / coarse.factor[2]))];
+                    }
+        });
+        Smooth(fine, 10);
+    }
+}
+
+void VCycle(std::vector<GridLevel>& levels, size_t l)
+{
+    GridLevel& g = levels[l];
+    if (l + 1 == levels.size())
+    {
+        Smooth(g, 100);
+        return;
+    }
+
+    Smooth(g, 3);
+    ApplyLaplacian(g, g.u.data(), g.au.data());
+
+    GridLevel& coarse = levels[l + 1];
+    RestrictResidual(g, coarse);
+    std::fill(coarse.u.begin(), coarse.u.end(), 0.0f);
+    VCycle(levels, l + 1);
+    ProlongAndCorrect(coarse, g);
+
+    Smooth(g, 3);
+}
+
+/*
+*   L u = f on the unknown cells of the finest level, from its current u, by Laplace V-cycles
+*   until the residual is below target (at most max_cycles); returns the cycles run
+*/
+int SolveLaplace(std::vector<GridLevel>& levels, double target, int max_cycles)
+{
+    int cycle = 0;
+    while (cycle < max_cycles && ResidualNorm(levels[0]) > target)
+    {
+        VCycle(levels, 0);
+        cycle++;
+    }
+    return cycle;
+}
+
+} // namespace
+
+
 LaImageHoleFilling::LaImageHoleFilling()
 {
     _min_neighbours = 0;
     _iter = 1;
     _interpolate_direction = XYZ;
+    _fill_method = FILL_MEAN;
+    _inpaint_radius = 3;
 }
   
 
@@ -46,149 +508,633 @@ void LaImageHoleFilling::SetInterpolateDirection(int dir)
     _interpolate_direction = dir;
 }
 
-void LaImageHoleFilling::Update()
+void LaImageHoleFilling::SetFillMethod(int method)
 {
-	int max_x, max_y, max_z, max_x2, max_y2, max_z2,all_neighbours; 
-	typedef itk::Image<  float, 3 >  ImageType;
-    typedef itk::Image< float, 3 >  OutputImageType;
+    _fill_method = method;
+}
 
-	ImageType::IndexType pixelIndex;
+void LaImageHoleFilling::SetInpaintRadius(int radius)
+{
+    _inpaint_radius = radius;
+}
 
+/*
+*   Holes are the voxels equal to 0; positive voxels are known and negative ones are left out
+*   of every fill. The input image is left untouched: the fills work on a copy of it.
+*/
+void LaImageHoleFilling::Update()
+{
+	int max_x, max_y, max_z;
     ImageType::Pointer input_im = _input_img->GetImage();
     _input_img->GetImageSize(max_x, max_y, max_z);
     std::cout << max_x << "," << max_y << "," << max_z << std::endl;
 
-    OutputImageType::SpacingType spacing_out;
-    OutputImageType::SizeType size;
-    OutputImageType::RegionType region;
-    OutputImageType::IndexType start;
-
-    ImageType::RegionType in_region;
-
-    using InputImageIterator = itk::ImageRegionIterator<ImageType>;
-    using OutputImageIterator = itk::ImageRegionIterator<OutputImageType>;
-   
+    ImageType::SizeType size;
+    ImageType::RegionType region;
+    ImageType::IndexType start;
 
-    start[0] = 0;
-    start[1] = 0;
-    start[2] = 0; 
+    start.Fill(0);
     size[0] = max_x; 
     size[1] = max_y; 
     size[2] = max_z;
-
-    // spacing 
-    ImageType::SpacingType spacing_in;
-    spacing_in = input_im->GetSpacing();
-    spacing_out[0] = spacing_in[0]; 
-    spacing_out[1] = spacing_in[1];
-    spacing_out[2] = spacing_in[2];
-    
     region.SetSize(size);
     region.SetIndex(start);
 
-    in_region.SetSize(size); 
-    in_region.SetIndex(start);
-
-    OutputImageType::Pointer output_im = OutputImageType::New();
+    ImageType::Pointer output_im = ImageType::New();
     output_im->SetRegions(region);
-    output_im->SetSpacing(spacing_out);
+    output_im->SetSpacing(input_im->GetSpacing());
     output_im->Allocate();
-    
-    OutputImageIterator out_it(output_im,region);
-    InputImageIterator in_it(input_im,in_region);
-
-    // copy output to input
-    
-    for (in_it.GoToBegin(), out_it.GoToBegin(); ! in_it.IsAtEnd(); ++in_it, ++out_it )
-    {
-       out_it.Set(in_it.Get());
-    }
-
-    ImageType::SizeType radius;
-
-    switch (_interpolate_direction)
-    {
-        case XY: 
-            radius[0] = 1;
-            radius[1] = 1;
-            radius[2] = 0;
-            all_neighbours = 9;
-            break; 
-        case YZ: 
-            radius[0] = 0;
-            radius[1] = 1;
-            radius[2] = 1;
-            all_neighbours = 9;
-            break; 
-        case XZ:
-            radius[0] = 1;
-            radius[1] = 0;
-            radius[2] = 1;
-            all_neighbours = 9;
-            break; 
-        default: 
-            radius[0] = 1;
-            radius[1] = 1;
-            radius[2] = 1;
-            all_neighbours = 27;
+    std::memcpy(output_im->GetBufferPointer(), input_im->GetBufferPointer(), region.GetNumberOfPixels() * sizeof(float));
+
+    switch (_fill_method)
+    {
+        case FILL_FAST_MARCHING:
+            FillFastMarching(output_im);
+            break;
+        case FILL_LAPLACE:
+            FillMultigrid(output_im, 1);
+            break;
+        case FILL_BIHARMONIC:
+            FillMultigrid(output_im, 2);
+            break;
+        default:
+            FillMean(output_im);
             break;
     }
-    
-    input_im = _input_img->GetImage();
-    itk::NeighborhoodIterator<ImageType> neighbour_it(radius, input_im,in_region);
-        
-    for (int iter=0;iter<_iter;iter++) {
-        
-        out_it.GoToBegin();
-        while(!neighbour_it.IsAtEnd())
-        {
-            
-            if (neighbour_it.GetCenterPixel() == 0)     // only deal with holes in the image
-            {
-                int neighbours = 0;
-                float accum = 0;
 
-                // all center pixel's neighbours 
-                for (unsigned int i = 0; i < all_neighbours; i++)
-                {
-                    ImageType::IndexType index = neighbour_it.GetIndex(i);
-                    //std::cout << index[0] << " " << index[1] << std::endl;
-                
-                    bool IsInBounds;
-                    float neighbour = neighbour_it.GetPixel(i, IsInBounds);
-                    if(IsInBounds)
+    typedef  itk::ImageFileWriter< ImageType  > WriterType;
+    WriterType::Pointer writer = WriterType::New();
+    writer->SetFileName(_output_fn);
+    writer->SetInput(output_im);
+    writer->Update();
+}
+
+/*
+*   Holes take the mean of their positive neighbours when there are more than _min_neighbours
+*   of them, for _iter Jacobi iterations: every iteration reads the state of the previous one.
+*
+*   The state lives in two buffers used in turn, so nothing is copied back. Only the holes of
+*   the active front are visited: at first the holes with a positive neighbour, then the holes
+*   next to a voxel filled in the previous iteration - no other hole can have a different
+*   neighbourhood. The fills of an iteration are replayed into the other buffer at the start of
+*   the next one. Z-slabs of the first scan, and chunks of the front (kept in memory order), run
+*   in parallel.
+*/
+void LaImageHoleFilling::FillMean(ImageType::Pointer& image)
+{
+    const ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    const std::int64_t nx = size[0], ny = size[1], nz = size[2];
+    const std::int64_t num_voxels = nx * ny * nz;
+
+    // ping-pong buffers, both starting as the image
+    ImageType::Pointer buffers[2];
+    buffers[0] = image;
+    buffers[1] = ImageType::New();
+    buffers[1]->CopyInformation(image);
+    buffers[1]->SetRegions(image->GetBufferedRegion());
+    buffers[1]->Allocate();
+    std::memcpy(buffers[1]->GetBufferPointer(), image->GetBufferPointer(), static_cast<size_t>(num_voxels) * sizeof(float));
+
+    const Neighbourhood neighbourhood = MakeNeighbourhood(_interpolate_direction, nx, ny);
+    const int all_neighbours = static_cast<int>(neighbourhood.offset.size());
+
+    auto in_bounds = [&](std::int64_t x, std::int64_t y, std::int64_t z, int i) {
+        const std::int64_t qx = x + neighbourhood.dx[i], qy = y + neighbourhood.dy[i], qz = z + neighbourhood.dz[i];
+        return qx >= 0 && qx < nx && qy >= 0 && qy < ny && qz >= 0 && qz < nz;
+    };
+
+    // ---- Initial front: holes with a positive neighbour, z-slabs in parallel
+    std::vector<std::int64_t> front;
+    {
+        const float* state = buffers[0]->GetBufferPointer();
+        std::vector<std::vector<std::int64_t>> slab_fronts(static_cast<size_t>(nz));
+
+        vtkSMPTools::For(0, nz, [&](vtkIdType z_begin, vtkIdType z_end) {
+            for (std::int64_t z = z_begin; z < z_end; z++)
+                for (std::int64_t y = 0; y < ny; y++)
+                    for (std::int64_t x = 0; x < nx; x++)
+                    {
+                        const std::int64_t offset = x + nx * (y + ny * z);
+                        if (state[offset] != 0) continue;
+
+                        for (int i = 0; i < all_neighbours; i++)
                         {
-                            if (neighbour > 0)
+                            if (in_bounds(x, y, z, i) && state[offset + neighbourhood.offset[i]] > 0)
                             {
-                                accum += neighbour;
-                                neighbours++;
+                                slab_fronts[z].push_back(offset);
+                                break;
                             }
                         }
-                    
+                    }
+        });
 
+        for (std::int64_t z = 0; z < nz; z++)
+            front.insert(front.end(), slab_fronts[z].begin(), slab_fronts[z].end());
+    }
+
+    std::vector<std::int64_t> filled, previous_filled;
+    std::vector<float> filled_values, previous_values;
+    std::vector<float> front_values;
+    std::vector<unsigned char> in_next_front(static_cast<size_t>(num_voxels), 0);
+
+    int latest = 0;
+    for (int iter = 0; iter < _iter && !front.empty(); iter++)
+    {
+        const float* src = buffers[iter % 2]->GetBufferPointer();
+        float* dst = buffers[(iter + 1) % 2]->GetBufferPointer();
+
+        // dst is one iteration behind src: replay the last fills
+        vtkSMPTools::For(0, static_cast<vtkIdType>(previous_filled.size()), [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType k = begin; k < end; k++)
+                dst[previous_filled[k]] = previous_values[k];
+        });
+
+        // mean of the positive neighbours of every hole in the front, NaN when too few
+        front_values.resize(front.size());
+        vtkSMPTools::For(0, static_cast<vtkIdType>(front.size()), [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType k = begin; k < end; k++)
+            {
+                const std::int64_t offset = front[k];
+                const std::int64_t x = offset % nx, y = (offset / nx) % ny, z = offset / (nx * ny);
+
+                int neighbours = 0;
+                float accum = 0;
+                for (int i = 0; i < all_neighbours; i++)
+                {
+                    if (!in_bounds(x, y, z, i)) continue;
+
+                    const float neighbour = src[offset + neighbourhood.offset[i]];
+                    if (neighbour > 0)
+                    {
+                        accum += neighbour;
+                        neighbours++;
+                    }
                 }
-                if (neighbours > _min_neighbours)
-                    out_it.Set(accum/neighbours);
+                front_values[k] = (neighbours > 0 && neighbours > _min_neighbours) ? accum / neighbours : std::numeric_limits<float>::quiet_NaN();
             }
-            ++neighbour_it;
-            ++out_it;
+        });
+
+        filled.clear();
+        filled_values.clear();
+        for (size_t k = 0; k < front.size(); k++)
+        {
+            if (std::isnan(front_values[k])) continue;
+            dst[front[k]] = front_values[k];
+            filled.push_back(front[k]);
+            filled_values.push_back(front_values[k]);
         }
+        latest = (iter + 1) % 2;
 
-        // copy output to input 
-        for (in_it.GoToBegin(), out_it.GoToBegin(); ! in_it.IsAtEnd(); ++in_it, ++out_it )
+        // next front: holes left next to what was just filled
+        front.clear();
+        for (size_t k = 0; k < filled.size(); k++)
         {
-            in_it.Set(out_it.Get());
+            const std::int64_t offset = filled[k];
+            const std::int64_t x = offset % nx, y = (offset / nx) % ny, z = offset / (nx * ny);
+            for (int i = 0; i < all_neighbours; i++)
+            {
+                if (!in_bounds(x, y, z, i)) continue;
+
+                const std::int64_t q = offset + neighbourhood.offset[i];
+                if (dst[q] == 0 && !in_next_front[q])
+                {
+                    in_next_front[q] = 1;
+                    front.push_back(q);
+                }
+            }
         }
-        neighbour_it.GoToBegin();
+        for (size_t k = 0; k < front.size(); k++)
+            in_next_front[front[k]] = 0;
+        std::sort(front.begin(), front.end());
+
+        std::swap(filled, previous_filled);
+        std::swap(filled_values, previous_values);
     }
-    
 
-    typedef  itk::ImageFileWriter< OutputImageType  > WriterType;
-    WriterType::Pointer writer = WriterType::New();
-    writer->SetFileName(_output_fn);
-    writer->SetInput(output_im);
-    writer->Update();
+    image = buffers[latest];
+}
+
+/*
+*   Fast-marching inpainting (Telea, 2004), in one pass: holes are reached in order of their
+*   distance to the known voxels, and each takes the weighted mean of the known voxels within
+*   _inpaint_radius, weighted by direction (along the marching front normal), distance and
+*   arrival time. Unlike Telea, the known values are not extrapolated along their gradient.
+*   Only enclosed holes are filled (see EnclosedHoles). The march itself is sequential; the
+*   setup runs over z-slabs in parallel.
+*/
+void LaImageHoleFilling::FillFastMarching(ImageType::Pointer& image)
+{
+    const ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    const std::int64_t n[3] = { static_cast<std::int64_t>(size[0]), static_cast<std::int64_t>(size[1]), static_cast<std::int64_t>(size[2]) };
+    const std::int64_t stride[3] = { 1, n[0], n[0] * n[1] };
+    const std::int64_t num_voxels = n[0] * n[1] * n[2];
+    float* values = image->GetBufferPointer();
+
+    bool active[3];
+    ActiveAxes(_interpolate_direction, active);
+
+    // window of the weighted mean, a ball in the active axes
+    const int radius = std::max(_inpaint_radius, 1);
+    std::vector<int> window_d[3];
+    for (int dz = active[2] ? -radius : 0; dz <= (active[2] ? radius : 0); dz++)
+        for (int dy = active[1] ? -radius : 0; dy <= (active[1] ? radius : 0); dy++)
+            for (int dx = active[0] ? -radius : 0; dx <= (active[0] ? radius : 0); dx++)
+            {
+                const int d2 = dx * dx + dy * dy + dz * dz;
+                if (d2 == 0 || d2 > radius * radius) continue;
+                window_d[0].push_back(dx);
+                window_d[1].push_back(dy);
+                window_d[2].push_back(dz);
+            }
+
+    std::vector<unsigned char> state = EnclosedHoles(values, n, active);
+    std::vector<float> arrival(static_cast<size_t>(num_voxels));
+    std::vector<std::vector<std::int64_t>> slab_boundaries(static_cast<size_t>(n[2]));
+
+    vtkSMPTools::For(0, n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t p = z_begin * stride[2]; p < z_end * stride[2]; p++)
+        {
+            state[p] = (values[p] > 0) ? kKnown : state[p] ? kInside : kIgnored;
+            arrival[p] = (state[p] == kKnown) ? 0.0f : std::numeric_limits<float>::infinity();
+        }
+    });
+
+    // known voxels next to a hole start the march
+    vtkSMPTools::For(0, n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < n[1]; y++)
+                for (std::int64_t x = 0; x < n[0]; x++)
+                {
+                    const std::int64_t p = x + stride[1] * y + stride[2] * z;
+                    if (state[p] != kKnown) continue;
+
+                    const std::int64_t c[3] = { x, y, z };
+                    for (int a = 0; a < 3; a++)
+                    {
+                        if (!active[a]) continue;
+                        if ((c[a] > 0 && state[p - stride[a]] == kInside) || (c[a] < n[a] - 1 && state[p + stride[a]] == kInside))
+                        {
+                            slab_boundaries[z].push_back(p);
+                            break;
+                        }
+                    }
+                }
+    });
+
+    typedef std::pair<float, std::int64_t> HeapEntry;
+    std::priority_queue<HeapEntry, std::vector<HeapEntry>, std::greater<HeapEntry> > heap;
+    std::int64_t num_filled = 0;
+
+    auto to_coordinates = [&](std::int64_t p, std::int64_t c[3]) {
+        c[0] = p % n[0];
+        c[1] = (p / n[0]) % n[1];
+        c[2] = p / stride[2];
+    };
+
+    auto arrival_gradient = [&](std::int64_t p, const std::int64_t c[3], double gradient[3]) {
+        for (int a = 0; a < 3; a++)
+        {
+            gradient[a] = 0;
+            if (!active[a]) continue;
+
+            const bool has_lo = c[a] > 0 && std::isfinite(arrival[p - stride[a]]);
+            const bool has_hi = c[a] < n[a] - 1 && std::isfinite(arrival[p + stride[a]]);
+            if (has_lo && has_hi)
+                gradient[a] = 0.5 * (arrival[p + stride[a]] - arrival[p - stride[a]]);
+            else if (has_hi)
+                gradient[a] = arrival[p + stride[a]] - arrival[p];
+            else if (has_lo)
+                gradient[a] = arrival[p] - arrival[p - stride[a]];
+        }
+    };
+
+    auto inpaint = [&](std::int64_t p, const std::int64_t c[3]) {
+        double gradient[3];
+        arrival_gradient(p, c, gradient);
+
+        double sum = 0, weights = 0;
+        for (size_t k = 0; k < window_d[0].size(); k++)
+        {
+            const std::int64_t r[3] = { c[0] + window_d[0][k], c[1] + window_d[1][k], c[2] + window_d[2][k] };
+            if (r[0] < 0 || r[0] >= n[0] || r[1] < 0 || r[1] >= n[1] || r[2] < 0 || r[2] >= n[2]) continue;
+
+            const std::int64_t q = r[0] + stride[1] * r[1] + stride[2] * r[2];
+            if (state[q] != kKnown) continue;
+
+            const double d2 = window_d[0][k] * window_d[0][k] + window_d[1][k] * window_d[1][k] + window_d[2][k] * window_d[2][k];
+            double direction = std::fabs(window_d[0][k] * gradient[0] + window_d[1][k] * gradient[1] + window_d[2][k] * gradient[2]) / std::sqrt(d2);
+            if (direction == 0)
+                direction = 1e-6;
+            const double level = 1.0 / (1.0 + std::fabs(arrival[q] - arrival[p]));
+            const double weight = direction * level / d2;
+
+            sum += weight * values[q];
+            weights += weight;
+        }
+        if (weights > 0)
+            values[p] = static_cast<float>(sum / weights);
+    };
+
+    // a neighbour q of a voxel that just became known
+    auto reach = [&](std::int64_t q) {
+        std::int64_t c[3];
+        to_coordinates(q, c);
+
+        const float t = SolveEikonal(arrival, state, q, c, n, stride, active);
+        if (state[q] == kInside)
+        {
+            arrival[q] = t;
+            inpaint(q, c);
+            state[q] = kBand;
+            num_filled++;
+            heap.push(HeapEntry(t, q));
+        }
+        else if (state[q] == kBand && t < arrival[q])
+        {
+            arrival[q] = t;
+            heap.push(HeapEntry(t, q));
+        }
+    };
+
+    auto reach_neighbours = [&](std::int64_t p) {
+        std::int64_t c[3];
+        to_coordinates(p, c);
+        for (int a = 0; a < 3; a++)
+        {
+            if (!active[a]) continue;
+            if (c[a] > 0 && state[p - stride[a]] <= kBand)
+                reach(p - stride[a]);
+            if (c[a] < n[a] - 1 && state[p + stride[a]] <= kBand)
+                reach(p + stride[a]);
+        }
+    };
+
+    for (std::int64_t z = 0; z < n[2]; z++)
+        for (size_t k = 0; k < slab_boundaries[z].size(); k++)
+            reach_neighbours(slab_boundaries[z][k]);
+
+    while (!heap.empty())
+    {
+        const HeapEntry entry = heap.top();
+        heap.pop();
+        if (state[entry.second] == kKnown || entry.first > arrival[entry.second]) continue;     // stale
+
+        state[entry.second] = kKnown;
+        reach_neighbours(entry.second);
+    }
+
+    std::cout << "Fast marching filled " << num_filled << " voxels" << std::endl;
 }
 
+/*
+*   Harmonic (order 1, L u = 0) or biharmonic (order 2, L L u = 0) fill of the enclosed holes
+*   (see EnclosedHoles), the known voxels as Dirichlet values, over the bounding box of the
+*   holes. Levels halve the active axes and the Laplacian is rediscretised on them; smoothing is
+*   damped Jacobi, z-slabs in parallel. The harmonic fill starts from nested iteration and runs
+*   V-cycles until the residual has dropped by 1e5 (at most 100).
+*
+*   The biharmonic fill is split into two coupled Laplace problems, L v = 0 and L u = v on the
+*   holes, each solved by 4 of the same V-cycles. They are coupled through v on the ring of
+*   known voxels next to the holes, where v = L u must hold: starting from the harmonic fill,
+*   BiCGSTAB solves for the ring values, each iteration costing two pairs of Laplace solves,
+*   until the ring mismatch has dropped by 1e4 (at most 30 iterations). The result solves
+*   L L u = 0 on the holes.
+*/
+void LaImageHoleFilling::FillMultigrid(ImageType::Pointer& image, int order)
+{
+    const ImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    const std::int64_t n[3] = { static_cast<std::int64_t>(size[0]), static_cast<std::int64_t>(size[1]), static_cast<std::int64_t>(size[2]) };
+    float* values = image->GetBufferPointer();
+
+    bool active[3];
+    ActiveAxes(_interpolate_direction, active);
+    const std::vector<unsigned char> enclosed = EnclosedHoles(values, n, active);
 
+    // bounding box of the holes, z-slabs in parallel
+    std::vector<std::int64_t> slab_lo(static_cast<size_t>(n[2] * 2), std::numeric_limits<std::int64_t>::max());
+    std::vector<std::int64_t> slab_hi(static_cast<size_t>(n[2] * 2), -1);
+    vtkSMPTools::For(0, n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < n[1]; y++)
+                for (std::int64_t x = 0; x < n[0]; x++)
+                {
+                    if (!enclosed[x + n[0] * (y + n[1] * z)]) continue;
+                    slab_lo[2 * z] = std::min(slab_lo[2 * z], x);
+                    slab_hi[2 * z] = std::max(slab_hi[2 * z], x);
+                    slab_lo[2 * z + 1] = std::min(slab_lo[2 * z + 1], y);
+                    slab_hi[2 * z + 1] = std::max(slab_hi[2 * z + 1], y);
+                }
+    });
+
+    std::int64_t lo[3] = { n[0], n[1], n[2] }, hi[3] = { -1, -1, -1 };
+    for (std::int64_t z = 0; z < n[2]; z++)
+    {
+        if (slab_hi[2 * z] < 0) continue;
+        lo[0] = std::min(lo[0], slab_lo[2 * z]);
+        hi[0] = std::max(hi[0], slab_hi[2 * z]);
+        lo[1] = std::min(lo[1], slab_lo[2 * z + 1]);
+        hi[1] = std::max(hi[1], slab_hi[2 * z + 1]);
+        lo[2] = std::min(lo[2], z);
+        hi[2] = z;
+    }
+    if (hi[2] < 0)
+    {
+        std::cout << "No enclosed holes to fill" << std::endl;
+        return;
+    }
+
+    // grown by the reach of the stencil so the holes see their known neighbours
+    const ImageType::SpacingType spacing = image->GetSpacing();
+    std::vector<GridLevel> levels(1);
+    levels.reserve(16);             // grid stays valid as the levels are added
+    GridLevel& grid = levels[0];
+    for (int a = 0; a < 3; a++)
+    {
+        if (active[a])
+        {
+            lo[a] = std::max<std::int64_t>(lo[a] - order, 0);
+            hi[a] = std::min<std::int64_t>(hi[a] + order, n[a] - 1);
+        }
+        grid.n[a] = hi[a] - lo[a] + 1;
+        grid.factor[a] = 1;
+        grid.w[a] = active[a] ? static_cast<float>(1.0 / (spacing[a] * spacing[a])) : 0.0f;
+    }
+
+    const std::int64_t count = grid.Count();
+    grid.type.resize(static_cast<size_t>(count));
+    grid.u.resize(static_cast<size_t>(count));
+    grid.f.assign(static_cast<size_t>(count), 0.0f);
+    grid.diag.assign(static_cast<size_t>(count), 0.0f);
+    grid.tmp.assign(static_cast<size_t>(count), 0.0f);
+    grid.au.assign(static_cast<size_t>(count), 0.0f);
+
+    double fixed_sum = 0;
+    std::int64_t num_fixed = 0, num_unknown = 0;
+    for (std::int64_t z = 0; z < grid.n[2]; z++)
+        for (std::int64_t y = 0; y < grid.n[1]; y++)
+            for (std::int64_t x = 0; x < grid.n[0]; x++)
+            {
+                const std::int64_t p = x + grid.n[0] * (y + grid.n[1] * z);
+                const std::int64_t q = (x + lo[0]) + n[0] * ((y + lo[1]) + n[1] * (z + lo[2]));
+                const float value = values[q];
+                grid.type[p] = (value > 0) ? kFixed : enclosed[q] ? kUnknown : kLeftOut;
+                grid.u[p] = value;
+                if (grid.type[p] == kFixed)
+                {
+                    fixed_sum += value;
+                    num_fixed++;
+                }
+                num_unknown += (grid.type[p] == kUnknown);
+            }
 
+    // start the holes at the mean of the known voxels
+    const float initial = (num_fixed > 0) ? static_cast<float>(fixed_sum / num_fixed) : 0.0f;
+    for (std::int64_t p = 0; p < count; p++)
+    {
+        if (grid.type[p] == kUnknown)
+            grid.u[p] = initial;
+    }
+
+    while (levels.size() < 16)
+    {
+        const GridLevel& finest = levels.back();
+        std::int64_t longest = 0;
+        for (int a = 0; a < 3; a++)
+        {
+            if (finest.w[a] > 0)
+                longest = std::max(longest, finest.n[a]);
+        }
+        if (longest <= 3) break;
+        levels.push_back(Coarsen(finest));
+    }
+    std::cout << "Multigrid: " << num_unknown << " holes, " << levels.size() << " levels" << std::endl;
+
+    // harmonic fill by nested iteration and V-cycles
+    for (size_t l = 0; l < levels.size(); l++)
+        ComputeDiagonal(levels[l]);
+
+    const double initial_residual = ResidualNorm(levels[0]);
+    NestedIteration(levels);
+    int cycles = SolveLaplace(levels, 1e-5 * initial_residual, 100);
+    std::cout << "Multigrid: " << cycles << " V-cycles, residual " << ResidualNorm(levels[0]) << " (from " << initial_residual << ")" << std::endl;
+
+    // biharmonic fill from there, as coupled Laplace problems for v = L u and u
+    if (order == 2)
+    {
+        // the known voxels next to a hole: v = L u there depends on the fill
+        std::vector<std::int64_t> ring;
+        const std::int64_t stride[3] = { 1, grid.n[0], grid.n[0] * grid.n[1] };
+        for (std::int64_t z = 0; z < grid.n[2]; z++)
+            for (std::int64_t y = 0; y < grid.n[1]; y++)
+                for (std::int64_t x = 0; x < grid.n[0]; x++)
+                {
+                    const std::int64_t p = x + stride[1] * y + stride[2] * z;
+                    if (grid.type[p] != kFixed) continue;
+
+                    const std::int64_t c[3] = { x, y, z };
+                    for (int a = 0; a < 3; a++)
+                    {
+                        if (grid.w[a] == 0) continue;
+                        if ((c[a] > 0 && grid.type[p - stride[a]] == kUnknown) || (c[a] < grid.n[a] - 1 && grid.type[p + stride[a]] == kUnknown))
+                        {
+                            ring.push_back(p);
+                            break;
+                        }
+                    }
+                }
+
+        const std::vector<float> harmonic = grid.u;
+        const double initial_biharmonic = ResidualNorm(grid, true);
+        std::vector<float> v(static_cast<size_t>(count)), lap(static_cast<size_t>(count));
+        cycles = 0;
+
+        // grid.u = the change of u for v = x on the ring: v harmonic on the holes, then L u = v
+        // on the holes with u = 0 on the known voxels. Each Laplace solve is a fixed number of
+        // V-cycles from 0, so the map from x is linear, as BiCGSTAB needs, and no solve chases
+        // a residual below float precision.
+        const int inner_cycles = 4;
+        auto solve_pair = [&](const std::vector<double>& x) {
+            std::fill(grid.u.begin(), grid.u.end(), 0.0f);
+            for (size_t k = 0; k < ring.size(); k++)
+                grid.u[ring[k]] = static_cast<float>(x[k]);
+            cycles += SolveLaplace(levels, 0.0, inner_cycles);
+            v.swap(grid.u);
+
+            std::fill(grid.u.begin(), grid.u.end(), 0.0f);
+            for (std::int64_t p = 0; p < count; p++)
+                grid.f[p] = (grid.type[p] == kUnknown) ? v[p] : 0.0f;
+            cycles += SolveLaplace(levels, 0.0, inner_cycles);
+            std::fill(grid.f.begin(), grid.f.end(), 0.0f);
+        };
+
+        // x - L u on the ring: 0 where v and u agree
+        auto apply = [&](const std::vector<double>& x, std::vector<double>& out) {
+            solve_pair(x);
+            ApplyLaplacian(grid, grid.u.data(), lap.data());
+            for (size_t k = 0; k < ring.size(); k++)
+                out[k] = x[k] - lap[ring[k]];
+        };
+
+        auto dot = [](const std::vector<double>& a, const std::vector<double>& b) {
+            double sum = 0;
+            for (size_t k = 0; k < a.size(); k++)
+                sum += a[k] * b[k];
+            return sum;
+        };
+
+        // v on the ring by BiCGSTAB, starting from 0, i.e. from the harmonic fill
+        const size_t m = ring.size();
+        std::vector<double> x(m, 0.0), r(m), r0(m), p(m, 0.0), q(m, 0.0), s(m), t(m);
+        ApplyLaplacian(grid, harmonic.data(), lap.data());
+        for (size_t k = 0; k < m; k++)
+            r[k] = lap[ring[k]];
+        r0 = r;
+
+        const double target = 1e-4 * std::sqrt(dot(r, r));
+        double rho = 1, alpha = 1, omega = 1;
+        int iteration = 0;
+        while (iteration < 30 && std::sqrt(dot(r, r)) > target)
+        {
+            const double rho_next = dot(r0, r);
+            if (rho_next == 0) break;
+            const double beta = (rho_next / rho) * (alpha / omega);
+            rho = rho_next;
+            for (size_t k = 0; k < m; k++)
+                p[k] = r[k] + beta * (p[k] - omega * q[k]);
+
+            apply(p, q);
+            alpha = rho / dot(r0, q);
+            for (size_t k = 0; k < m; k++)
+                s[k] = r[k] - alpha * q[k];
+
+            apply(s, t);
+            const double tt = dot(t, t);
+            omega = (tt > 0) ? dot(t, s) / tt : 0;
+            for (size_t k = 0; k < m; k++)
+            {
+                x[k] += alpha * p[k] + omega * s[k];
+                r[k] = s[k] - omega * t[k];
+            }
+            iteration++;
+            if (omega == 0) break;
+        }
+
+        solve_pair(x);
+        for (std::int64_t p = 0; p < count; p++)
+            grid.u[p] += harmonic[p];
+        std::cout << "Multigrid: " << iteration << " biharmonic iterations, " << cycles << " V-cycles, residual "
+                  << ResidualNorm(grid, true) << " (from " << initial_biharmonic << ")" << std::endl;
+    }
+
+    const GridLevel& solved = levels[0];
+    vtkSMPTools::For(0, solved.n[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+        for (std::int64_t z = z_begin; z < z_end; z++)
+            for (std::int64_t y = 0; y < solved.n[1]; y++)
+                for (std::int64_t x = 0; x < solved.n[0]; x++)
+                {
+                    const std::int64_t p = x + solved.n[0] * (y + solved.n[1] * z);
+                    if (solved.type[p] == kUnknown)
+                        values[(x + lo[0]) + n[0] * ((y + lo[1]) + n[1] * (z + lo[2]))] = solved.u[p];
+                }
+    });
+}
@@ -2,6 +2,10 @@
 
 #include <iostream>    // using IO functions
 #include <string>      // using string
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <vtkSMPTools.h>
 #include "../include/LaImageInPaintMask.h"
 
 ;
@@ -9,6 +13,9 @@
 
 LaImageInPaintMask::LaImageInPaintMask()
 {
+   _crop_x = 0;
+   _crop_y = 0;
+   _crop_z = 0;
    _crop_l = -1; 
 	_crop_w = -1; 
 	_crop_h = -1;
@@ -46,14 +53,16 @@ void LaImageInPaintMask::SetCropSize(int l, int w, int h) {
 	_crop_h = h;
 }
 
+/*
+*   The part of the crop window that lies inside both the greyscale image and the mask is worked
+*   out once, then copied a row at a time (z-slabs in parallel). The output has the geometry of
+*   the greyscale image and is zero outside the window.
+*/
 void LaImageInPaintMask::Update()
 {
 	int max_x, max_y, max_z, max_x2, max_y2, max_z2; 
 	typedef itk::Image< unsigned short, 3 >  ImageType;
     typedef itk::Image<unsigned short, 3 >  OutputImageType;
-	
-	ImageType::IndexType pixelIndex;
-    ImageType::IndexType pixelIndex2;
 
     _input_greyscale->GetImageSize(max_x, max_y, max_z);
 	_input_binary->GetImageSize(max_x2, max_y2, max_z2);
@@ -61,31 +70,24 @@ void LaImageInPaintMask::Update()
     ImageType::Pointer greyscale_pn = _input_greyscale->GetImage();
     ImageType::Pointer mask_pn = _input_binary->GetImage();
 
-    OutputImageType::SpacingType spacing_out;
     OutputImageType::SizeType size;
     OutputImageType::RegionType region;
     OutputImageType::IndexType start;
 
-    start[0] = 0;
-    start[1] = 0;
-    start[2] = 0; 
+    start.Fill(0);
     size[0] = max_x; 
     size[1] = max_y; 
     size[2] = max_z;
-
-    // spacing 
-    ImageType::SpacingType spacing_in;
-    spacing_in = greyscale_pn->GetSpacing();
-    spacing_out[0] = spacing_in[0]; 
-    spacing_out[1] = spacing_in[1];
-    spacing_out[2] = spacing_in[2];
-    
     region.SetSize(size);
     region.SetIndex(start);
+
     OutputImageType::Pointer output_im = OutputImageType::New();
     output_im->SetRegions(region);
-    output_im->SetSpacing(spacing_out);
+    output_im->SetSpacing(greyscale_pn->GetSpacing());
+    output_im->SetOrigin(greyscale_pn->GetOrigin());
+    output_im->SetDirection(greyscale_pn->GetDirection());
     output_im->Allocate();
+    output_im->FillBuffer(0);
     
     if (_crop_l < 0)
     {
@@ -94,38 +96,37 @@ void LaImageInPaintMask::Update()
         _crop_h = max_z2;
     }
 
-    itk::ImageRegionIterator<OutputImageType> imageIterator(output_im,region);
- 
-    while(!imageIterator.IsAtEnd())
+    // overlap [lo, hi) in output coordinates: inside the crop window, the output and the mask
+    const int crop_start[3] = { _crop_x, _crop_y, _crop_z };
+    const int crop_size[3] = { _crop_l, _crop_w, _crop_h };
+    const int output_size[3] = { max_x, max_y, max_z };
+    const int mask_size[3] = { max_x2, max_y2, max_z2 };
+    int lo[3], hi[3];
+    for (int a = 0; a < 3; a++)
     {
-        imageIterator.Set(0);
-        ++imageIterator;
+        lo[a] = std::max(crop_start[a], 0);
+        hi[a] = std::min(std::min(crop_start[a] + crop_size[a], output_size[a]), crop_start[a] + mask_size[a]);
     }
-
-
-    int start_x = _crop_x;
-    int start_y = _crop_y;
-    int start_z = _crop_z;
-
-    for (int i=start_x;i<start_x+_crop_l;i++)
+    if (lo[0] >= hi[0] || lo[1] >= hi[1] || lo[2] >= hi[2])
+        std::cerr << "LaImageInPaintMask::Update - the crop window does not overlap the image" << std::endl;
+    else
     {
-        for (int j=start_y;j<start_y+_crop_w;j++)
-        {
-            for (int k=start_z;k<start_z+_crop_h;k++)
-            {
-                pixelIndex[0] = i; 
-                pixelIndex[1] = j; 
-                pixelIndex[2] = k; 
-
-                pixelIndex2[0] = i-start_x; 
-                pixelIndex2[1] = j-start_y; 
-                pixelIndex2[2] = k-start_z; 
+        const unsigned short* mask_buffer = mask_pn->GetBufferPointer();
+        unsigned short* output_buffer = output_im->GetBufferPointer();
+        const size_t row_bytes = static_cast<size_t>(hi[0] - lo[0]) * sizeof(unsigned short);
 
-                if (pixelIndex[0] < max_x && pixelIndex[1] < max_y && pixelIndex[2] < max_z && pixelIndex2[0] < max_x2 
-                && pixelIndex2[1] < max_y2 && pixelIndex2[2] < max_z2)
-                    output_im->SetPixel(pixelIndex, mask_pn->GetPixel(pixelIndex2));
+        vtkSMPTools::For(lo[2], hi[2], [&](vtkIdType z_begin, vtkIdType z_end) {
+            for (std::int64_t k = z_begin; k < z_end; k++)
+            {
+                for (std::int64_t j = lo[1]; j < hi[1]; j++)
+                {
+                    const std::int64_t out_offset = lo[0] + static_cast<std::int64_t>(max_x) * (j + static_cast<std::int64_t>(max_y) * k);
+                    const std::int64_t mask_offset = (lo[0] - crop_start[0]) + static_cast<std::int64_t>(max_x2) *
+                        ((j - crop_start[1]) + static_cast<std::int64_t>(max_y2) * (k - crop_start[2]));
+                    std::memcpy(output_buffer + out_offset, mask_buffer + mask_offset, row_bytes);
+                }
             }
-        }
+        });
     }
 	
 	typedef  itk::ImageFileWriter< OutputImageType  > WriterType;
@@ -135,6 +136,3 @@ void LaImageInPaintMask::Update()
     writer->Update();
 
 }
-
-
-
@@ -0,0 +1,491 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <bitset>
+#include <cctype>
+#include <cstring>
+
+#include <vtkSMPTools.h>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LA_MASK_SSE2 1
+#endif
+
+#include "../include/LaMaskAlgebra.h"
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+typedef LaBitMask::MaskImageType MaskImageType;
+
+// words evaluated together: 4 KB per operand
+const int kBlockWords = 512;
+
+/*
+ * Word of count (<= 64) voxels: bit j set where v[j] > 0, or == label
+ * when label >= 0.
+ */
+inline std::uint64_t PackWord(const unsigned short* v, int count, int label) {
+    std::uint64_t word = 0;
+    int j = 0;
+
+#ifdef LA_MASK_SSE2
+    // 16 voxels per compare: equal-to-key lanes become 0xFF bytes
+    const __m128i key = _mm_set1_epi16(static_cast<short>(label < 0 ? 0 : label));
+    const std::uint64_t flip = label < 0 ? 0xFFFF : 0;
+    for (; j + 16 <= count; j += 16) {
+        const __m128i lo = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + j)), key);
+        const __m128i hi = _mm_cmpeq_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v + j + 8)), key);
+        const std::uint64_t bits = static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_packs_epi16(lo, hi))) ^ flip;
+        word |= bits << j;
+    }
+#endif
+
+    if (label < 0) {
+        for (; j < count; ++j)
+            word |= static_cast<std::uint64_t>(v[j] > 0) << j;
+    }
+    else {
+        for (; j < count; ++j)
+            word |= static_cast<std::uint64_t>(v[j] == label) << j;
+    }
+    return word;
+}
+
+// ------------------------------------------------------------
+// Expression
+// ------------------------------------------------------------
+
+struct Term {
+    int input;
+    int label;      // -1: greater than 0
+};
+
+struct Op {
+    enum Code { PUSH, NOT, AND, AND_NOT, XOR, OR };
+    Code code;
+    int  term;      // PUSH only
+};
+
+/*
+ * Recursive descent from the expression to a postfix program:
+ *
+ *   or      := xor ('|' xor)*
+ *   xor     := and ('^' and)*
+ *   and     := unary (('&' | '-') unary)*
+ *   unary   := ('~' | '!') unary | primary
+ *   primary := letter ['=' label] | '(' or ')'
+ */
+class Parser {
+
+public:
+
+    Parser(const std::string& text, int inputs)
+        : _text(text), _pos(0), _inputs(inputs), _depth(0), _max_depth(0) {}
+
+    bool Parse(std::vector<Op>& program, std::vector<Term>& terms, int& max_depth, std::string& error) {
+        bool ok = ParseOr();
+        if (ok) {
+            Skip();
+            if (_pos < _text.size())
+                ok = Fail("unexpected '" + std::string(1, _text[_pos]) + "'");
+        }
+        if (!ok) {
+            error = _error;
+            return false;
+        }
+        program   = _program;
+        terms     = _terms;
+        max_depth = _max_depth;
+        return true;
+    }
+
+private:
+
+    void Skip() {
+        while (_pos < _text.size() && std::isspace(static_cast<unsigned char>(_text[_pos]))) ++_pos;
+    }
+
+    bool Accept(char c) {
+        Skip();
+        if (_pos < _text.size() && _text[_pos] == c) {
+            ++_pos;
+            return true;
+        }
+        return false;
+    }
+
+    bool Fail(const std::string& message) {
+        if (_error.empty()) {
+            std::ostringstream error;
+            error << message << " at position " << _pos + 1;
+            _error = error.str();
+        }
+        return false;
+    }
+
+    void Emit(Op::Code code, int term = -1) {
+        Op op;
+        op.code = code;
+        op.term = term;
+        _program.push_back(op);
+
+        if (code == Op::PUSH) _max_depth = std::max(_max_depth, ++_depth);
+        else if (code != Op::NOT) --_depth;
+    }
+
+    bool ParseOr() {
+        if (!ParseXor()) return false;
+        while (Accept('|')) {
+            if (!ParseXor()) return false;
+            Emit(Op::OR);
+        }
+        return true;
+    }
+
+    bool ParseXor() {
+        if (!ParseAnd()) return false;
+        while (Accept('^')) {
+            if (!ParseAnd()) return false;
+            Emit(Op::XOR);
+        }
+        return true;
+    }
+
+    bool ParseAnd() {
+        if (!ParseUnary()) return false;
+        for (;;) {
+            if (Accept('&')) {
+                if (!ParseUnary()) return false;
+                Emit(Op::AND);
+            }
+            else if (Accept('-')) {
+                if (!ParseUnary()) return false;
+                Emit(Op::AND_NOT);
+            }
+            else {
+                return true;
+            }
+        }
+    }
+
+    bool ParseUnary() {
+        if (Accept('~') || Accept('!')) {
+            if (!ParseUnary()) return false;
+            Emit(Op::NOT);
+            return true;
+        }
+        return ParsePrimary();
+    }
+
+    bool ParsePrimary() {
+        if (Accept('(')) {
+            if (!ParseOr()) return false;
+            return Accept(')') || Fail("expected ')'");
+        }
+
+        Skip();
+        if (_pos == _text.size() || !std::isalpha(static_cast<unsigned char>(_text[_pos])))
+            return Fail("expected a mask name");
+
+        Term term;
+        term.input = std::toupper(static_cast<unsigned char>(_text[_pos])) - 'A';
+        term.label = -1;
+        if (term.input >= _inputs)
+            return Fail("mask " + std::string(1, static_cast<char>('A' + term.input)) + " was not given");
+        ++_pos;
+
+        if (Accept('=')) {
+            Skip();
+            const size_t start = _pos;
+            long label = 0;
+            while (_pos < _text.size() && std::isdigit(static_cast<unsigned char>(_text[_pos])) && label <= 65535)
+                label = 10 * label + (_text[_pos++] - '0');
+            if (_pos == start) return Fail("expected a label");
+            if (label > 65535) return Fail("label out of range");
+            term.label = static_cast<int>(label);
+        }
+
+        int index = 0;
+        while (index < static_cast<int>(_terms.size()) &&
+               !(_terms[index].input == term.input && _terms[index].label == term.label))
+            ++index;
+        if (index == static_cast<int>(_terms.size())) _terms.push_back(term);
+
+        Emit(Op::PUSH, index);
+        return true;
+    }
+
+    const std::string& _text;
+    size_t             _pos;
+    int                _inputs;
+    int                _depth;
+    int                _max_depth;
+    std::string        _error;
+    std::vector<Op>    _program;
+    std::vector<Term>  _terms;
+};
+
+// ------------------------------------------------------------
+// Word kernels, plain loops the compiler vectorises
+// ------------------------------------------------------------
+
+inline void KernelNot(std::uint64_t* out, const std::uint64_t* a, int n) {
+    for (int i = 0; i < n; ++i) out[i] = ~a[i];
+}
+
+inline void KernelAnd(std::uint64_t* out, const std::uint64_t* a, const std::uint64_t* b, int n) {
+    for (int i = 0; i < n; ++i) out[i] = a[i] & b[i];
+}
+
+inline void KernelAndNot(std::uint64_t* out, const std::uint64_t* a, const std::uint64_t* b, int n) {
+    for (int i = 0; i < n; ++i) out[i] = a[i] & ~b[i];
+}
+
+inline void KernelXor(std::uint64_t* out, const std::uint64_t* a, const std::uint64_t* b, int n) {
+    for (int i = 0; i < n; ++i) out[i] = a[i] ^ b[i];
+}
+
+inline void KernelOr(std::uint64_t* out, const std::uint64_t* a, const std::uint64_t* b, int n) {
+    for (int i = 0; i < n; ++i) out[i] = a[i] | b[i];
+}
+
+}  // namespace
+
+
+// ============================================================
+// LaBitMask
+// ============================================================
+
+LaBitMask::LaBitMask()
+    : _voxels(0) {
+    _size[0] = _size[1] = _size[2] = 0;
+}
+
+void LaBitMask::Resize(int nx, int ny, int nz) {
+    _size[0] = nx;
+    _size[1] = ny;
+    _size[2] = nz;
+    _voxels  = static_cast<std::int64_t>(nx) * ny * nz;
+    _words.assign(static_cast<size_t>((_voxels + 63) / 64), 0);
+}
+
+void LaBitMask::Pack(const MaskImageType* image, int label) {
+    const MaskImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    Resize(static_cast<int>(size[0]), static_cast<int>(size[1]), static_cast<int>(size[2]));
+
+    const unsigned short* buffer = image->GetBufferPointer();
+    std::uint64_t* words = _words.data();
+    const std::int64_t voxels = _voxels;
+
+    vtkSMPTools::For(0, GetNumberOfWords(), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType w = begin; w < end; ++w) {
+            const std::int64_t first = 64 * static_cast<std::int64_t>(w);
+            const int count = static_cast<int>(std::min<std::int64_t>(64, voxels - first));
+            words[w] = PackWord(buffer + first, count, label);
+        }
+    });
+}
+
+void LaBitMask::Unpack(MaskImageType* image, unsigned short value, const MaskImageType* labels) const {
+    const MaskImageType::SizeType size = image->GetBufferedRegion().GetSize();
+    if (static_cast<std::int64_t>(size[0] * size[1] * size[2]) != _voxels) {
+        std::cerr << "LaBitMask::Unpack — image and mask sizes differ" << std::endl;
+        return;
+    }
+    if (labels && labels->GetBufferedRegion().GetSize() != size) {
+        std::cerr << "LaBitMask::Unpack — label image and mask sizes differ" << std::endl;
+        return;
+    }
+
+    unsigned short* buffer = image->GetBufferPointer();
+    const unsigned short* label_buffer = labels ? labels->GetBufferPointer() : nullptr;
+    const std::uint64_t* words = _words.data();
+    const std::int64_t voxels = _voxels;
+
+    vtkSMPTools::For(0, GetNumberOfWords(), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType w = begin; w < end; ++w) {
+            const std::int64_t first = 64 * static_cast<std::int64_t>(w);
+            const int count = static_cast<int>(std::min<std::int64_t>(64, voxels - first));
+            const std::uint64_t bits = words[w];
+            unsigned short* out = buffer + first;
+
+            // all-ones or all-zeros masks instead of a branch per voxel
+            if (label_buffer) {
+                const unsigned short* in = label_buffer + first;
+                for (int j = 0; j < count; ++j)
+                    out[j] = in[j] & static_cast<unsigned short>(0u - ((bits >> j) & 1u));
+            }
+            else {
+                for (int j = 0; j < count; ++j)
+                    out[j] = value & static_cast<unsigned short>(0u - ((bits >> j) & 1u));
+            }
+        }
+    });
+}
+
+bool LaBitMask::Get(int x, int y, int z) const {
+    const std::int64_t i = x + static_cast<std::int64_t>(_size[0]) * (y + static_cast<std::int64_t>(_size[1]) * z);
+    return (_words[i >> 6] >> (i & 63)) & 1u;
+}
+
+void LaBitMask::Set(int x, int y, int z, bool on) {
+    const std::int64_t i = x + static_cast<std::int64_t>(_size[0]) * (y + static_cast<std::int64_t>(_size[1]) * z);
+    const std::uint64_t bit = std::uint64_t(1) << (i & 63);
+    if (on) _words[i >> 6] |= bit;
+    else    _words[i >> 6] &= ~bit;
+}
+
+std::int64_t LaBitMask::Count() const {
+    std::int64_t count = 0;
+    for (std::uint64_t word : _words)
+        count += static_cast<std::int64_t>(std::bitset<64>(word).count());
+    return count;
+}
+
+void LaBitMask::GetSize(int& nx, int& ny, int& nz) const {
+    nx = _size[0];
+    ny = _size[1];
+    nz = _size[2];
+}
+
+void LaBitMask::ClearTail() {
+    const int used = static_cast<int>(_voxels & 63);
+    if (used && !_words.empty())
+        _words.back() &= (std::uint64_t(1) << used) - 1;
+}
+
+
+// ============================================================
+// LaMaskAlgebra
+// ============================================================
+
+LaMaskAlgebra::LaMaskAlgebra()
+    : _output_value(1), _label_source(-1) {
+}
+
+int LaMaskAlgebra::AddInput(const MaskImageType* mask) {
+    _inputs.push_back(mask);
+    return static_cast<int>(_inputs.size()) - 1;
+}
+
+void LaMaskAlgebra::SetExpression(const std::string& expression) {
+    _expression = expression;
+}
+
+void LaMaskAlgebra::SetOutputValue(unsigned short value) {
+    _output_value = value;
+}
+
+void LaMaskAlgebra::SetLabelSource(int index) {
+    _label_source = index;
+}
+
+bool LaMaskAlgebra::Update() {
+    if (_inputs.empty()) {
+        std::cerr << "LaMaskAlgebra::Update — no input masks" << std::endl;
+        return false;
+    }
+    if (_inputs.size() > 26) {
+        std::cerr << "LaMaskAlgebra::Update — at most 26 masks (A to Z)" << std::endl;
+        return false;
+    }
+
+    const MaskImageType::SizeType size = _inputs[0]->GetBufferedRegion().GetSize();
+    for (size_t i = 1; i < _inputs.size(); ++i) {
+        if (_inputs[i]->GetBufferedRegion().GetSize() != size) {
+            std::cerr << "LaMaskAlgebra::Update — mask " << static_cast<char>('A' + i)
+                      << " and mask A sizes differ" << std::endl;
+            return false;
+        }
+    }
+    if (_label_source >= static_cast<int>(_inputs.size())) {
+        std::cerr << "LaMaskAlgebra::Update — no mask " << static_cast<char>('A' + _label_source)
+                  << " to take labels from" << std::endl;
+        return false;
+    }
+
+    std::vector<Op> program;
+    std::vector<Term> terms;
+    int depth = 0;
+    std::string error;
+    Parser parser(_expression, static_cast<int>(_inputs.size()));
+    if (!parser.Parse(program, terms, depth, error)) {
+        std::cerr << "LaMaskAlgebra::Update — cannot parse \"" << _expression << "\": " << error << std::endl;
+        return false;
+    }
+
+    std::vector<LaBitMask> packed(terms.size());
+    for (size_t t = 0; t < terms.size(); ++t)
+        packed[t].Pack(_inputs[terms[t].input], terms[t].label);
+
+    _result.Resize(static_cast<int>(size[0]), static_cast<int>(size[1]), static_cast<int>(size[2]));
+    const std::int64_t words = _result.GetNumberOfWords();
+    const std::int64_t blocks = (words + kBlockWords - 1) / kBlockWords;
+    std::uint64_t* result = _result.GetWords();
+
+    vtkSMPTools::For(0, blocks, [&](vtkIdType begin, vtkIdType end) {
+        // one scratch block per stack level; operands of a push are read in place
+        std::vector<std::uint64_t> scratch(static_cast<size_t>(depth) * kBlockWords);
+        std::vector<const std::uint64_t*> stack(depth);
+
+        for (vtkIdType b = begin; b < end; ++b) {
+            const std::int64_t first = static_cast<std::int64_t>(b) * kBlockWords;
+            const int n = static_cast<int>(std::min<std::int64_t>(kBlockWords, words - first));
+
+            int top = 0;
+            for (const Op& op : program) {
+                if (op.code == Op::PUSH) {
+                    stack[top++] = packed[op.term].GetWords() + first;
+                    continue;
+                }
+                if (op.code == Op::NOT) {
+                    std::uint64_t* out = scratch.data() + static_cast<size_t>(top - 1) * kBlockWords;
+                    KernelNot(out, stack[top - 1], n);
+                    stack[top - 1] = out;
+                    continue;
+                }
+
+                std::uint64_t* out = scratch.data() + static_cast<size_t>(top - 2) * kBlockWords;
+                const std::uint64_t* a = stack[top - 2];
+                const std::uint64_t* c = stack[top - 1];
+                switch (op.code) {
+                    case Op::AND:     KernelAnd(out, a, c, n);    break;
+                    case Op::AND_NOT: KernelAndNot(out, a, c, n); break;
+                    case Op::XOR:     KernelXor(out, a, c, n);    break;
+                    default:          KernelOr(out, a, c, n);     break;
+                }
+                stack[top - 2] = out;
+                --top;
+            }
+
+            std::memcpy(result + first, stack[0], static_cast<size_t>(n) * sizeof(std::uint64_t));
+        }
+    });
+
+    // a not leaves bits set past the last voxel
+    _result.ClearTail();
+    return true;
+}
+
+void LaMaskAlgebra::GetOutput(MaskImageType* output) const {
+    if (_inputs.empty()) {
+        std::cerr << "LaMaskAlgebra::GetOutput — no input masks" << std::endl;
+        return;
+    }
+
+    const MaskImageType* reference = _inputs[0];
+    output->CopyInformation(reference);
+    output->SetRegions(reference->GetBufferedRegion());
+    output->Allocate();
+
+    const MaskImageType* labels = _label_source >= 0 ? _inputs[_label_source] : nullptr;
+    _result.Unpack(output, _output_value, labels);
+}
@@ -5,6 +5,7 @@
 #include <string>      // using string
 #include "../include/LaMaskBoolOperations.h"
 #include "../include/LaImage.h"
+#include "../include/LaMaskAlgebra.h"
 
 ;
 
@@ -15,6 +16,7 @@ LaMaskBoolOperations::LaMaskBoolOperations()
 	_mask_img2 = new LaImage(); 
 	_output_img = new LaImage();
 	_which_operation = BOOL_AND;
+	_succeeded = false; 
 }
 
 LaMaskBoolOperations::~LaMaskBoolOperations() {
@@ -35,32 +37,42 @@ void LaMaskBoolOperations::SetInputData2(LaImage* img) {
 	_mask_img2 = img; 
 }
 
+void LaMaskBoolOperations::AddInputData(LaImage* img) {
+
+	_more_masks.push_back(img); 
+}
+
+void LaMaskBoolOperations::SetExpression(const char* expression) {
+
+	_expression = expression; 
+}
+
 
 LaImage* LaMaskBoolOperations::GetOutput() {
 	return _output_img;
 }
 
+bool LaMaskBoolOperations::Succeeded() const {
+	return _succeeded;
+}
+
 void LaMaskBoolOperations::SetBooleanOperationToAND() 
 {
-	std::cout << "\n\ntPerforming AND ...\n";
 	_which_operation = BOOL_AND; 
 }
 
 void LaMaskBoolOperations::SetBooleanOperationToOR() 
 {
-	std::cout << "\n\ntPerforming OR ...\n";
 	_which_operation = BOOL_OR; 
 }
 
 void LaMaskBoolOperations::SetBooleanOperationToXOR() 
 {
-	std::cout << "\n\ntPerforming XOR ...\n";
 	_which_operation = BOOL_XOR; 
 }
 
 void LaMaskBoolOperations::SetBooleanOperationToANOTB() 
 {
-	std::cout << "\n\ntPerforming A not B ...\n";
 	_which_operation = BOOL_ANOTB; 
 }
 
@@ -68,75 +80,54 @@ void LaMaskBoolOperations::SetBooleanOperationToANOTB()
 
 void LaMaskBoolOperations::Update() {
 
-	typedef itk::Image< unsigned short, 3 >    InputImageType;
-	typedef itk::ImageRegionIterator<InputImageType>  IteratorType;
-
-	InputImageType::Pointer mask1 = _mask_img1->GetImage(); 
-	InputImageType::Pointer mask2 = _mask_img2->GetImage(); 
-
-	_mask_img1->DeepCopy(_output_img);
-	InputImageType::Pointer output = _output_img->GetImage();
+	// bit-packed masks evaluated in parallel, see LaMaskAlgebra.h 
+	LaMaskAlgebra algebra; 
+	_succeeded = false; 
 
-	IteratorType  mask_img1_it(mask1, mask1->GetRequestedRegion());
-	IteratorType  mask_img2_it(mask2, mask2->GetRequestedRegion());
-	IteratorType  output_it(output, output->GetRequestedRegion());
+	algebra.AddInput(_mask_img1->GetImage()); 
+	if (_mask_img2->GetImage()->GetBufferedRegion().GetNumberOfPixels() > 0)
+		algebra.AddInput(_mask_img2->GetImage()); 
+	for (size_t i = 0; i < _more_masks.size(); i++)
+		algebra.AddInput(_more_masks[i]->GetImage()); 
 
-	mask_img1_it.GoToBegin();
-	mask_img2_it.GoToBegin();
-	output_it.GoToBegin();
-
-	while (!mask_img1_it.IsAtEnd())
+	if (!_expression.empty())
+	{
+		std::cout << "\n\nEvaluating " << _expression << " ...\n";
+		algebra.SetExpression(_expression); 
+	}
+	else 
 	{
 		switch (_which_operation)
 		{
 			case BOOL_AND: 
-				if (mask_img1_it.Get() > 0 && mask_img2_it.Get() == 0)
-					output_it.Set(0);
-
-				++mask_img1_it;
-				++mask_img2_it;
-				++output_it;
+				std::cout << "\n\nPerforming AND ...\n";
+				algebra.SetExpression("A&B");
+				algebra.SetLabelSource(0);		// AND keeps the labels of mask 1 
 			break; 
 
 			case BOOL_OR: 
-				if (mask_img1_it.Get() == 0 && mask_img2_it.Get() > 0)
-					output_it.Set(1);
-				else if (mask_img1_it.Get() > 0)
-					output_it.Set(1);		// masks it 
-				
-				++mask_img1_it;
-				++mask_img2_it;
-				++output_it; 
+				std::cout << "\n\nPerforming OR ...\n";
+				algebra.SetExpression("A|B");
 			break; 
 
 			case BOOL_XOR:
-				if (mask_img1_it.Get() == 0 && mask_img2_it.Get() > 0)
-					output_it.Set(1);
-				else if (mask_img1_it.Get() > 0 && mask_img2_it.Get() > 0)
-					output_it.Set(0);
-				else if (mask_img1_it.Get() > 0 && mask_img2_it.Get() == 0)
-					output_it.Set(1);			// masks  it 
-
-				++mask_img1_it;
-				++mask_img2_it;
-				++output_it;
+				std::cout << "\n\nPerforming XOR ...\n";
+				algebra.SetExpression("A^B");
 			break;
 
 			case BOOL_ANOTB:
-				if (mask_img1_it.Get() > 0 && mask_img2_it.Get() > 0)
-					output_it.Set(0);
-				else if (mask_img1_it.Get() > 0 && mask_img2_it.Get() == 0)
-					output_it.Set(1);			
-				else if (mask_img2_it.Get() > 0)
-					output_it.Set(0);
-
-				++mask_img1_it;
-				++mask_img2_it;
-				++output_it;
+				std::cout << "\n\nPerforming A not B ...\n";
+				algebra.SetExpression("A-B");
 			break;
-
 		}
 	}
-	
 
-}
\ No newline at end of file
+	if (!algebra.Update())
+	{
+		std::cerr << "LaMaskBoolOperations::Update — mask algebra failed, no output written\n";
+		return; 
+	}
+
+	algebra.GetOutput(_output_img->GetImage()); 
+	_succeeded = true; 
+}
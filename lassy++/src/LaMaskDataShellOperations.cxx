@@ -78,18 +78,18 @@ void LaMaskDataShellOperations::Update() {
 
 	
 	
-	vtkSmartPointer<vtkPolyData> Data_Poly = vtkSmartPointer<vtkPolyData>::New();
-	vtkSmartPointer<vtkPolyData> Mask_Poly = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Data_Poly;
+	vtkSmartPointer<vtkPolyData> Mask_Poly;
 	
 
 	vtkSmartPointer<vtkFloatArray> Scalars_Data = vtkSmartPointer<vtkFloatArray>::New();
 	vtkSmartPointer<vtkFloatArray> Scalars_Mask = vtkSmartPointer<vtkFloatArray>::New();
 	vtkSmartPointer<vtkIntArray> Output_Poly_Scalar = vtkSmartPointer<vtkIntArray>::New();
 
-	_data_shell->GetMesh3D(Data_Poly);
+	Data_Poly = _data_shell->GetMesh3DView();
 	Scalars_Data = vtkFloatArray::SafeDownCast(Data_Poly->GetPointData()->GetScalars()); 
 
-	_mask_shell->GetMesh3D(Mask_Poly);
+	Mask_Poly = _mask_shell->GetMesh3DView();
 	Scalars_Mask = vtkFloatArray::SafeDownCast(Mask_Poly->GetPointData()->GetScalars());
 	
 	
@@ -152,11 +152,11 @@ void LaMaskDataShellOperations::Update() {
 	}
 
 	vtkSmartPointer<vtkPolyData> Output_Poly = vtkSmartPointer<vtkPolyData>::New();
-	Output_Poly->DeepCopy(Data_Poly);
+	Output_Poly->ShallowCopy(Data_Poly);
 
 	Output_Poly->GetPointData()->SetScalars(Output_Poly_Scalar);
 
-	_output_la->SetMesh3D(Output_Poly);
+	_output_la->AdoptMesh3D(Output_Poly);
 	
 
 }
\ No newline at end of file
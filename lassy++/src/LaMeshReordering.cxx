@@ -0,0 +1,552 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <tuple>
+#include <cstring>
+
+#include <vtkAbstractArray.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkFieldData.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "../include/LaMeshReordering.h"
+#include "../include/LaVolumePartition.h"
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+const double kCurveScale = static_cast<double>((1u << 21) - 1);
+const char   kCacheMagic[8] = {'L', 'A', 'O', 'R', 'D', 'E', 'R', '1'};
+
+/*
+ * Maps coordinates to 21-bit integers over the mesh bounds.
+ */
+struct Quantiser {
+    double origin[3];
+    double scale[3];
+
+    explicit Quantiser(vtkPointSet* mesh) {
+        double bounds[6];
+        mesh->GetBounds(bounds);
+        for (int k = 0; k < 3; ++k) {
+            const double extent = bounds[2 * k + 1] - bounds[2 * k];
+            origin[k] = bounds[2 * k];
+            scale[k]  = (extent > 0.0) ? kCurveScale / extent : 0.0;
+        }
+    }
+
+    void operator()(const double x[3], std::uint32_t q[3]) const {
+        for (int k = 0; k < 3; ++k) {
+            const double t = std::min(kCurveScale, std::max(0.0, (x[k] - origin[k]) * scale[k]));
+            q[k] = static_cast<std::uint32_t>(t);
+        }
+    }
+};
+
+/*
+ * vtkPolyData keeps verts, lines, polys and strips in that order; other
+ * meshes have a single block.
+ */
+int CellBlock(vtkPointSet* mesh, vtkIdType cell_id) {
+    if (!vtkPolyData::SafeDownCast(mesh)) return 0;
+    switch (mesh->GetCellType(cell_id)) {
+        case VTK_VERTEX:
+        case VTK_POLY_VERTEX:     return 0;
+        case VTK_LINE:
+        case VTK_POLY_LINE:       return 1;
+        case VTK_TRIANGLE_STRIP:  return 3;
+        default:                  return 2;
+    }
+}
+
+// Cell accessors are thread-safe once called from a single thread
+void PrepareCellAccess(vtkPointSet* mesh) {
+    if (mesh->GetNumberOfCells() == 0) return;
+    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+    mesh->GetCellType(0);
+    mesh->GetCellPoints(0, ids);
+}
+
+std::vector<vtkIdType> InverseOrder(const std::vector<vtkIdType>& order) {
+    std::vector<vtkIdType> inverse(order.size());
+    vtkSMPTools::For(0, static_cast<vtkIdType>(order.size()), [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType r = begin; r < end; ++r)
+            inverse[static_cast<size_t>(order[static_cast<size_t>(r)])] = r;
+    });
+    return inverse;
+}
+
+bool IsPermutation(const std::vector<vtkIdType>& order, vtkIdType count) {
+    if (static_cast<vtkIdType>(order.size()) != count) return false;
+    std::vector<unsigned char> seen(static_cast<size_t>(count), 0);
+    for (const vtkIdType id : order) {
+        if (id < 0 || id >= count || seen[static_cast<size_t>(id)]) return false;
+        seen[static_cast<size_t>(id)] = 1;
+    }
+    return true;
+}
+
+/*
+ * Copies every array of source into target in the given order, keeping
+ * the active attributes (scalars, normals, ...).
+ */
+void PermuteAttributes(vtkDataSetAttributes* source,
+                       vtkDataSetAttributes* target,
+                       const std::vector<vtkIdType>& order) {
+    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+    ids->SetNumberOfIds(static_cast<vtkIdType>(order.size()));
+    std::copy(order.begin(), order.end(), ids->GetPointer(0));
+
+    target->Initialize();
+    for (int a = 0; a < source->GetNumberOfArrays(); ++a) {
+        vtkAbstractArray* in = source->GetAbstractArray(a);
+
+        vtkSmartPointer<vtkAbstractArray> out;
+        out.TakeReference(in->NewInstance());
+        out->SetName(in->GetName());
+        out->SetNumberOfComponents(in->GetNumberOfComponents());
+        out->SetNumberOfTuples(static_cast<vtkIdType>(order.size()));
+        in->GetTuples(ids, out);
+
+        const int index = target->AddArray(out);
+        const int attribute = source->IsArrayAnAttribute(a);
+        if (attribute >= 0) target->SetActiveAttribute(index, attribute);
+    }
+}
+
+/*
+ * Cells order[first, last) of mesh as a cell array, with point ids
+ * renumbered through new_point_id.  Sizes first, then a parallel fill.
+ */
+vtkSmartPointer<vtkCellArray> PermutedCells(vtkPointSet* mesh,
+                                            const std::vector<vtkIdType>& order,
+                                            vtkIdType first,
+                                            vtkIdType last,
+                                            const std::vector<vtkIdType>& new_point_id) {
+    const vtkIdType count = last - first;
+
+    vtkSmartPointer<vtkIdTypeArray> offsets      = vtkSmartPointer<vtkIdTypeArray>::New();
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    offsets->SetNumberOfValues(count + 1);
+    vtkIdType* offset_ptr = offsets->GetPointer(0);
+
+    offset_ptr[0] = 0;
+    vtkSMPTools::For(0, count, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType r = begin; r < end; ++r)
+            offset_ptr[r + 1] = mesh->GetCellSize(order[static_cast<size_t>(first + r)]);
+    });
+    std::partial_sum(offset_ptr, offset_ptr + count + 1, offset_ptr);
+
+    connectivity->SetNumberOfValues(offset_ptr[count]);
+    vtkIdType* conn_ptr = connectivity->GetPointer(0);
+
+    vtkSMPThreadLocalObject<vtkIdList> thread_ids;
+    vtkSMPTools::For(0, count, [&](vtkIdType begin, vtkIdType end) {
+        vtkIdList* ids = thread_ids.Local();
+        for (vtkIdType r = begin; r < end; ++r) {
+            mesh->GetCellPoints(order[static_cast<size_t>(first + r)], ids);
+            vtkIdType* out = conn_ptr + offset_ptr[r];
+            for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k)
+                out[k] = new_point_id[static_cast<size_t>(ids->GetId(k))];
+        }
+    });
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+    return cells;
+}
+
+vtkSmartPointer<vtkPoints> PermutedPoints(vtkPointSet* mesh,
+                                          const std::vector<vtkIdType>& order) {
+    vtkPoints* in = mesh->GetPoints();
+    vtkSmartPointer<vtkPoints> out = vtkSmartPointer<vtkPoints>::New();
+    out->SetDataType(in->GetDataType());
+    out->SetNumberOfPoints(static_cast<vtkIdType>(order.size()));
+
+    vtkSMPTools::For(0, static_cast<vtkIdType>(order.size()), [&](vtkIdType begin, vtkIdType end) {
+        double x[3];
+        for (vtkIdType r = begin; r < end; ++r) {
+            in->GetPoint(order[static_cast<size_t>(r)], x);
+            out->SetPoint(r, x);
+        }
+    });
+    return out;
+}
+
+bool MatchesMesh(vtkPointSet* mesh, const LaMeshReordering::Permutation& permutation,
+                 const char* caller) {
+    if (!IsPermutation(permutation.point_order, mesh->GetNumberOfPoints()) ||
+        !IsPermutation(permutation.cell_order, mesh->GetNumberOfCells())) {
+        std::cerr << caller << " — permutation does not match the mesh." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// FNV-1a over the counts and the raw point coordinates
+std::uint64_t Fingerprint(vtkPointSet* mesh) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= bytes[i];
+            hash *= 1099511628211ull;
+        }
+    };
+
+    const std::int64_t counts[2] = {mesh->GetNumberOfPoints(), mesh->GetNumberOfCells()};
+    mix(counts, sizeof(counts));
+
+    vtkPoints* points = mesh->GetPoints();
+    if (points && points->GetNumberOfPoints() > 0) {
+        vtkDataArray* data = points->GetData();
+        mix(data->GetVoidPointer(0),
+            static_cast<size_t>(data->GetNumberOfValues()) *
+            static_cast<size_t>(data->GetDataTypeSize()));
+    }
+    return hash;
+}
+
+template <typename Mesh>
+LaMeshReordering::Permutation ReorderWithCache(Mesh* mesh,
+                                               LaMeshReordering::Curve curve,
+                                               const std::string& cache_file) {
+    LaMeshReordering::Permutation permutation;
+    const bool cached = !cache_file.empty() &&
+        LaMeshReordering::ReadCache(cache_file, mesh, curve, permutation);
+
+    if (!cached) {
+        permutation = LaMeshReordering::ComputeOrder(mesh, curve);
+        if (!cache_file.empty())
+            LaMeshReordering::WriteCache(cache_file, mesh, curve, permutation);
+    }
+
+    if (!LaMeshReordering::Apply(mesh, permutation)) return {};
+
+    std::cout << "LaMeshReordering: renumbered " << mesh->GetNumberOfPoints()
+              << " points and " << mesh->GetNumberOfCells() << " cells along the "
+              << (curve == LaMeshReordering::Curve::Hilbert ? "Hilbert" : "Morton")
+              << " curve" << (cached ? " (cached order)." : ".") << std::endl;
+    return permutation;
+}
+
+} // namespace
+
+
+// ============================================================
+// Curve codes
+// ============================================================
+
+std::uint64_t LaMeshReordering::HilbertCode(std::uint32_t x,
+                                            std::uint32_t y,
+                                            std::uint32_t z) {
+    // Skilling's axes-to-transpose transform, then bit interleaving
+    const int bits = 21;
+    std::uint32_t X[3] = {x, y, z};
+    const std::uint32_t M = 1u << (bits - 1);
+
+    for (std::uint32_t Q = M; Q > 1; Q >>= 1) {
+        const std::uint32_t P = Q - 1;
+        for (int i = 0; i < 3; ++i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            } else {
+                const std::uint32_t t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    std::uint32_t t = 0;
+    for (std::uint32_t Q = M; Q > 1; Q >>= 1) {
+        if (X[2] & Q) t ^= Q - 1;
+    }
+    for (int i = 0; i < 3; ++i) X[i] ^= t;
+
+    std::uint64_t code = 0;
+    for (int b = bits - 1; b >= 0; --b) {
+        for (int i = 0; i < 3; ++i)
+            code = (code << 1) | ((X[i] >> b) & 1u);
+    }
+    return code;
+}
+
+std::uint64_t LaMeshReordering::CurveCode(Curve curve,
+                                          std::uint32_t x,
+                                          std::uint32_t y,
+                                          std::uint32_t z) {
+    return (curve == Curve::Hilbert) ? HilbertCode(x, y, z)
+                                     : LaVolumePartition::MortonCode(x, y, z);
+}
+
+
+// ============================================================
+// Order
+// ============================================================
+
+LaMeshReordering::Permutation LaMeshReordering::ComputeOrder(vtkPointSet* mesh,
+                                                             Curve curve) {
+    Permutation permutation;
+    const vtkIdType num_points = mesh->GetNumberOfPoints();
+    const vtkIdType num_cells  = mesh->GetNumberOfCells();
+    if (num_points == 0) return permutation;
+
+    const Quantiser quantise(mesh);
+
+    // ---- Points ------------------------------------------------------
+    std::vector<std::pair<std::uint64_t, vtkIdType>> point_keys(static_cast<size_t>(num_points));
+    vtkSMPTools::For(0, num_points, [&](vtkIdType begin, vtkIdType end) {
+        double x[3];
+        std::uint32_t q[3];
+        for (vtkIdType i = begin; i < end; ++i) {
+            mesh->GetPoint(i, x);
+            quantise(x, q);
+            point_keys[static_cast<size_t>(i)] = {CurveCode(curve, q[0], q[1], q[2]), i};
+        }
+    });
+    vtkSMPTools::Sort(point_keys.begin(), point_keys.end());
+
+    permutation.point_order.resize(point_keys.size());
+    for (size_t r = 0; r < point_keys.size(); ++r)
+        permutation.point_order[r] = point_keys[r].second;
+
+    // ---- Cells: by block, then by the code of the centroid -------------
+    PrepareCellAccess(mesh);
+
+    std::vector<std::tuple<int, std::uint64_t, vtkIdType>> cell_keys(static_cast<size_t>(num_cells));
+    vtkSMPThreadLocalObject<vtkIdList> thread_ids;
+
+    vtkSMPTools::For(0, num_cells, [&](vtkIdType begin, vtkIdType end) {
+        vtkIdList* ids = thread_ids.Local();
+        double x[3];
+        std::uint32_t q[3];
+        for (vtkIdType c = begin; c < end; ++c) {
+            mesh->GetCellPoints(c, ids);
+            const vtkIdType n = ids->GetNumberOfIds();
+
+            double centroid[3] = {0.0, 0.0, 0.0};
+            for (vtkIdType k = 0; k < n; ++k) {
+                mesh->GetPoint(ids->GetId(k), x);
+                centroid[0] += x[0];
+                centroid[1] += x[1];
+                centroid[2] += x[2];
+            }
+            if (n > 0) {
+                for (double& v : centroid) v /= static_cast<double>(n);
+            }
+            quantise(centroid, q);
+            cell_keys[static_cast<size_t>(c)] =
+                std::make_tuple(CellBlock(mesh, c), CurveCode(curve, q[0], q[1], q[2]), c);
+        }
+    });
+    vtkSMPTools::Sort(cell_keys.begin(), cell_keys.end());
+
+    permutation.cell_order.resize(cell_keys.size());
+    for (size_t r = 0; r < cell_keys.size(); ++r)
+        permutation.cell_order[r] = std::get<2>(cell_keys[r]);
+
+    return permutation;
+}
+
+LaMeshReordering::Permutation LaMeshReordering::Inverse(const Permutation& permutation) {
+    Permutation inverse;
+    inverse.point_order = InverseOrder(permutation.point_order);
+    inverse.cell_order  = InverseOrder(permutation.cell_order);
+    return inverse;
+}
+
+
+// ============================================================
+// Apply
+// ============================================================
+
+bool LaMeshReordering::Apply(vtkPolyData* mesh, const Permutation& permutation) {
+    if (!MatchesMesh(mesh, permutation, "LaMeshReordering::Apply")) return false;
+
+    PrepareCellAccess(mesh);
+    const std::vector<vtkIdType> new_point_id = InverseOrder(permutation.point_order);
+
+    // Block boundaries in the new order; cells must stay grouped by kind
+    const vtkIdType num_cells = mesh->GetNumberOfCells();
+    vtkIdType block_end[4] = {0, 0, 0, 0};
+    int previous = 0;
+    for (vtkIdType r = 0; r < num_cells; ++r) {
+        const int block = CellBlock(mesh, permutation.cell_order[static_cast<size_t>(r)]);
+        if (block < previous) {
+            std::cerr << "LaMeshReordering::Apply — cell order mixes vertices, lines, "
+                         "polygons and strips." << std::endl;
+            return false;
+        }
+        previous = block;
+        block_end[block] = r + 1;
+    }
+    for (int b = 1; b < 4; ++b) block_end[b] = std::max(block_end[b], block_end[b - 1]);
+
+    vtkSmartPointer<vtkPolyData> result = vtkSmartPointer<vtkPolyData>::New();
+    result->SetPoints(PermutedPoints(mesh, permutation.point_order));
+    result->SetVerts (PermutedCells(mesh, permutation.cell_order, 0,            block_end[0], new_point_id));
+    result->SetLines (PermutedCells(mesh, permutation.cell_order, block_end[0], block_end[1], new_point_id));
+    result->SetPolys (PermutedCells(mesh, permutation.cell_order, block_end[1], block_end[2], new_point_id));
+    result->SetStrips(PermutedCells(mesh, permutation.cell_order, block_end[2], block_end[3], new_point_id));
+
+    PermuteAttributes(mesh->GetPointData(), result->GetPointData(), permutation.point_order);
+    PermuteAttributes(mesh->GetCellData(),  result->GetCellData(),  permutation.cell_order);
+    result->GetFieldData()->ShallowCopy(mesh->GetFieldData());
+
+    mesh->ShallowCopy(result);
+    return true;
+}
+
+bool LaMeshReordering::Apply(vtkUnstructuredGrid* grid, const Permutation& permutation) {
+    if (!MatchesMesh(grid, permutation, "LaMeshReordering::Apply")) return false;
+
+    PrepareCellAccess(grid);
+    const vtkIdType num_cells = grid->GetNumberOfCells();
+
+    vtkSmartPointer<vtkUnsignedCharArray> types = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    types->SetNumberOfValues(num_cells);
+    for (vtkIdType r = 0; r < num_cells; ++r) {
+        const int type = grid->GetCellType(permutation.cell_order[static_cast<size_t>(r)]);
+        if (type == VTK_POLYHEDRON) {
+            std::cerr << "LaMeshReordering::Apply — polyhedral cells are not supported."
+                      << std::endl;
+            return false;
+        }
+        types->SetValue(r, static_cast<unsigned char>(type));
+    }
+
+    const std::vector<vtkIdType> new_point_id = InverseOrder(permutation.point_order);
+
+    vtkSmartPointer<vtkUnstructuredGrid> result = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    result->SetPoints(PermutedPoints(grid, permutation.point_order));
+    result->SetCells(types, PermutedCells(grid, permutation.cell_order, 0, num_cells, new_point_id));
+
+    PermuteAttributes(grid->GetPointData(), result->GetPointData(), permutation.point_order);
+    PermuteAttributes(grid->GetCellData(),  result->GetCellData(),  permutation.cell_order);
+    result->GetFieldData()->ShallowCopy(grid->GetFieldData());
+
+    grid->ShallowCopy(result);
+    return true;
+}
+
+LaMeshReordering::Permutation LaMeshReordering::Reorder(vtkPolyData* mesh, Curve curve,
+                                                        const std::string& cache_file) {
+    return ReorderWithCache(mesh, curve, cache_file);
+}
+
+LaMeshReordering::Permutation LaMeshReordering::Reorder(vtkUnstructuredGrid* grid, Curve curve,
+                                                        const std::string& cache_file) {
+    return ReorderWithCache(grid, curve, cache_file);
+}
+
+
+// ============================================================
+// Cache
+// ============================================================
+
+bool LaMeshReordering::ReadCache(const std::string& cache_file, vtkPointSet* mesh,
+                                 Curve curve, Permutation& permutation) {
+    std::ifstream in(cache_file, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char          magic[8];
+    std::int32_t  cached_curve = 0;
+    std::int64_t  counts[2]    = {0, 0};
+    std::uint64_t fingerprint  = 0;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&cached_curve), sizeof(cached_curve));
+    in.read(reinterpret_cast<char*>(counts), sizeof(counts));
+    in.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+
+    if (!in || std::memcmp(magic, kCacheMagic, sizeof(magic)) != 0 ||
+        cached_curve != static_cast<std::int32_t>(curve) ||
+        counts[0] != mesh->GetNumberOfPoints() || counts[1] != mesh->GetNumberOfCells() ||
+        fingerprint != Fingerprint(mesh)) {
+        std::cerr << "LaMeshReordering: ignoring stale cache " << cache_file << std::endl;
+        return false;
+    }
+
+    std::vector<std::int64_t> buffer(static_cast<size_t>(counts[0] + counts[1]));
+    in.read(reinterpret_cast<char*>(buffer.data()),
+            static_cast<std::streamsize>(buffer.size() * sizeof(std::int64_t)));
+    if (!in) {
+        std::cerr << "LaMeshReordering: truncated cache " << cache_file << std::endl;
+        return false;
+    }
+
+    permutation.point_order.assign(buffer.begin(), buffer.begin() + counts[0]);
+    permutation.cell_order.assign(buffer.begin() + counts[0], buffer.end());
+    return true;
+}
+
+bool LaMeshReordering::WriteCache(const std::string& cache_file, vtkPointSet* mesh,
+                                  Curve curve, const Permutation& permutation) {
+    std::ofstream out(cache_file, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "LaMeshReordering: cannot write cache " << cache_file << std::endl;
+        return false;
+    }
+
+    const std::int32_t  cached_curve = static_cast<std::int32_t>(curve);
+    const std::int64_t  counts[2]    = {mesh->GetNumberOfPoints(), mesh->GetNumberOfCells()};
+    const std::uint64_t fingerprint  = Fingerprint(mesh);
+
+    std::vector<std::int64_t> buffer(permutation.point_order.begin(), permutation.point_order.end());
+    buffer.insert(buffer.end(), permutation.cell_order.begin(), permutation.cell_order.end());
+
+    out.write(kCacheMagic, sizeof(kCacheMagic));
+    out.write(reinterpret_cast<const char*>(&cached_curve), sizeof(cached_curve));
+    out.write(reinterpret_cast<const char*>(counts), sizeof(counts));
+    out.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+    out.write(reinterpret_cast<const char*>(buffer.data()),
+              static_cast<std::streamsize>(buffer.size() * sizeof(std::int64_t)));
+    return static_cast<bool>(out);
+}
+
+
+// ============================================================
+// Diagnostics
+// ============================================================
+
+double LaMeshReordering::MeanNeighbourIdGap(vtkPointSet* mesh) {
+    const vtkIdType num_cells = mesh->GetNumberOfCells();
+    if (num_cells == 0) return 0.0;
+
+    PrepareCellAccess(mesh);
+    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+
+    double sum   = 0.0;
+    double pairs = 0.0;
+    for (vtkIdType c = 0; c < num_cells; ++c) {
+        mesh->GetCellPoints(c, ids);
+        const vtkIdType n = ids->GetNumberOfIds();
+        if (n < 2) continue;
+        for (vtkIdType k = 0; k < n; ++k) {
+            const vtkIdType a = ids->GetId(k);
+            const vtkIdType b = ids->GetId((k + 1) % n);
+            sum += static_cast<double>(a > b ? a - b : b - a);
+            pairs += 1.0;
+        }
+    }
+    return (pairs > 0.0) ? sum / pairs : 0.0;
+}
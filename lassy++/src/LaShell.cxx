@@ -3,6 +3,7 @@
 /* The Circle class (All source codes in one file) (CircleAIO.cpp) */
 #include <iostream>    // using IO functions
 #include <string>      // using string
+#include <cstdlib>
 #include "../include/LaShell.h"
 #include "../include/ShellEntropy.h"
 ;
@@ -21,13 +22,13 @@ LaShell::LaShell(const char* vtk_fn, bool ugrid_bool){
 		_mesh_3d = vtkSmartPointer<vtkPolyData>::New();
 
 	}else{
-		vtkSmartPointer<vtkPolyDataReader> reader = vtkSmartPointer<vtkPolyDataReader>::New();
-		reader->SetFileName(vtk_fn);
-		reader->ReadAllScalarsOn();
-		reader->Update();
-
+		// no copy: the reader output, or the mapped payloads of a .lmsh file
 		_mesh_3d = vtkSmartPointer<vtkPolyData>::New();
-		_mesh_3d->DeepCopy(reader->GetOutput());
+		if (!LaShellIO::Read(vtk_fn, _mesh_3d))
+		{
+			std::cerr << "Error creating LaShell class object, cannot read mesh: " << vtk_fn << std::endl;
+			exit(1);
+		}
 		_ugrid_3d = vtkSmartPointer<vtkUnstructuredGrid>::New();
 	}
 
@@ -63,13 +64,80 @@ void LaShell::GetMesh3D(vtkSmartPointer<vtkPolyData> mesh_output) {  // Member f
 
 void LaShell::SetMesh3D(vtkSmartPointer<vtkPolyData> input) {  // Member function (Getter)
 	_mesh_3d->DeepCopy(input);
+	_reordering = LaMeshReordering::Permutation();
+}
+
+vtkSmartPointer<vtkPolyData> LaShell::GetMesh3DView() const
+{
+	vtkSmartPointer<vtkPolyData> view = vtkSmartPointer<vtkPolyData>::New();
+	view->ShallowCopy(_mesh_3d);
+	return view;
+}
+
+void LaShell::AdoptMesh3D(vtkSmartPointer<vtkPolyData> input)
+{
+	// a fresh object, so input may itself be a view of this shell
+	_mesh_3d = vtkSmartPointer<vtkPolyData>::New();
+	_mesh_3d->ShallowCopy(input);
+	_reordering = LaMeshReordering::Permutation();
+}
+
+void LaShell::MakeWritable(vtkPolyData* mesh)
+{
+	if (mesh == NULL) return;
+
+	// a reference count above one means another dataset (view or shell) holds the same object
+	vtkPoints* points = mesh->GetPoints();
+	if (points != NULL && points->GetReferenceCount() > 1)
+	{
+		vtkSmartPointer<vtkPoints> own_points = vtkSmartPointer<vtkPoints>::New();
+		own_points->DeepCopy(points);
+		mesh->SetPoints(own_points);
+	}
+
+	vtkCellArray* cells[4] = { mesh->GetVerts(), mesh->GetLines(), mesh->GetPolys(), mesh->GetStrips() };
+	vtkSmartPointer<vtkCellArray> own_cells[4];
+	bool cells_shared = false;
+	for (int k = 0; k < 4; k++)
+	{
+		own_cells[k] = cells[k];
+		if (cells[k] != NULL && cells[k]->GetReferenceCount() > 1)
+		{
+			own_cells[k] = vtkSmartPointer<vtkCellArray>::New();
+			own_cells[k]->DeepCopy(cells[k]);
+			cells_shared = true;
+		}
+	}
+	if (cells_shared)
+	{
+		mesh->SetVerts(own_cells[0]);
+		mesh->SetLines(own_cells[1]);
+		mesh->SetPolys(own_cells[2]);
+		mesh->SetStrips(own_cells[3]);
+	}
+
+	vtkDataSetAttributes* attributes[2] = { mesh->GetPointData(), mesh->GetCellData() };
+	for (int k = 0; k < 2; k++)
+	{
+		bool shared = false;
+		for (int i = 0; i < attributes[k]->GetNumberOfArrays() && !shared; i++)
+			shared = attributes[k]->GetAbstractArray(i)->GetReferenceCount() > 1;
+		if (!shared) continue;
+
+		// copied as a whole so the active scalars/normals/... stay as they were
+		vtkSmartPointer<vtkDataSetAttributes> own = vtkSmartPointer<vtkDataSetAttributes>::New();
+		own->DeepCopy(attributes[k]);
+		attributes[k]->ShallowCopy(own);
+	}
 }
 
 void LaShell::ExportVTK(const char* vtk_fn) {
-	vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
-	writer->SetInputData(_mesh_3d);
-	writer->SetFileName(vtk_fn);
-	writer->Update();
+	Export(vtk_fn);
+}
+
+void LaShell::Export(const char* fn, const LaShellIO::WriteOptions& options) {
+	if (!LaShellIO::Write(fn, _mesh_3d, options))
+		std::cerr << "LaShell::Export — could not write " << fn << std::endl;
 }
 
 void LaShell::GetMinimumMaximum(double& min, double& max)
@@ -121,6 +189,7 @@ void LaShell::BinaryImageToShell(LaImage *la_mask, double threshold)
 	//surfaceMapper->SetInputConnection(normals->GetOutputPort());
 
 	_mesh_3d = normals->GetOutput();
+	_reordering = LaMeshReordering::Permutation();
 }
 
 
@@ -149,9 +218,29 @@ void LaShell::Ugrid2PolyData(){
   surfaceFilter->Update();
 
 	_mesh_3d = surfaceFilter->GetOutput();
+	_reordering = LaMeshReordering::Permutation();
 }
 
 void LaShell::ComputeMeshNeighbourhoodTransform(vtkSmartPointer<vtkPolyData> mesh_output)
 {
 	ShellEntropy* entropy = new ShellEntropy(_mesh_3d);
 }
+
+
+void LaShell::Reorder(LaMeshReordering::Curve curve, const char* cache_fn)
+{
+	if (!_reordering.IsEmpty()) RestoreOriginalOrder();
+	_reordering = LaMeshReordering::Reorder(_mesh_3d, curve, cache_fn ? cache_fn : "");
+}
+
+void LaShell::RestoreOriginalOrder()
+{
+	if (_reordering.IsEmpty()) return;
+	LaMeshReordering::Apply(_mesh_3d.GetPointer(), LaMeshReordering::Inverse(_reordering));
+	_reordering = LaMeshReordering::Permutation();
+}
+
+const LaMeshReordering::Permutation& LaShell::GetReordering() const
+{
+	return _reordering;
+}
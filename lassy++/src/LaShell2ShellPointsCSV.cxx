@@ -87,8 +87,7 @@ void LaShell2ShellPointsCSV::LocateCSVPointsInSource() {
     double xyz[3]; 
     int closestPointID=-1;
 
-    vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(mesh);
+    vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
     vtkSmartPointer<vtkPointLocator> point_locator = vtkSmartPointer<vtkPointLocator>::New();
 	point_locator->SetDataSet(mesh); 
@@ -122,12 +121,10 @@ void LaShell2ShellPointsCSV::LocateSourcePointsOnTarget() {
     double xyz_source[3], xyz_target[3]; 
     int closestPointID=-1;
 
-    vtkSmartPointer<vtkPolyData> source_mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_in_target_la->GetMesh3D(source_mesh);
+    vtkSmartPointer<vtkPolyData> source_mesh = _source_in_target_la->GetMesh3DView();
 
 
-    vtkSmartPointer<vtkPolyData> target_mesh = vtkSmartPointer<vtkPolyData>::New();
-    _target_la->GetMesh3D(target_mesh);
+    vtkSmartPointer<vtkPolyData> target_mesh = _target_la->GetMesh3DView();
 
     vtkSmartPointer<vtkPointLocator> point_locator = vtkSmartPointer<vtkPointLocator>::New();
 	point_locator->SetDataSet(target_mesh); 
@@ -73,8 +73,7 @@ void LaShellEnclosureDistance::Update() {
 		
 	}
 
-	vtkSmartPointer<vtkPolyData> ShellPolyData = vtkSmartPointer<vtkPolyData>::New();
-	_source_shell->GetMesh3D(ShellPolyData);
+	vtkSmartPointer<vtkPolyData> ShellPolyData = _source_shell->GetMesh3DView();
 
 	vtkSmartPointer<vtkPolyDataNormals> SourcePolyNormals = vtkSmartPointer<vtkPolyDataNormals>::New();
 	SourcePolyNormals->ComputeCellNormalsOn();
@@ -82,7 +81,7 @@ void LaShellEnclosureDistance::Update() {
 	SourcePolyNormals->Update();
 
 	vtkSmartPointer<vtkPolyData> OutputPoly = vtkSmartPointer<vtkPolyData>::New();
-	OutputPoly->DeepCopy(ShellPolyData);
+	OutputPoly->ShallowCopy(ShellPolyData);
 
 	vtkSmartPointer<vtkFloatArray> OutputPolyScalars = vtkSmartPointer<vtkFloatArray>::New();
 	OutputPolyScalars->SetNumberOfComponents(1);
@@ -134,5 +133,5 @@ void LaShellEnclosureDistance::Update() {
 		ofs.close();
 	}
 
-	_output_shell->SetMesh3D(OutputPoly);
+	_output_shell->AdoptMesh3D(OutputPoly);
 }
@@ -41,8 +41,7 @@ void LaShellExtractArray::Update() {
 	
 	int n, k = -1;
 	
-	vtkSmartPointer<vtkPolyData> source_poly_data = vtkSmartPointer<vtkPolyData>::New(); 
-	_source_la->GetMesh3D(source_poly_data); 
+	vtkSmartPointer<vtkPolyData> source_poly_data = _source_la->GetMesh3DView(); 
 
 
 	vtkIdType numberOfPointArrays = source_poly_data->GetPointData()->GetNumberOfArrays();
@@ -72,7 +71,7 @@ void LaShellExtractArray::Update() {
 
 	
 
-		_output_la->SetMesh3D(OutputPoly);
+		_output_la->AdoptMesh3D(OutputPoly);
 
 	}
 
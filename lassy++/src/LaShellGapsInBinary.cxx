@@ -4,6 +4,7 @@
 /* The Circle class (All source codes in one file) (CircleAIO.cpp) */
 #include <iostream>    // using IO functions
 #include <string>      // using string
+#include <algorithm>
 #include "../include/LaShellGapsInBinary.h"
 
 ;
@@ -592,6 +593,10 @@ const std::vector<std::array<double, 3>>& LaShellGapsInBinary::GetPickedPosition
 	return _pickpositionarray;
 }
 
+const std::vector<int>& LaShellGapsInBinary::GetPickedPointIds() const {
+	return _pointidarray;
+}
+
 void LaShellGapsInBinary::CorridorFromPointList(std::vector<int> points){
 	vtkSmartPointer<vtkPolyData> poly_data = vtkSmartPointer<vtkPolyData>::New();
 	poly_data = this->GetSourcePolyData();
@@ -632,6 +637,109 @@ void LaShellGapsInBinary::CorridorFromPointList(std::vector<int> points){
 	this->_corridoridarray.clear();
 
 }
+/*
+*	Brings the drawn paths in line with the picked points. Segments are looked up in
+*	_segment_cache by (start, end) vertex; only missing segments run Dijkstra and get
+*	a new actor, segments no longer on the path have their actor removed.
+*	_shortestPaths, _paths, _pathMappers and _actors are rebuilt in path order.
+*/
+void LaShellGapsInBinary::UpdatePathSegments(vtkSmartPointer<vtkRenderer> renderer, bool close_loop)
+{
+	std::vector<std::pair<vtkIdType, vtkIdType> > required;
+	int lim = _pointidarray.size();
+	for (int i=0;i<lim-1;i++)
+		required.push_back(std::make_pair(_pointidarray[i], _pointidarray[i+1]));
+	if (close_loop && lim > 1)
+		required.push_back(std::make_pair(_pointidarray[lim-1], _pointidarray[0]));
+
+	// drop segments that are no longer part of the path
+	for (auto it = _segment_cache.begin(); it != _segment_cache.end(); ) {
+		if (std::find(required.begin(), required.end(), it->first) == required.end()) {
+			renderer->RemoveActor(it->second.actor);
+			it = _segment_cache.erase(it);
+		}
+		else
+			++it;
+	}
+
+	_shortestPaths.clear();
+	_paths.clear();
+	_pathMappers.clear();
+	_actors.clear();
+
+	int computed = 0;
+	for (int i=0;i<required.size();i++){
+		auto found = _segment_cache.find(required[i]);
+		if (found == _segment_cache.end()) {
+			std::cout << "Computing shortest paths between points " << required[i].first << " and  " << required[i].second << std::endl;
+
+			PathSegment segment;
+			segment.dijkstra = vtkSmartPointer<vtkDijkstraGraphGeodesicPath>::New();
+			segment.dijkstra->SetInputData(_SourcePolyData);
+			segment.dijkstra->UseScalarWeightsOn();
+			segment.dijkstra->SetStartVertex(required[i].first);
+			segment.dijkstra->SetEndVertex(required[i].second);
+			segment.dijkstra->Update();
+
+			vtkSmartPointer<vtkPolyDataMapper> pathMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
+			pathMapper->SetInputConnection(segment.dijkstra->GetOutputPort());
+
+			segment.actor = vtkSmartPointer<vtkActor>::New();
+			segment.actor->SetMapper(pathMapper);
+			segment.actor->GetProperty()->SetColor(1,0,0); // Red
+			segment.actor->GetProperty()->SetLineWidth(4);
+			renderer->AddActor(segment.actor);
+
+			found = _segment_cache.insert(std::make_pair(required[i], segment)).first;
+			computed++;
+		}
+
+		_shortestPaths.push_back(found->second.dijkstra);
+		_paths.push_back(found->second.dijkstra->GetOutput());
+		_pathMappers.push_back(vtkPolyDataMapper::SafeDownCast(found->second.actor->GetMapper()));
+		_actors.push_back(found->second.actor);
+	}
+
+	std::cout << "Path has " << required.size() << " segments, "
+		<< computed << " recomputed and " << required.size() - computed << " reused" << std::endl;
+}
+
+/*
+*	Removes the most recently picked point and its sphere. Cached segments that
+*	start or end at that vertex are dropped straight away, the remaining path is
+*	brought up to date on the next 'l' or 'c'.
+*/
+void LaShellGapsInBinary::RemoveLastPickedPoint(vtkSmartPointer<vtkRenderer> renderer)
+{
+	if (_pointidarray.empty()) {
+		std::cout << "No picked points to remove" << std::endl;
+		return;
+	}
+
+	vtkIdType removed = _pointidarray.back();
+	_pointidarray.pop_back();
+	if (!_pickpositionarray.empty())
+		_pickpositionarray.pop_back();
+	if (!_sphere_actors.empty()) {
+		renderer->RemoveActor(_sphere_actors.back());
+		_sphere_actors.pop_back();
+	}
+
+	if (std::find(_pointidarray.begin(), _pointidarray.end(), removed) == _pointidarray.end()) {
+		for (auto it = _segment_cache.begin(); it != _segment_cache.end(); ) {
+			if (it->first.first == removed || it->first.second == removed) {
+				renderer->RemoveActor(it->second.actor);
+				it = _segment_cache.erase(it);
+			}
+			else
+				++it;
+		}
+	}
+
+	std::cout << "Removed point id = " << removed << ", "
+		<< _pointidarray.size() << " points remain picked" << std::endl;
+}
+
 /*
 *	This will handle the event when a user presses the 'x' on the keyboard
 */
@@ -685,7 +793,8 @@ void LaShellGapsInBinary::KeyPressEventHandler(vtkObject* obj, unsigned long eve
 		this_class_obj->_pointidarray.push_back(pointID);
 		this_class_obj->_pickpositionarray.push_back({pick_position[0], pick_position[1], pick_position[2]});
 
-		LaShellGapsInBinary::CreateSphere(renderer, 1.5, pick_position);		// now draw the sphere
+		this_class_obj->_sphere_actors.push_back(
+			LaShellGapsInBinary::CreateSphere(renderer, 1.5, pick_position));		// now draw the sphere
 
 		iren->Render();
 		delete[] pick_position;
@@ -695,61 +804,23 @@ void LaShellGapsInBinary::KeyPressEventHandler(vtkObject* obj, unsigned long eve
 	*/
 	else if (iren->GetKeyCode()=='l' || iren->GetKeyCode()=='c') {
 
-				//////////////////Dijkstra//////////////////////////////////////////
-				int lim = this_class_obj->_pointidarray.size();
-				for(int i=0; i<lim; i++){
-					vtkSmartPointer<vtkDijkstraGraphGeodesicPath> dijkstra = vtkSmartPointer<vtkDijkstraGraphGeodesicPath>::New();
-					dijkstra->SetInputData(poly_data);
-					dijkstra->UseScalarWeightsOn();
-					dijkstra->Update();
-
-					if(i<lim-1){
-						dijkstra->SetStartVertex(this_class_obj->_pointidarray[i]);
-						dijkstra->SetEndVertex(this_class_obj->_pointidarray[i+1]);
-						std::cout << "Computing shortest paths between points " << this_class_obj->_pointidarray[i] << " and  " << this_class_obj->_pointidarray[i+1]  << std::endl;
-					}
-					else if(iren->GetKeyCode()=='c' && i == lim-1){
-						dijkstra->SetStartVertex(this_class_obj->_pointidarray[i]);
-						dijkstra->SetEndVertex(this_class_obj->_pointidarray[0]);
-						std::cout << "Computing shortest paths between points " << this_class_obj->_pointidarray[i] << " and  " << this_class_obj->_pointidarray[0]  << std::endl;
-					}
-
-					dijkstra->Update();
-					vtkSmartPointer<vtkPolyDataMapper> pathMapper = vtkSmartPointer<vtkPolyDataMapper>::New();
-					pathMapper->SetInputConnection(dijkstra->GetOutputPort());
-
-					this_class_obj->_shortestPaths.push_back(dijkstra);
-					this_class_obj->_pathMappers.push_back(pathMapper);			// store all the shortest paths
-					this_class_obj->_paths.push_back(dijkstra->GetOutput());	// and the path as polygonal data
-				}
-
-				// now draw all the paths
-				for (int i=0;i<this_class_obj->_paths.size();i++){
-					vtkSmartPointer<vtkActor> pathActor = vtkSmartPointer<vtkActor>::New();
-					pathActor->SetMapper(this_class_obj->_pathMappers[i]);
-					pathActor->GetProperty()->SetColor(1,0,0); // Red
-					pathActor->GetProperty()->SetLineWidth(4);
-
-					//////////////////Dijkstra//////////////////////////////////////////
-					this_class_obj->_actors.push_back(pathActor);
-				}
-
-				for (int i=0;i<this_class_obj->_actors.size();i++)
-					renderer->AddActor(this_class_obj->_actors[i]);
-
-				renderWin->AddRenderer(renderer);
+				// only segments touched by points picked or removed since the last
+				// press are recomputed, the rest come from the segment cache
+				this_class_obj->UpdatePathSegments(renderer, iren->GetKeyCode()=='c');
 				iren->Render();
 
 				// compute percentage encirlcement
 				this_class_obj->ExtractImageDataAlongTrajectory(this_class_obj->_shortestPaths);
-
-				this_class_obj->_pointidarray.clear();
-				this_class_obj->_paths.clear();
-				this_class_obj->_shortestPaths.clear();
-				this_class_obj->_pathMappers.clear();
 				this_class_obj->_run_count++;
 
 	}
+	/*
+	*	u for undoing the last picked point
+	*/
+	else if (iren->GetKeyCode()=='u'){
+		this_class_obj->RemoveLastPickedPoint(renderer);
+		iren->Render();
+	}
 
 	else if (iren->GetKeyCode()=='s'){
 		
@@ -761,7 +832,7 @@ void LaShellGapsInBinary::KeyPressEventHandler(vtkObject* obj, unsigned long eve
 }
 
 // this wil draw a sphere of a given radus to the renderer
-void LaShellGapsInBinary::CreateSphere(vtkSmartPointer<vtkRenderer> renderer, double radius, double position3D[])
+vtkSmartPointer<vtkActor> LaShellGapsInBinary::CreateSphere(vtkSmartPointer<vtkRenderer> renderer, double radius, double position3D[])
 {
 	vtkSmartPointer<vtkSphereSource> sphere = vtkSmartPointer<vtkSphereSource>::New();
 	sphere->SetThetaResolution(8);
@@ -777,7 +848,7 @@ void LaShellGapsInBinary::CreateSphere(vtkSmartPointer<vtkRenderer> renderer, do
 	actor->GetProperty()->SetColor(0,0,1);
 	actor->SetPosition(position3D);
 	renderer->AddActor(actor);
-
+	return actor;
 }
 
 void LaShellGapsInBinary::Run()
@@ -0,0 +1,566 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <vtkSmartPointer.h>
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkDataArray.h>
+#include <vtkFieldData.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkTypeInt64Array.h>
+#include <vtkAlgorithm.h>
+#include <vtkPolyDataReader.h>
+#include <vtkPolyDataWriter.h>
+#include <vtkXMLPolyDataReader.h>
+#include <vtkXMLPolyDataWriter.h>
+
+#include "../include/LaShellIO.h"
+#include "../include/LaFileName.h"
+
+
+const char* LaShellIO::NativeExtension = ".lmsh";
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+const char          kMagic[8]         = {'L', 'A', 'M', 'E', 'S', 'H', '0', '1'};
+const std::uint32_t kByteOrderMark    = 0x01020304u;
+const std::uint64_t kPayloadAlignment = 4096;
+
+enum Section : std::uint32_t {
+    PointsSection           = 1,
+    CellOffsetsSection      = 2,
+    CellConnectivitySection = 3,
+    PointDataSection        = 4,
+    CellDataSection         = 5,
+    FieldDataSection        = 6
+};
+
+struct Entry {
+    std::uint32_t section;
+    std::int32_t  vtk_type;
+    std::int32_t  num_components;
+    std::int32_t  attribute;        // active attribute type, cell block for cells
+    std::int64_t  num_tuples;
+    std::uint64_t offset;
+    std::uint64_t bytes;
+    std::string   name;
+    vtkDataArray* array;            // writer only
+};
+
+template <typename T>
+void WritePod(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool ReadPod(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+std::uint64_t AlignUp(std::uint64_t value) {
+    return (value + kPayloadAlignment - 1) / kPayloadAlignment * kPayloadAlignment;
+}
+
+// ---- Mapped payloads ----------------------------------------------------
+
+#if !defined(_WIN32)
+// vtkBuffer hands the free function only the pointer; the lengths for
+// munmap are kept here.
+std::mutex& MappingMutex() {
+    static std::mutex mutex;
+    return mutex;
+}
+
+std::unordered_map<void*, size_t>& MappingLengths() {
+    static std::unordered_map<void*, size_t> lengths;
+    return lengths;
+}
+
+void ReleaseMapping(void* data) {
+    size_t length = 0;
+    {
+        std::lock_guard<std::mutex> lock(MappingMutex());
+        auto it = MappingLengths().find(data);
+        if (it == MappingLengths().end()) return;
+        length = it->second;
+        MappingLengths().erase(it);
+    }
+    ::munmap(data, length);
+}
+#endif
+
+/*
+ * Numeric VTK types a payload may hold; anything else is corrupt
+ * (vtkDataArray::CreateDataArray would quietly make a double array).
+ */
+bool IsNumericType(int vtk_type) {
+    switch (vtk_type) {
+        case VTK_CHAR:      case VTK_SIGNED_CHAR:    case VTK_UNSIGNED_CHAR:
+        case VTK_SHORT:     case VTK_UNSIGNED_SHORT:
+        case VTK_INT:       case VTK_UNSIGNED_INT:
+        case VTK_LONG:      case VTK_UNSIGNED_LONG:
+        case VTK_LONG_LONG: case VTK_UNSIGNED_LONG_LONG:
+        case VTK_ID_TYPE:
+        case VTK_FLOAT:     case VTK_DOUBLE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Offsets run from 0 to the connectivity length without decreasing, and
+ * every connectivity id is a point of the mesh; checked in parallel.
+ */
+bool ValidCells(vtkTypeInt64Array* offsets, vtkTypeInt64Array* connectivity,
+                vtkIdType num_points) {
+    const vtkIdType num_offsets = offsets->GetNumberOfTuples();
+    const vtkIdType num_ids     = connectivity->GetNumberOfTuples();
+    if (offsets->GetNumberOfComponents() != 1 || connectivity->GetNumberOfComponents() != 1 ||
+        num_offsets < 1 || offsets->GetValue(0) != 0 ||
+        offsets->GetValue(num_offsets - 1) != num_ids)
+        return false;
+
+    const vtkTypeInt64* offset = offsets->GetPointer(0);
+    const vtkTypeInt64* ids    = connectivity->GetPointer(0);
+    std::atomic<bool> ok(true);
+    vtkSMPTools::For(1, num_offsets, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i) {
+            if (offset[i] < offset[i - 1]) { ok = false; return; }
+        }
+    });
+    vtkSMPTools::For(0, num_ids, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType i = begin; i < end; ++i) {
+            if (ids[i] < 0 || ids[i] >= num_points) { ok = false; return; }
+        }
+    });
+    return ok;
+}
+
+/*
+ * Fills array (type and components already set) with the payload of
+ * entry: mapped copy-on-write when possible, read otherwise.
+ */
+bool LoadPayload(std::ifstream& in, int fd, const Entry& entry, vtkDataArray* array) {
+    // divide rather than multiply, so a corrupt tuple count cannot overflow
+    const std::uint64_t value_bytes = static_cast<std::uint64_t>(entry.num_components) *
+                                      static_cast<std::uint64_t>(array->GetDataTypeSize());
+    if (value_bytes == 0 || entry.bytes % value_bytes != 0 ||
+        entry.bytes / value_bytes != static_cast<std::uint64_t>(entry.num_tuples))
+        return false;
+    const vtkIdType num_values = static_cast<vtkIdType>(entry.num_tuples) * entry.num_components;
+
+#if !defined(_WIN32)
+    const long page_size = ::sysconf(_SC_PAGESIZE);
+    if (fd >= 0 && entry.bytes > 0 && page_size > 0 &&
+        entry.offset % static_cast<std::uint64_t>(page_size) == 0) {
+        void* mapped = ::mmap(nullptr, static_cast<size_t>(entry.bytes),
+                              PROT_READ | PROT_WRITE, MAP_PRIVATE, fd,
+                              static_cast<off_t>(entry.offset));
+        if (mapped != MAP_FAILED) {
+            {
+                std::lock_guard<std::mutex> lock(MappingMutex());
+                MappingLengths()[mapped] = static_cast<size_t>(entry.bytes);
+            }
+            array->SetVoidArray(mapped, num_values, 0,
+                                vtkAbstractArray::VTK_DATA_ARRAY_USER_DEFINED);
+            array->SetArrayFreeFunction(&ReleaseMapping);
+            return true;
+        }
+    }
+#else
+    (void)fd;
+#endif
+
+    array->SetNumberOfTuples(static_cast<vtkIdType>(entry.num_tuples));
+    if (entry.bytes == 0) return true;
+    in.seekg(static_cast<std::streamoff>(entry.offset));
+    return static_cast<bool>(in.read(static_cast<char*>(array->GetVoidPointer(0)),
+                                     static_cast<std::streamsize>(entry.bytes)));
+}
+
+void AddAttributeEntries(vtkFieldData* data, std::uint32_t section, std::vector<Entry>& entries) {
+    vtkDataSetAttributes* attributes = vtkDataSetAttributes::SafeDownCast(data);
+    for (int i = 0; i < data->GetNumberOfArrays(); ++i) {
+        vtkDataArray* array = data->GetArray(i);
+        if (!array || array->GetDataTypeSize() == 0) {
+            std::cerr << "LaShellIO::WriteNative — skipping non-numeric array "
+                      << (data->GetAbstractArray(i)->GetName() ? data->GetAbstractArray(i)->GetName() : "")
+                      << std::endl;
+            continue;
+        }
+        Entry entry;
+        entry.section        = section;
+        entry.vtk_type       = array->GetDataType();
+        entry.num_components = array->GetNumberOfComponents();
+        entry.attribute      = attributes ? attributes->IsArrayAnAttribute(i) : -1;
+        entry.num_tuples     = array->GetNumberOfTuples();
+        entry.bytes          = static_cast<std::uint64_t>(entry.num_tuples) *
+                               entry.num_components * array->GetDataTypeSize();
+        entry.name           = array->GetName() ? array->GetName() : "";
+        entry.array          = array;
+        entries.push_back(entry);
+    }
+}
+
+} // namespace
+
+
+// ============================================================
+// Dispatch on extension
+// ============================================================
+
+bool LaShellIO::Read(const std::string& filename, vtkPolyData* mesh) {
+    const std::string ext = LaFileName::Extension(filename);
+    if (ext == NativeExtension) return ReadNative(filename, mesh);
+
+    if (!std::ifstream(filename).good()) {
+        std::cerr << "LaShellIO::Read — cannot open: " << filename << std::endl;
+        return false;
+    }
+
+    // The readers report a bad file through the error code, or by
+    // producing no points; mesh is only replaced by a good read.
+    vtkSmartPointer<vtkAlgorithm> reader;
+    if (ext == ".vtp") {
+        vtkSmartPointer<vtkXMLPolyDataReader> xml_reader =
+            vtkSmartPointer<vtkXMLPolyDataReader>::New();
+        xml_reader->SetFileName(filename.c_str());
+        reader = xml_reader;
+    } else {
+        vtkSmartPointer<vtkPolyDataReader> legacy_reader =
+            vtkSmartPointer<vtkPolyDataReader>::New();
+        legacy_reader->SetFileName(filename.c_str());
+        legacy_reader->ReadAllScalarsOn();
+        reader = legacy_reader;
+    }
+    reader->Update();
+
+    vtkPolyData* output = vtkPolyData::SafeDownCast(reader->GetOutputDataObject(0));
+    if (reader->GetErrorCode() != 0 || !output || output->GetNumberOfPoints() == 0) {
+        std::cerr << "LaShellIO::Read — not a readable polydata file: " << filename << std::endl;
+        return false;
+    }
+    mesh->ShallowCopy(output);
+    return true;
+}
+
+bool LaShellIO::Write(const std::string& filename, vtkPolyData* mesh,
+                      const WriteOptions& options) {
+    const std::string ext = LaFileName::Extension(filename);
+    if (ext == NativeExtension) return WriteNative(filename, mesh);
+
+    typedef WriteOptions::Encoding Encoding;
+
+    if (ext == ".vtp") {
+        vtkSmartPointer<vtkXMLPolyDataWriter> writer =
+            vtkSmartPointer<vtkXMLPolyDataWriter>::New();
+        writer->SetFileName(filename.c_str());
+        writer->SetInputData(mesh);
+        switch (options.encoding) {
+            case Encoding::Ascii:  writer->SetDataModeToAscii();  break;
+            case Encoding::Binary: writer->SetDataModeToBinary(); break;
+            default:
+                writer->SetDataModeToAppended();
+                writer->EncodeAppendedDataOff();        // raw bytes, no base64
+                break;
+        }
+        if (options.compress) writer->SetCompressorTypeToZLib();
+        else                  writer->SetCompressorTypeToNone();
+        return writer->Write() == 1;
+    }
+
+    vtkSmartPointer<vtkPolyDataWriter> writer = vtkSmartPointer<vtkPolyDataWriter>::New();
+    writer->SetFileName(filename.c_str());
+    writer->SetInputData(mesh);
+    if (options.encoding == Encoding::Binary || options.encoding == Encoding::Appended)
+        writer->SetFileTypeToBinary();
+    return writer->Write() == 1;
+}
+
+
+// ============================================================
+// Lassy mesh container
+// ============================================================
+
+bool LaShellIO::WriteNative(const std::string& filename, vtkPolyData* mesh) {
+    const std::string INFO = "LaShellIO::WriteNative — ";
+
+    std::vector<Entry> entries;
+
+    if (mesh->GetPoints()) {
+        vtkDataArray* points = mesh->GetPoints()->GetData();
+        Entry entry;
+        entry.section        = PointsSection;
+        entry.vtk_type       = points->GetDataType();
+        entry.num_components = 3;
+        entry.attribute      = -1;
+        entry.num_tuples     = points->GetNumberOfTuples();
+        entry.bytes          = static_cast<std::uint64_t>(entry.num_tuples) * 3 * points->GetDataTypeSize();
+        entry.array          = points;
+        entries.push_back(entry);
+    }
+
+    // int64 offsets/connectivity, the layout vtkCellArray maps back onto
+    vtkCellArray* blocks[4] = {mesh->GetVerts(), mesh->GetLines(), mesh->GetPolys(), mesh->GetStrips()};
+    vtkSmartPointer<vtkCellArray> wide[4];
+    for (int k = 0; k < 4; ++k) {
+        if (!blocks[k] || blocks[k]->GetNumberOfCells() == 0) continue;
+        wide[k] = blocks[k];
+        if (!blocks[k]->IsStorage64Bit()) {
+            wide[k] = vtkSmartPointer<vtkCellArray>::New();
+            wide[k]->DeepCopy(blocks[k]);
+            wide[k]->ConvertTo64BitStorage();
+        }
+        vtkDataArray* arrays[2] = {wide[k]->GetOffsetsArray64(), wide[k]->GetConnectivityArray64()};
+        for (int a = 0; a < 2; ++a) {
+            Entry entry;
+            entry.section        = (a == 0) ? CellOffsetsSection : CellConnectivitySection;
+            entry.vtk_type       = arrays[a]->GetDataType();
+            entry.num_components = 1;
+            entry.attribute      = k;
+            entry.num_tuples     = arrays[a]->GetNumberOfTuples();
+            entry.bytes          = static_cast<std::uint64_t>(entry.num_tuples) * sizeof(std::int64_t);
+            entry.array          = arrays[a];
+            entries.push_back(entry);
+        }
+    }
+
+    AddAttributeEntries(mesh->GetPointData(), PointDataSection, entries);
+    AddAttributeEntries(mesh->GetCellData(),  CellDataSection,  entries);
+    AddAttributeEntries(mesh->GetFieldData(), FieldDataSection, entries);
+
+    // ---- Lay out: table of contents, then aligned payloads -----------------
+    std::uint64_t toc_bytes = sizeof(kMagic) + 2 * sizeof(std::uint32_t);
+    for (const Entry& entry : entries)
+        toc_bytes += 4 * sizeof(std::uint32_t) + 3 * sizeof(std::uint64_t)
+                   + 2 * sizeof(std::uint32_t) + entry.name.size();
+
+    std::uint64_t position = AlignUp(toc_bytes);
+    for (Entry& entry : entries) {
+        entry.offset = position;
+        position = AlignUp(position + entry.bytes);
+    }
+
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << INFO << "cannot open: " << filename << std::endl;
+        return false;
+    }
+
+    out.write(kMagic, sizeof(kMagic));
+    WritePod(out, kByteOrderMark);
+    WritePod(out, static_cast<std::uint32_t>(entries.size()));
+    for (const Entry& entry : entries) {
+        WritePod(out, entry.section);
+        WritePod(out, entry.vtk_type);
+        WritePod(out, entry.num_components);
+        WritePod(out, entry.attribute);
+        WritePod(out, entry.num_tuples);
+        WritePod(out, entry.offset);
+        WritePod(out, entry.bytes);
+        WritePod(out, static_cast<std::uint32_t>(entry.name.size()));
+        WritePod(out, static_cast<std::uint32_t>(0));
+        out.write(entry.name.data(), static_cast<std::streamsize>(entry.name.size()));
+    }
+
+    const std::vector<char> padding(kPayloadAlignment, 0);
+    std::uint64_t written = toc_bytes;
+    for (const Entry& entry : entries) {
+        out.write(padding.data(), static_cast<std::streamsize>(entry.offset - written));
+        if (entry.bytes > 0)
+            out.write(static_cast<const char*>(entry.array->GetVoidPointer(0)),
+                      static_cast<std::streamsize>(entry.bytes));
+        written = entry.offset + entry.bytes;
+    }
+
+    if (!out) {
+        std::cerr << INFO << "write failed: " << filename << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool LaShellIO::ReadNative(const std::string& filename, vtkPolyData* mesh) {
+    const std::string INFO = "LaShellIO::ReadNative — ";
+
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        std::cerr << INFO << "cannot open: " << filename << std::endl;
+        return false;
+    }
+
+    char magic[sizeof(kMagic)];
+    std::uint32_t byte_order = 0, num_entries = 0;
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+        !ReadPod(in, byte_order) || !ReadPod(in, num_entries)) {
+        std::cerr << INFO << "not a lassy mesh: " << filename << std::endl;
+        return false;
+    }
+    if (byte_order != kByteOrderMark) {
+        std::cerr << INFO << "written with the other byte order: " << filename << std::endl;
+        return false;
+    }
+
+    // The table of contents is untrusted: counts and lengths are checked
+    // against the file size before anything is allocated for them.
+    const std::uint64_t toc_start = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(0, std::ios::end);
+    const std::uint64_t file_size = static_cast<std::uint64_t>(in.tellg());
+    in.seekg(static_cast<std::streamoff>(toc_start));
+
+    const std::uint64_t kEntryBytes = 48;           // fixed part of an entry
+    if (num_entries > (file_size - toc_start) / kEntryBytes) {
+        std::cerr << INFO << "corrupt table of contents: " << filename << std::endl;
+        return false;
+    }
+
+    std::vector<Entry> entries(num_entries);
+    for (Entry& entry : entries) {
+        std::uint32_t name_length = 0, reserved = 0;
+        bool ok = ReadPod(in, entry.section) && ReadPod(in, entry.vtk_type) &&
+                  ReadPod(in, entry.num_components) && ReadPod(in, entry.attribute) &&
+                  ReadPod(in, entry.num_tuples) && ReadPod(in, entry.offset) &&
+                  ReadPod(in, entry.bytes) && ReadPod(in, name_length) && ReadPod(in, reserved);
+        if (ok && name_length > file_size - static_cast<std::uint64_t>(in.tellg()))
+            ok = false;
+        if (ok) {
+            entry.name.resize(name_length);
+            ok = name_length == 0 || static_cast<bool>(in.read(&entry.name[0], name_length));
+        }
+        if (!ok || entry.num_components < 1 || entry.num_tuples < 0) {
+            std::cerr << INFO << "corrupt table of contents: " << filename << std::endl;
+            return false;
+        }
+    }
+
+    // payloads past the end of the file would fault when mapped
+    for (const Entry& entry : entries) {
+        if (entry.offset > file_size || entry.bytes > file_size - entry.offset) {
+            std::cerr << INFO << "truncated file: " << filename << std::endl;
+            return false;
+        }
+    }
+
+#if !defined(_WIN32)
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+#else
+    const int fd = -1;
+#endif
+
+    vtkSmartPointer<vtkPolyData> result = vtkSmartPointer<vtkPolyData>::New();
+    vtkSmartPointer<vtkTypeInt64Array> offsets[4], connectivity[4];
+    bool ok = true;
+
+    for (const Entry& entry : entries) {
+        const bool cell_section = entry.section == CellOffsetsSection ||
+                                  entry.section == CellConnectivitySection;
+        if (cell_section && (entry.attribute < 0 || entry.attribute > 3 ||
+                             entry.vtk_type != VTK_TYPE_INT64)) {
+            ok = false;
+            break;
+        }
+        if (!IsNumericType(entry.vtk_type) ||
+            (entry.section == PointsSection && entry.num_components != 3)) {
+            ok = false;
+            break;
+        }
+
+        vtkSmartPointer<vtkDataArray> array;
+        if (cell_section) array = vtkSmartPointer<vtkTypeInt64Array>::New();
+        else              array = vtkSmartPointer<vtkDataArray>::Take(vtkDataArray::CreateDataArray(entry.vtk_type));
+        if (!array) {
+            ok = false;
+            break;
+        }
+        array->SetNumberOfComponents(entry.num_components);
+        if (!entry.name.empty()) array->SetName(entry.name.c_str());
+        if (!LoadPayload(in, fd, entry, array)) {
+            ok = false;
+            break;
+        }
+
+        switch (entry.section) {
+            case PointsSection: {
+                vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+                points->SetData(array);
+                result->SetPoints(points);
+                break;
+            }
+            case CellOffsetsSection:
+                offsets[entry.attribute] = vtkTypeInt64Array::SafeDownCast(array);
+                break;
+            case CellConnectivitySection:
+                connectivity[entry.attribute] = vtkTypeInt64Array::SafeDownCast(array);
+                break;
+            case PointDataSection:
+            case CellDataSection: {
+                vtkDataSetAttributes* attributes = (entry.section == PointDataSection)
+                    ? static_cast<vtkDataSetAttributes*>(result->GetPointData())
+                    : static_cast<vtkDataSetAttributes*>(result->GetCellData());
+                const int index = attributes->AddArray(array);
+                if (entry.attribute >= 0 && entry.attribute < vtkDataSetAttributes::NUM_ATTRIBUTES)
+                    attributes->SetActiveAttribute(index, entry.attribute);
+                break;
+            }
+            case FieldDataSection:
+                result->GetFieldData()->AddArray(array);
+                break;
+            default:
+                std::cerr << INFO << "skipping unknown section " << entry.section << std::endl;
+                break;
+        }
+    }
+
+#if !defined(_WIN32)
+    if (fd >= 0) ::close(fd);        // mappings stay valid
+#endif
+
+    // ---- Cells: checked before any filter indexes through them -----------
+    for (int k = 0; ok && k < 4; ++k) {
+        if (!offsets[k] && !connectivity[k]) continue;
+        if (!offsets[k] || !connectivity[k] ||
+            !ValidCells(offsets[k], connectivity[k], result->GetNumberOfPoints())) {
+            ok = false;
+            break;
+        }
+        vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+        cells->SetData(offsets[k], connectivity[k]);
+        switch (k) {
+            case 0: result->SetVerts(cells);  break;
+            case 1: result->SetLines(cells);  break;
+            case 2: result->SetPolys(cells);  break;
+            case 3: result->SetStrips(cells); break;
+        }
+    }
+
+    if (!ok) {
+        std::cerr << INFO << "corrupt payload: " << filename << std::endl;
+        return false;
+    }
+
+    mesh->ShallowCopy(result);
+    return true;
+}
@@ -126,8 +126,7 @@ void LaShellPointsCSV::InitNeighbourPointListingContainer()
 
         _neighbour_point_set.resize(num_points);
 
-        vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-        _source_la->GetMesh3D(mesh);
+        vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
         int num_vertices = mesh->GetNumberOfPoints();
 
@@ -143,8 +142,7 @@ void LaShellPointsCSV::LocateNeighboursOfPoints()
 {
 
     double xyz[3], m_xyz[3];
-    vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(mesh);
+    vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
     InitNeighbourPointListingContainer();
 
@@ -179,8 +177,7 @@ void LaShellPointsCSV::LocatePoints() {
     double xyz[3];
     int closestPointID=-1;
 
-    vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(mesh);
+    vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
     vtkSmartPointer<vtkPointLocator> point_locator = vtkSmartPointer<vtkPointLocator>::New();
 	point_locator->SetDataSet(mesh);
@@ -211,8 +208,7 @@ void LaShellPointsCSV::LocatePoints() {
 
 void LaShellPointsCSV::InsertScalarData() {
 
-    vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(mesh);
+    vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
     vtkSmartPointer<vtkDoubleArray> new_scalar = vtkSmartPointer<vtkDoubleArray>::New();
     new_scalar->SetNumberOfComponents(1);
@@ -235,8 +231,8 @@ void LaShellPointsCSV::InsertScalarData() {
         mesh->GetFieldData()->AddArray(new_scalar);
     }
 
-    // a new mesh is created
-    _output_la->SetMesh3D(mesh);
+    // the output shares points and cells with the source, only the new array is extra
+    _output_la->AdoptMesh3D(mesh);
 
 }
 
@@ -270,8 +266,7 @@ void LaShellPointsCSV::Update()
 
     std::ofstream out;
     double xyz[3], xyz_t[3];
-    vtkSmartPointer<vtkPolyData> mesh = vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(mesh);
+    vtkSmartPointer<vtkPolyData> mesh = _source_la->GetMesh3DView();
 
     out.open("LaShellPointsCSV_output.csv");
     out << "XYZ read from CSV and closest XYZ_t found on input shell\n";
@@ -77,22 +77,21 @@ void LaShellShellArithmetic::Update() {
 
 	vtkSmartPointer<vtkPolyData> Output_Poly = vtkSmartPointer<vtkPolyData>::New();
 	
-	vtkSmartPointer<vtkPolyData> Source_Poly1 = vtkSmartPointer<vtkPolyData>::New();
-	vtkSmartPointer<vtkPolyData> Source_Poly2 = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Source_Poly1 = _source_la_1->GetMesh3DView();
+	vtkSmartPointer<vtkPolyData> Source_Poly2;
 	vtkSmartPointer<vtkFloatArray> Scalars_Poly1 = vtkSmartPointer<vtkFloatArray>::New();
 	vtkSmartPointer<vtkFloatArray> Scalars_Poly2 = vtkSmartPointer<vtkFloatArray>::New();
-	_source_la_1->GetMesh3D(Source_Poly1);
 
 
 	vtkSmartPointer<vtkFloatArray> Output_Poly_Scalar = vtkSmartPointer<vtkFloatArray>::New();
 	Output_Poly_Scalar->SetNumberOfComponents(1);
-	Output_Poly->DeepCopy(Source_Poly1);
+	Output_Poly->ShallowCopy(Source_Poly1);
 
 	Scalars_Poly1 = vtkFloatArray::SafeDownCast(Source_Poly1->GetPointData()->GetScalars()); 
 
 	if (!_single_shell) {
 		std::cout << "Two shells mode \n\n";
-		_source_la_2->GetMesh3D(Source_Poly2);
+		Source_Poly2 = _source_la_2->GetMesh3DView();
 		Scalars_Poly2 = vtkFloatArray::SafeDownCast(Source_Poly2->GetPointData()->GetScalars());
 	}
 	else {
@@ -138,7 +137,7 @@ void LaShellShellArithmetic::Update() {
 
 	Output_Poly->GetPointData()->SetScalars(Output_Poly_Scalar);
 
-	_output_la->SetMesh3D(Output_Poly);
+	_output_la->AdoptMesh3D(Output_Poly);
 }
 
 
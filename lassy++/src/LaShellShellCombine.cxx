@@ -55,8 +55,7 @@ int LaShellShellCombine::FindScalarArray(LaShell* shell, const char* array_name)
     
     vtkIdType numberOfPointArrays;
 
-    vtkSmartPointer<vtkPolyData> Source_Poly1 = vtkSmartPointer<vtkPolyData>::New();
-    shell->GetMesh3D(Source_Poly1);
+    vtkSmartPointer<vtkPolyData> Source_Poly1 = shell->GetMesh3DView();
 
     if (!_write_to_field_data)
         numberOfPointArrays = Source_Poly1->GetPointData()->GetNumberOfArrays();
@@ -132,14 +131,14 @@ void LaShellShellCombine::Update()
 
 	vtkSmartPointer<vtkPolyData> Output_Poly = vtkSmartPointer<vtkPolyData>::New();
 	
-	vtkSmartPointer<vtkPolyData> Source_Poly1 = vtkSmartPointer<vtkPolyData>::New();
-	vtkSmartPointer<vtkPolyData> Source_Poly2 = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Source_Poly1;
+	vtkSmartPointer<vtkPolyData> Source_Poly2;
 	
     vtkSmartPointer<vtkDoubleArray> Scalars_Poly1 = vtkSmartPointer<vtkDoubleArray>::New();
 	vtkSmartPointer<vtkDoubleArray> Scalars_Poly2 = vtkSmartPointer<vtkDoubleArray>::New();
 	
-    _source_la_1->GetMesh3D(Source_Poly1);
-    _source_la_2->GetMesh3D(Source_Poly2);
+    Source_Poly1 = _source_la_1->GetMesh3DView();
+    Source_Poly2 = _source_la_2->GetMesh3DView();
 
     if (!_write_to_field_data) {
 	    Scalars_Poly1 = vtkDoubleArray::SafeDownCast(Source_Poly1->GetPointData()->GetArray(_scalar_array_location_in_source1));
@@ -190,7 +189,7 @@ std::cout << "Array size = something else" << Scalars_Poly1->GetNumberOfComponen
         
     }
 
-    Output_Poly->DeepCopy(Source_Poly1);
+    Output_Poly->ShallowCopy(Source_Poly1);
 
     if (!_write_to_field_data) {
        // Output_Poly->GetPointData()->SetScalars(Output_Poly_Scalar);
@@ -200,5 +199,5 @@ std::cout << "Array size = something else" << Scalars_Poly1->GetNumberOfComponen
         Output_Poly->GetFieldData()->AddArray(Output_Poly_Scalar);
     }
 
-    _output_la->SetMesh3D(Output_Poly);
+    _output_la->AdoptMesh3D(Output_Poly);
 }
\ No newline at end of file
@@ -182,8 +182,7 @@ void LaShellShellDisplacement::ReadShellComputeDisplacement(std::string poly_dat
 void LaShellShellDisplacement::AggregateAllDisplacements()
 {
 	
-	vtkSmartPointer<vtkPolyData> shell_poly = vtkSmartPointer<vtkPolyData>::New();
-	_source_la->GetMesh3D(shell_poly); 
+	vtkSmartPointer<vtkPolyData> shell_poly = _source_la->GetMesh3DView();
 	
 	std::cout << "Aggregating displacements .. " << std::endl;
 
@@ -195,7 +194,7 @@ void LaShellShellDisplacement::AggregateAllDisplacements()
 
 	// prepare output 
 	vtkSmartPointer<vtkPolyData> OutputPoly = vtkSmartPointer<vtkPolyData>::New();
-	OutputPoly->DeepCopy(shell_poly);
+	OutputPoly->ShallowCopy(shell_poly);
 
 	vtkSmartPointer<vtkFloatArray> output_scalars = vtkSmartPointer<vtkFloatArray>::New();
 	output_scalars->SetNumberOfComponents(1);
@@ -222,7 +221,7 @@ void LaShellShellDisplacement::AggregateAllDisplacements()
 
 	OutputPoly->GetPointData()->SetScalars(output_scalars);
 
-	_output_la->SetMesh3D(OutputPoly);
+	_output_la->AdoptMesh3D(OutputPoly);
 }
 
 
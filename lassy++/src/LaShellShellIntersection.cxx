@@ -90,13 +90,13 @@ void LaShellShellIntersection::Update()
 		outputWindow->SetInstance(fileOutputWindow);
 	}
 
-	vtkSmartPointer<vtkPolyData> Source_Poly = vtkSmartPointer<vtkPolyData>::New(); 
-	vtkSmartPointer<vtkPolyData> Target_Poly = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Source_Poly; 
+	vtkSmartPointer<vtkPolyData> Target_Poly;
 	vtkSmartPointer<vtkPolyData> Output_Poly = vtkSmartPointer<vtkPolyData>::New();
 
 
-	_source_la->GetMesh3D(Source_Poly);
-	_target_la->GetMesh3D(Target_Poly);
+	Source_Poly = _source_la->GetMesh3DView();
+	Target_Poly = _target_la->GetMesh3DView();
 
 	// See https://www.vtk.org/Wiki/VTK/Examples/Cxx/DataStructures/ModifiedBSPTree_IntersectWithLine
 	// Create the tree
@@ -123,7 +123,7 @@ void LaShellShellIntersection::Update()
 	Source_Poly_Normals->Update();
 
 	
-	Output_Poly->DeepCopy(Source_Poly);
+	Output_Poly->ShallowCopy(Source_Poly);
 
 	
 	vtkSmartPointer<vtkFloatArray> Source_pNormals = vtkFloatArray::SafeDownCast(Source_Poly->GetPointData()->GetNormals());
@@ -180,7 +180,7 @@ void LaShellShellIntersection::Update()
 		//_mesh_vertex_values.push_back(this_scalar);
 		Output_Poly->GetPointData()->SetScalars(Output_Poly_Scalar);
 
-		_output_la->SetMesh3D(Output_Poly);	
+		_output_la->AdoptMesh3D(Output_Poly);	
 		
 	}
 	
@@ -56,14 +56,14 @@ void LaShellShellIntersectionMultiArray::SetCopyScalarsUsingPointid()
 void LaShellShellIntersectionMultiArray::Update()
 {
 	double pStart[3];
-	vtkSmartPointer<vtkPolyData> Source_Poly = vtkSmartPointer<vtkPolyData>::New(); 
-	vtkSmartPointer<vtkPolyData> Target_Poly = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Source_Poly; 
+	vtkSmartPointer<vtkPolyData> Target_Poly;
 	vtkSmartPointer<vtkPolyData> Output_Poly = vtkSmartPointer<vtkPolyData>::New();
 
-	_source_la->GetMesh3D(Source_Poly);
-	_target_la->GetMesh3D(Target_Poly);
+	Source_Poly = _source_la->GetMesh3DView();
+	Target_Poly = _target_la->GetMesh3DView();
 
-	Output_Poly->DeepCopy(Target_Poly);
+	Output_Poly->ShallowCopy(Target_Poly);
 	
     int numberOfPointArraysInSource = Source_Poly->GetPointData()->GetNumberOfArrays();
     std::cout << "Total arrays to transfer from target to source = " << numberOfPointArraysInSource << std::endl;
@@ -183,7 +183,7 @@ void LaShellShellIntersectionMultiArray::Update()
         
     }
     
-    _output_la->SetMesh3D(Output_Poly);	
+    _output_la->AdoptMesh3D(Output_Poly);	
 	
 }
 
@@ -55,11 +55,9 @@ void LaShellStatistics::Update() {
 	}
     std::vector<double> value_container; 
 
-	vtkSmartPointer<vtkPolyData> Source_Poly1 = vtkSmartPointer<vtkPolyData>::New();
+	vtkSmartPointer<vtkPolyData> Source_Poly1 = _source_la->GetMesh3DView();
 	vtkSmartPointer<vtkFloatArray> Scalars_Poly1 = vtkSmartPointer<vtkFloatArray>::New();
 	
-	_source_la->GetMesh3D(Source_Poly1);
-	
 	Scalars_Poly1 = vtkFloatArray::SafeDownCast(Source_Poly1->GetPointData()->GetScalars()); 
 
 	for (vtkIdType i = 0; i < Source_Poly1->GetNumberOfPoints(); ++i) {
@@ -22,6 +22,7 @@ LaShellSyntheticScar::LaShellSyntheticScar() {
     _source_la         = new LaShell();
     _output_la         = std::make_unique<LaShell>();
     _source_poly       = vtkSmartPointer<vtkPolyData>::New();
+    _graph             = std::make_unique<LaVolumeGraphTraversal>();
     _neighbourhood_size = 3;
     _sigma             = -1.0;   // sentinel: recompute from neighbourhood_size
     _falloff           = FalloffKernel::Gaussian;
@@ -38,7 +39,7 @@ LaShellSyntheticScar::~LaShellSyntheticScar() {
 
 void LaShellSyntheticScar::SetInputData(LaShell* shell) {
     _source_la = shell;
-    _source_la->GetMesh3D(_source_poly);
+    _source_poly = _source_la->GetMesh3DView();
 }
 
 void LaShellSyntheticScar::SetPointIDList(const std::vector<int>& ids) {
@@ -81,9 +82,7 @@ void LaShellSyntheticScar::ReadPointCoordinatesFile(const char* filename) {
     }
     
     // Build point locator on source mesh
-    vtkSmartPointer<vtkPolyData> source_poly =
-        vtkSmartPointer<vtkPolyData>::New();
-    _source_la->GetMesh3D(source_poly);
+    vtkSmartPointer<vtkPolyData> source_poly = _source_la->GetMesh3DView();
     
     vtkSmartPointer<vtkPointLocator> locator =
         vtkSmartPointer<vtkPointLocator>::New();
@@ -156,62 +155,6 @@ void LaShellSyntheticScar::SetOutputArrayName(const char* name) {
 // Private helpers
 // ============================================================
 
-void LaShellSyntheticScar::GetConnectedVertices(
-    vtkSmartPointer<vtkPolyData> mesh,
-    int seed,
-    vtkSmartPointer<vtkIdList> connected_vertices) {
-
-    vtkSmartPointer<vtkIdList> cell_id_list = vtkSmartPointer<vtkIdList>::New();
-    mesh->GetPointCells(seed, cell_id_list);
-
-    for (vtkIdType i = 0; i < cell_id_list->GetNumberOfIds(); ++i) {
-        vtkCell* cell = mesh->GetCell(cell_id_list->GetId(i));
-        if (cell->GetNumberOfEdges() <= 0) continue;
-
-        for (vtkIdType e = 0; e < cell->GetNumberOfEdges(); ++e) {
-            vtkCell* edge = cell->GetEdge(e);
-            vtkIdList* point_id_list = edge->GetPointIds();
-
-            if (point_id_list->GetId(0) == seed) {
-                connected_vertices->InsertNextId(point_id_list->GetId(1));
-            } else if (point_id_list->GetId(1) == seed) {
-                connected_vertices->InsertNextId(point_id_list->GetId(0));
-            }
-        }
-    }
-}
-
-void LaShellSyntheticScar::RecursivePointNeighbours(vtkIdType point_id,
-                                                     int order) {
-    if (order == 0) return;
-
-    // Check if already visited
-    for (const auto& visited : _visited_point_list) {
-        if (visited.first == point_id) return;
-    }
-    _visited_point_list.push_back({point_id, order});
-
-    vtkSmartPointer<vtkIdList> point_list = vtkSmartPointer<vtkIdList>::New();
-    GetConnectedVertices(_source_poly, static_cast<int>(point_id), point_list);
-
-    for (vtkIdType e = 0; e < point_list->GetNumberOfIds(); ++e) {
-        RecursivePointNeighbours(point_list->GetId(e), order - 1);
-    }
-}
-
-void LaShellSyntheticScar::GetNeighboursAroundPoint(
-    int point_id,
-    std::vector<std::pair<int, int>>& neighbours) {
-
-    _visited_point_list.clear();
-    RecursivePointNeighbours(static_cast<vtkIdType>(point_id),
-                             _neighbourhood_size);
-
-    for (const auto& v : _visited_point_list) {
-        neighbours.push_back({static_cast<int>(v.first), v.second});
-    }
-}
-
 std::vector<vtkIdType> LaShellSyntheticScar::BuildPathVertices() {
     // Use a map for O(log n) deduplication while preserving determinism
     map<vtkIdType, int> vertex_ids;
@@ -245,32 +188,6 @@ std::vector<vtkIdType> LaShellSyntheticScar::BuildPathVertices() {
     return result;
 }
 
-double LaShellSyntheticScar::Euclidean(const double* a, const double* b) {
-    const double dx = a[0] - b[0];
-    const double dy = a[1] - b[1];
-    const double dz = a[2] - b[2];
-    return sqrt(dx*dx + dy*dy + dz*dz);
-}
-
-double LaShellSyntheticScar::EvaluateFalloff(double d, double max_d) const {
-    if (max_d <= 0.0) return 1.0;
-
-    switch (_falloff) {
-        case FalloffKernel::Gaussian: {
-            // Use effective_sigma: either user-set or derived from max_d
-            // so that at d == max_d the weight is exp(-0.5 * (max_d/sigma)^2)
-            // With sigma = max_d / 2, that gives exp(-2) ≈ 0.135 at the edge —
-            // a smooth, non-zero tail that avoids a hard cutoff.
-            const double effective_sigma = (_sigma > 0.0) ? _sigma : (max_d / 2.0);
-            return exp(-(d * d) / (2.0 * effective_sigma * effective_sigma));
-        }
-        case FalloffKernel::Linear: {
-            return max(0.0, 1.0 - (d / max_d));
-        }
-    }
-    return 0.0;  // unreachable, satisfies compiler
-}
-
 std::string LaShellSyntheticScar::UniqueArrayName(vtkPolyData* poly,
                                                    const std::string& candidate) {
     const int num_arrays = poly->GetPointData()->GetNumberOfArrays();
@@ -318,101 +235,147 @@ void LaShellSyntheticScar::Update() {
     // ---- Step 1: build path vertices ----------------------------------
     const std::vector<vtkIdType> path_vertices = BuildPathVertices();
 
-    // ---- Step 2: accumulate scalar contributions ----------------------
-    // accumulator[i] holds the sum of falloff contributions at vertex i.
-    // Initialised to 0.0; left at 0 for vertices outside the corridor.
-    std::vector<double> accumulator(static_cast<size_t>(num_points), 0.0);
-
-    // Estimate max_d as the mean edge length × neighbourhood_size.
-    // This gives a world-space radius consistent with the hop count.
-    // Computed once from a sample of edges to avoid a full traversal.
-    double sample_edge_length = 0.0;
-    {
-        const int sample_count = min(static_cast<int>(num_points), 200);
-        int sampled = 0;
-        for (int i = 0; i < sample_count; ++i) {
-            vtkSmartPointer<vtkIdList> neighbours =
-                vtkSmartPointer<vtkIdList>::New();
-            GetConnectedVertices(_source_poly, i, neighbours);
-            if (neighbours->GetNumberOfIds() == 0) continue;
-            double p[3], q[3];
-            _source_poly->GetPoint(i, p);
-            _source_poly->GetPoint(neighbours->GetId(0), q);
-            sample_edge_length += Euclidean(p, q);
-            ++sampled;
-        }
-        if (sampled > 0) sample_edge_length /= sampled;
-        else             sample_edge_length  = 1.0;  // fallback, avoid /0
-    }
-    const double max_d = sample_edge_length * _neighbourhood_size;
-
-    cout << "Estimated mean edge length: " << sample_edge_length
-         << ", corridor radius (max_d): " << max_d << endl;
-
-    // For each path vertex, expand its neighbourhood and accumulate
-    for (const vtkIdType path_vtx : path_vertices) {
-        double path_point[3];
-        _source_poly->GetPoint(path_vtx, path_point);
-
-        // Accumulate the path vertex itself
-        accumulator[static_cast<size_t>(path_vtx)] +=
-            EvaluateFalloff(0.0, max_d);
+    // ---- Step 2: distance-to-path field ------------------------------
+    // Adjacency index for neighbourhood expansion — built once, then
+    // queried read-only from every thread
+    _graph->SetInputGrid(_source_poly);
+    _graph->SetEdgeWeightToTopological();
+    _graph->Build();
 
-        // Expand N-order neighbourhood
-        std::vector<std::pair<int, int>> neighbours;
-        GetNeighboursAroundPoint(static_cast<int>(path_vtx), neighbours);
+    // max_d = mean edge length × neighbourhood_size, a world-space
+    // radius consistent with the hop count.
+    const double mean_edge = _graph->GetEdgeStatistics().mean;
+    const double max_d = mean_edge * _neighbourhood_size;
 
-        for (const auto& [neighbour_id, depth] : neighbours) {
-            if (neighbour_id < 0 ||
-                neighbour_id >= static_cast<int>(num_points)) continue;
-
-            double neighbour_point[3];
-            _source_poly->GetPoint(neighbour_id, neighbour_point);
-            const double dist = Euclidean(path_point, neighbour_point);
-
-            accumulator[static_cast<size_t>(neighbour_id)] +=
-                EvaluateFalloff(dist, max_d);
-        }
-    }
+    cout << "Mean edge length: " << mean_edge
+         << ", corridor radius (max_d): " << max_d << endl;
 
-    // ---- Step 3: normalise to [0, 1] ----------------------------------
-    const double max_acc =
-        *max_element(accumulator.begin(), accumulator.end());
+    LaSyntheticScarField field;
+    field.Build(*_graph, _source_poly, path_vertices, _neighbourhood_size);
 
-    if (max_acc <= 0.0) {
-        cerr << "LaShellSyntheticScar::Update — all accumulator values are "
-                "zero. Check seed IDs and neighbourhood size." << endl;
-        return;
-    }
+    // ---- Step 3: accumulate scalar contributions ----------------------
+    // accumulator[i] holds the sum of falloff contributions at vertex i,
+    // 0 for vertices outside the corridor.
+    std::vector<double> accumulator;
+    field.Accumulate(static_cast<int>(_falloff), _neighbourhood_size,
+                     max_d, _sigma, accumulator);
 
-    // ---- Step 4: write scalar array to a copy of the source mesh ------
+    // ---- Step 4: write normalised array to a view of the source mesh --
     vtkSmartPointer<vtkPolyData> output_poly =
         vtkSmartPointer<vtkPolyData>::New();
-    output_poly->DeepCopy(_source_poly);
+    output_poly->ShallowCopy(_source_poly);
 
     const std::string array_name =
         UniqueArrayName(output_poly, _output_array_name);
-    cout << "Writing scalar array: " << array_name << endl;
 
     vtkSmartPointer<vtkFloatArray> scar_scalars =
-        vtkSmartPointer<vtkFloatArray>::New();
-    scar_scalars->SetName(array_name.c_str());
-    scar_scalars->SetNumberOfComponents(1);
-
-    for (vtkIdType i = 0; i < num_points; ++i) {
-        const float normalised =
-            static_cast<float>(accumulator[static_cast<size_t>(i)] / max_acc);
-        scar_scalars->InsertNextValue(normalised);
+        LaSyntheticScarField::NormalisedArray(accumulator, array_name);
+    if (!scar_scalars) {
+        cerr << "LaShellSyntheticScar::Update — all accumulator values are "
+                "zero. Check seed IDs and neighbourhood size." << endl;
+        return;
     }
+    cout << "Writing scalar array: " << array_name << endl;
 
     output_poly->GetPointData()->AddArray(scar_scalars);
-    _output_la->SetMesh3D(output_poly);
+    _output_la->AdoptMesh3D(output_poly);
 
     cout << "LaShellSyntheticScar::Update complete. "
          << "Array \"" << array_name << "\" added to output mesh." << endl;
 }
 
 
+// ============================================================
+// UpdateSweep — one traversal, many kernels
+// ============================================================
+
+void LaShellSyntheticScar::UpdateSweep(const std::vector<int>& neighbourhood_sizes,
+                                       const std::vector<int>& falloffs,
+                                       const std::vector<double>& sigmas) {
+    _sweep_variants.clear();
+
+    if (_seed_point_ids.size() < 2) {
+        cerr << "LaShellSyntheticScar::UpdateSweep — at least 2 seed point IDs "
+                "required. Aborting." << endl;
+        return;
+    }
+    if (_source_poly->GetNumberOfPoints() == 0) {
+        cerr << "LaShellSyntheticScar::UpdateSweep — source mesh has no points. "
+                "Was SetInputData called?" << endl;
+        return;
+    }
+    if (neighbourhood_sizes.empty() || falloffs.empty()) {
+        cerr << "LaShellSyntheticScar::UpdateSweep — empty neighbourhood or "
+                "falloff list. Aborting." << endl;
+        return;
+    }
+
+    // ---- Shared work, done once ---------------------------------------
+    const std::vector<vtkIdType> path_vertices = BuildPathVertices();
+    const int max_hops =
+        *max_element(neighbourhood_sizes.begin(), neighbourhood_sizes.end());
+
+    _graph->SetInputGrid(_source_poly);
+    _graph->SetEdgeWeightToTopological();
+    _graph->Build();
+
+    const double mean_edge = _graph->GetEdgeStatistics().mean;
+    cout << "Mean edge length: " << mean_edge << endl;
+
+    LaSyntheticScarField field;
+    field.Build(*_graph, _source_poly, path_vertices, max_hops);
+
+    // ---- Evaluate every combination from the cached field -------------
+    vtkSmartPointer<vtkPolyData> output_poly =
+        vtkSmartPointer<vtkPolyData>::New();
+    output_poly->ShallowCopy(_source_poly);
+
+    const std::vector<double> gaussian_sigmas =
+        sigmas.empty() ? std::vector<double>{_sigma} : sigmas;
+    const std::vector<double> linear_sigmas = {-1.0};   // sigma unused
+
+    std::vector<double> accumulator;
+    for (const int n : neighbourhood_sizes) {
+        const double max_d = mean_edge * n;
+
+        for (const int falloff : falloffs) {
+            const std::vector<double>& falloff_sigmas =
+                (falloff == static_cast<int>(FalloffKernel::Linear))
+                    ? linear_sigmas : gaussian_sigmas;
+
+            for (const double sigma : falloff_sigmas) {
+                field.Accumulate(falloff, n, max_d, sigma, accumulator);
+
+                const std::string array_name = UniqueArrayName(output_poly,
+                    LaSyntheticScarField::VariantName(_output_array_name, n, falloff, sigma));
+
+                vtkSmartPointer<vtkFloatArray> scar_scalars =
+                    LaSyntheticScarField::NormalisedArray(accumulator, array_name);
+                if (!scar_scalars) {
+                    cerr << "LaShellSyntheticScar::UpdateSweep — " << array_name
+                         << " is zero everywhere, skipped." << endl;
+                    continue;
+                }
+
+                output_poly->GetPointData()->AddArray(scar_scalars);
+                _sweep_variants.push_back({n, falloff, sigma, array_name});
+                cout << "Writing scalar array: " << array_name << endl;
+            }
+        }
+    }
+
+    _output_la->AdoptMesh3D(output_poly);
+
+    cout << "LaShellSyntheticScar::UpdateSweep complete. "
+         << _sweep_variants.size() << " arrays added to output mesh." << endl;
+}
+
+const std::vector<LaSyntheticScarField::Variant>&
+LaShellSyntheticScar::GetSweepVariants() const {
+    return _sweep_variants;
+}
+
+
 // ============================================================
 // GetOutput
 // ============================================================
@@ -0,0 +1,341 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+#include <vtkSMPTools.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkPointData.h>
+
+#include "../include/LaSyntheticScarField.h"
+#include "../include/LaShellSyntheticScar.h"
+#include "../include/LaVolumeSyntheticScar.h"
+#include "../include/LaFileName.h"
+
+
+// ============================================================
+// Kernel transforms
+// ============================================================
+
+namespace {
+
+// falloff is passed as an int so the field serves both filters; their kernel ids agree
+static_assert(static_cast<int>(FalloffKernel::Gaussian) == static_cast<int>(VolumeFalloffKernel::Gaussian) &&
+              static_cast<int>(FalloffKernel::Linear) == static_cast<int>(VolumeFalloffKernel::Linear),
+              "FalloffKernel and VolumeFalloffKernel must use the same values");
+
+struct KernelParameters {
+    float inv_max_d;
+    float inv_two_sigma_sq;
+};
+
+/*
+ * distance -> weight over a contiguous range.  Kept as plain branch-free
+ * float loops so they compile to SIMD code (see CMakeLists.txt).  A new
+ * kernel is a new transform plus a case in SelectTransform().
+ */
+typedef void (*KernelTransform)(const float* __restrict distances,
+                                float* __restrict weights,
+                                size_t count,
+                                const KernelParameters& params);
+
+void GaussianTransform(const float* __restrict distances,
+                       float* __restrict weights,
+                       size_t count,
+                       const KernelParameters& params) {
+    const float k = params.inv_two_sigma_sq;
+    for (size_t i = 0; i < count; ++i)
+        weights[i] = std::exp(-(distances[i] * distances[i]) * k);
+}
+
+void LinearTransform(const float* __restrict distances,
+                     float* __restrict weights,
+                     size_t count,
+                     const KernelParameters& params) {
+    const float k = params.inv_max_d;
+    for (size_t i = 0; i < count; ++i)
+        weights[i] = std::max(0.0f, 1.0f - distances[i] * k);
+}
+
+// max_d <= 0: every contribution counts fully
+void ConstantTransform(const float* __restrict,
+                       float* __restrict weights,
+                       size_t count,
+                       const KernelParameters&) {
+    for (size_t i = 0; i < count; ++i) weights[i] = 1.0f;
+}
+
+KernelTransform SelectTransform(int falloff, double max_d) {
+    if (max_d <= 0.0) return ConstantTransform;
+    switch (static_cast<FalloffKernel>(falloff)) {
+        case FalloffKernel::Linear:   return LinearTransform;
+        case FalloffKernel::Gaussian:
+        default:                      return GaussianTransform;
+    }
+}
+
+} // namespace
+
+
+// ============================================================
+// Constructor
+// ============================================================
+
+LaSyntheticScarField::LaSyntheticScarField() :
+    _num_points(0),
+    _max_hops(0) {}
+
+
+// ============================================================
+// Build
+// ============================================================
+
+void LaSyntheticScarField::Build(const LaVolumeGraphTraversal& graph,
+                                 vtkDataSet* points,
+                                 const std::vector<vtkIdType>& path_vertices,
+                                 int max_hops,
+                                 bool geodesic) {
+    _num_points = points->GetNumberOfPoints();
+    _max_hops   = max_hops;
+
+    struct Entry {
+        vtkIdType      node;
+        float          distance;
+        unsigned short hop;
+    };
+
+    // ---- Expand every path vertex, one entry list per thread ----------
+    vtkSMPThreadLocal<std::vector<Entry>> thread_entries;
+
+    vtkSMPTools::For(0, static_cast<vtkIdType>(path_vertices.size()),
+        [&](vtkIdType begin, vtkIdType end) {
+            std::vector<Entry>& local = thread_entries.Local();
+            std::vector<std::pair<vtkIdType, int>> neighbours;
+            std::vector<float> geodesic_distance;
+
+            for (vtkIdType p = begin; p < end; ++p) {
+                const vtkIdType path_vtx = path_vertices[static_cast<size_t>(p)];
+
+                double path_point[3];
+                points->GetPoint(path_vtx, path_point);
+
+                // The path vertex contributes to itself once on top of its
+                // own depth-0 BFS entry, as the per-pair accumulation does.
+                local.push_back({path_vtx, 0.0f, 0});
+
+                if (geodesic)
+                    graph.GetNeighboursAroundPoint(path_vtx, max_hops, neighbours, geodesic_distance);
+                else
+                    graph.GetNeighboursAroundPoint(path_vtx, max_hops, neighbours);
+
+                for (size_t i = 0; i < neighbours.size(); ++i) {
+                    const vtkIdType neighbour_id = neighbours[i].first;
+                    if (neighbour_id < 0 || neighbour_id >= _num_points) continue;
+
+                    float distance;
+                    if (geodesic) {
+                        distance = geodesic_distance[i];
+                    } else {
+                        double neighbour_point[3];
+                        points->GetPoint(neighbour_id, neighbour_point);
+                        distance = static_cast<float>(
+                            LaVolumeGraphTraversal::Euclidean(path_point, neighbour_point));
+                    }
+                    local.push_back({neighbour_id, distance,
+                        static_cast<unsigned short>(neighbours[i].second)});
+                }
+            }
+        });
+
+    // ---- Scatter into CSR by receiving node ---------------------------
+    _offsets.assign(static_cast<size_t>(_num_points) + 1, 0);
+    for (auto it = thread_entries.begin(); it != thread_entries.end(); ++it) {
+        for (const Entry& e : *it) ++_offsets[static_cast<size_t>(e.node) + 1];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+    const size_t total = _offsets.back();
+    _hops.resize(total);
+    _distances.resize(total);
+
+    std::vector<size_t> cursor(_offsets.begin(), _offsets.end() - 1);
+    for (auto it = thread_entries.begin(); it != thread_entries.end(); ++it) {
+        for (const Entry& e : *it) {
+            const size_t k = cursor[static_cast<size_t>(e.node)]++;
+            _hops[k]      = e.hop;
+            _distances[k] = e.distance;
+        }
+    }
+
+    // ---- Sort each node's entries by (hop, distance) ------------------
+    // Smaller neighbourhoods become prefixes, and sums no longer depend
+    // on which thread produced an entry.  The nearest path distance is
+    // taken on the way.
+    _nearest.assign(static_cast<size_t>(_num_points), -1.0f);
+
+    vtkSMPTools::For(0, _num_points, [&](vtkIdType begin, vtkIdType end) {
+        std::vector<std::pair<unsigned short, float>> scratch;
+        for (vtkIdType v = begin; v < end; ++v) {
+            const size_t first = _offsets[static_cast<size_t>(v)];
+            const size_t last  = _offsets[static_cast<size_t>(v) + 1];
+            if (first == last) continue;
+
+            scratch.clear();
+            float nearest = _distances[first];
+            for (size_t k = first; k < last; ++k) {
+                scratch.push_back({_hops[k], _distances[k]});
+                nearest = std::min(nearest, _distances[k]);
+            }
+            _nearest[static_cast<size_t>(v)] = nearest;
+
+            std::sort(scratch.begin(), scratch.end());
+            for (size_t k = first; k < last; ++k) {
+                _hops[k]      = scratch[k - first].first;
+                _distances[k] = scratch[k - first].second;
+            }
+        }
+    });
+
+    std::cout << "LaSyntheticScarField::Build complete — "
+              << path_vertices.size() << " path nodes, " << total
+              << " cached contributions within " << max_hops << " hops"
+              << (geodesic ? " (geodesic distances)." : ".") << std::endl;
+}
+
+
+// ============================================================
+// Accumulate
+// ============================================================
+
+void LaSyntheticScarField::Accumulate(int falloff,
+                                      int hops,
+                                      double max_d,
+                                      double sigma,
+                                      std::vector<double>& accumulator) const {
+    accumulator.assign(static_cast<size_t>(_num_points), 0.0);
+
+    if (hops > _max_hops) {
+        std::cerr << "LaSyntheticScarField::Accumulate — field was built for "
+                  << _max_hops << " hops, clamping " << hops << "." << std::endl;
+        hops = _max_hops;
+    }
+
+    // With sigma = max_d / 2 the Gaussian weight at d == max_d is
+    // exp(-2) ≈ 0.135 — a smooth, non-zero tail that avoids a hard cutoff.
+    const double effective_sigma = (sigma > 0.0) ? sigma : (max_d / 2.0);
+
+    KernelParameters params;
+    params.inv_max_d        = (max_d > 0.0) ? static_cast<float>(1.0 / max_d) : 0.0f;
+    params.inv_two_sigma_sq = static_cast<float>(
+        1.0 / (2.0 * effective_sigma * effective_sigma));
+
+    const KernelTransform transform = SelectTransform(falloff, max_d);
+    const unsigned short  hop_limit = static_cast<unsigned short>(std::max(hops, 0));
+
+    vtkSMPThreadLocal<std::vector<float>> thread_weights;
+
+    vtkSMPTools::For(0, _num_points, [&](vtkIdType begin, vtkIdType end) {
+        // Entries of nodes [begin, end) are contiguous — transform them in
+        // one pass, then sum each node's prefix within hop_limit.
+        const size_t chunk_first = _offsets[static_cast<size_t>(begin)];
+        const size_t chunk_last  = _offsets[static_cast<size_t>(end)];
+
+        std::vector<float>& weights = thread_weights.Local();
+        weights.resize(chunk_last - chunk_first);
+        transform(_distances.data() + chunk_first, weights.data(),
+                  chunk_last - chunk_first, params);
+
+        for (vtkIdType v = begin; v < end; ++v) {
+            const size_t first = _offsets[static_cast<size_t>(v)];
+            const size_t last  = _offsets[static_cast<size_t>(v) + 1];
+
+            double sum = 0.0;
+            for (size_t k = first; k < last && _hops[k] <= hop_limit; ++k)
+                sum += weights[k - chunk_first];
+            accumulator[static_cast<size_t>(v)] = sum;
+        }
+    });
+}
+
+
+// ============================================================
+// Metadata + static utilities
+// ============================================================
+
+const std::vector<float>& LaSyntheticScarField::GetNearestPathDistance() const {
+    return _nearest;
+}
+
+vtkIdType LaSyntheticScarField::GetNumberOfPoints() const {
+    return _num_points;
+}
+
+size_t LaSyntheticScarField::GetNumberOfEntries() const {
+    return _distances.size();
+}
+
+int LaSyntheticScarField::GetMaxHops() const {
+    return _max_hops;
+}
+
+std::string LaSyntheticScarField::VariantName(const std::string& base,
+                                              int neighbourhood_size,
+                                              int falloff,
+                                              double sigma) {
+    std::ostringstream ss;
+    ss << base << "_n" << neighbourhood_size << "_f" << falloff;
+    if (falloff != static_cast<int>(FalloffKernel::Linear)) {
+        if (sigma > 0.0) ss << "_s" << sigma;
+        else             ss << "_sauto";
+    }
+    return ss.str();
+}
+
+vtkSmartPointer<vtkFloatArray> LaSyntheticScarField::NormalisedArray(
+    const std::vector<double>& accumulator,
+    const std::string& name) {
+
+    if (accumulator.empty()) return nullptr;
+
+    const double max_acc =
+        *std::max_element(accumulator.begin(), accumulator.end());
+    if (max_acc <= 0.0) return nullptr;
+
+    vtkSmartPointer<vtkFloatArray> scalars =
+        vtkSmartPointer<vtkFloatArray>::New();
+    scalars->SetName(name.c_str());
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(static_cast<vtkIdType>(accumulator.size()));
+
+    for (size_t i = 0; i < accumulator.size(); ++i) {
+        scalars->SetValue(static_cast<vtkIdType>(i),
+                          static_cast<float>(accumulator[i] / max_acc));
+    }
+    return scalars;
+}
+
+void LaSyntheticScarField::SplitVariants(
+    vtkDataSet* data,
+    const std::vector<Variant>& variants,
+    const std::string& filename,
+    const std::function<void(vtkDataSet*, const std::string&)>& write) {
+
+    const std::string stem = LaFileName::Stem(filename);
+    std::string ext = LaFileName::Extension(filename);
+    if (ext.empty()) ext = ".vtk";
+
+    for (const Variant& v : variants) {
+        vtkSmartPointer<vtkDataSet> variant_data =
+            vtkSmartPointer<vtkDataSet>::Take(data->NewInstance());
+        variant_data->ShallowCopy(data);
+        for (const Variant& other : variants) {
+            if (other.array_name != v.array_name)
+                variant_data->GetPointData()->RemoveArray(other.array_name.c_str());
+        }
+
+        write(variant_data, stem + VariantName("", v.neighbourhood_size, v.falloff, v.sigma) + ext);
+    }
+}
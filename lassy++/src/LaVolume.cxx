@@ -1,10 +1,12 @@
 #define HAS_VTK 1
 
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <algorithm>
 
 #include "../include/LaVolume.h"
+#include "../include/LaFileName.h"
 
 
 
@@ -47,6 +49,9 @@ LaVolume::LaVolume(const char* filename) {
 
 void LaVolume::SetGrid(vtkSmartPointer<vtkUnstructuredGrid> grid) {
     _grid = grid;
+    _graph.reset();
+    _reordering = LaMeshReordering::Permutation();
+    ClearSurfaceMapping();
 }
 
 void LaVolume::GetGrid(vtkSmartPointer<vtkUnstructuredGrid> grid_out) const {
@@ -77,12 +82,27 @@ vtkIdType LaVolume::GetNumberOfCells() const {
 
 void LaVolume::ImportFile(const char* filename) {
     const std::string fn(filename);
-    if (IsXMLFormat(fn)) {
+    _graph.reset();
+    _reordering = LaMeshReordering::Permutation();
+    ClearSurfaceMapping();
+
+    const std::string ext = LaFileName::Extension(fn);
+    if (ext == ".pts" || ext == ".elem") {
+        const std::string stem = LaFileName::Stem(fn);
+        if (!LaVolumeCarpIO::ReadMesh(stem + ".pts", stem + ".elem", _grid)) return;
+
+        const std::string lon = stem + ".lon";
+        if (std::ifstream(lon).good()) LaVolumeCarpIO::ReadFibres(lon, _grid);
+
+        std::cout << "LaVolume: loaded " << stem << ".pts/.elem"
+             << " (" << _grid->GetNumberOfPoints() << " points, "
+             << _grid->GetNumberOfCells() << " cells)" << std::endl;
+    } else if (IsXMLFormat(fn)) {
         vtkSmartPointer<vtkXMLUnstructuredGridReader> reader =
             vtkSmartPointer<vtkXMLUnstructuredGridReader>::New();
         reader->SetFileName(filename);
         reader->Update();
-        _grid->DeepCopy(reader->GetOutput());
+        _grid->ShallowCopy(reader->GetOutput());
         std::cout << "LaVolume: loaded " << fn
              << " (" << _grid->GetNumberOfPoints() << " points, "
              << _grid->GetNumberOfCells() << " cells)" << std::endl;
@@ -91,7 +111,7 @@ void LaVolume::ImportFile(const char* filename) {
             vtkSmartPointer<vtkUnstructuredGridReader>::New();
         reader->SetFileName(filename);
         reader->Update();
-        _grid->DeepCopy(reader->GetOutput());
+        _grid->ShallowCopy(reader->GetOutput());
         std::cout << "LaVolume: loaded " << fn
              << " (" << _grid->GetNumberOfPoints() << " points, "
              << _grid->GetNumberOfCells() << " cells)" << std::endl;
@@ -117,17 +137,217 @@ void LaVolume::ExportVTU(const char* filename) const {
 }
 
 
+void LaVolume::ExportCARP(const char* stem) const {
+    const std::string base(stem);
+    if (LaVolumeCarpIO::WriteMesh(_grid, base + ".pts", base + ".elem"))
+        std::cout << "LaVolume: saved " << base << ".pts/.elem" << std::endl;
+}
+
+void LaVolume::ExportCARPData(const char* array_name, const char* filename) const {
+    vtkDataArray* array = _grid->GetPointData()->GetArray(array_name);
+    if (!array) array = _grid->GetCellData()->GetArray(array_name);
+    if (!array) {
+        std::cerr << "LaVolume::ExportCARPData — no array named '"
+                  << array_name << "'." << std::endl;
+        return;
+    }
+    if (LaVolumeCarpIO::WriteData(array, filename))
+        std::cout << "LaVolume: saved " << filename << std::endl;
+}
+
+void LaVolume::ImportCARPData(const char* filename, const char* array_name) {
+    vtkSmartPointer<vtkFloatArray> values = LaVolumeCarpIO::ReadData(filename, array_name);
+    if (!values) return;
+
+    const vtkIdType count = values->GetNumberOfTuples();
+    if (count == _grid->GetNumberOfPoints()) {
+        _grid->GetPointData()->RemoveArray(array_name);
+        _grid->GetPointData()->AddArray(values);
+    } else if (count == _grid->GetNumberOfCells()) {
+        _grid->GetCellData()->RemoveArray(array_name);
+        _grid->GetCellData()->AddArray(values);
+    } else {
+        std::cerr << "LaVolume::ImportCARPData — " << count << " values match neither "
+                  << _grid->GetNumberOfPoints() << " points nor "
+                  << _grid->GetNumberOfCells() << " cells." << std::endl;
+    }
+}
+
+
+// ============================================================
+// Locality
+// ============================================================
+
+void LaVolume::Reorder(LaMeshReordering::Curve curve, const char* cache_file) {
+    if (!_reordering.IsEmpty()) RestoreOriginalOrder();
+    _graph.reset();
+    ClearSurfaceMapping();
+    _reordering = LaMeshReordering::Reorder(_grid, curve, cache_file ? cache_file : "");
+}
+
+void LaVolume::RestoreOriginalOrder() {
+    if (_reordering.IsEmpty()) return;
+    _graph.reset();
+    ClearSurfaceMapping();
+    LaMeshReordering::Apply(_grid, LaMeshReordering::Inverse(_reordering));
+    _reordering = LaMeshReordering::Permutation();
+}
+
+const LaMeshReordering::Permutation& LaVolume::GetReordering() const {
+    return _reordering;
+}
+
+
 // ============================================================
 // Conversion
 // ============================================================
 
-LaShell* LaVolume::ConvertToSurface() const {
+LaShell* LaVolume::ConvertToSurface() {
     vtkSmartPointer<vtkDataSetSurfaceFilter> surface_filter =
         vtkSmartPointer<vtkDataSetSurfaceFilter>::New();
     surface_filter->SetInputData(_grid);
+    surface_filter->PassThroughPointIdsOn();
+    surface_filter->PassThroughCellIdsOn();
     surface_filter->Update();
 
+    vtkPolyData* surface = surface_filter->GetOutput();
+    ClearSurfaceMapping();
+
+    vtkDataArray* point_ids = surface->GetPointData()->GetArray(
+        surface_filter->GetOriginalPointIdsName());
+    vtkDataArray* cell_ids = surface->GetCellData()->GetArray(
+        surface_filter->GetOriginalCellIdsName());
+
+    if (point_ids) {
+        const vtkIdType num_surface_points = point_ids->GetNumberOfTuples();
+        _surface_to_volume_points.resize(static_cast<size_t>(num_surface_points));
+        _volume_to_surface_points.assign(
+            static_cast<size_t>(_grid->GetNumberOfPoints()), -1);
+
+        for (vtkIdType i = 0; i < num_surface_points; ++i) {
+            const vtkIdType v = static_cast<vtkIdType>(point_ids->GetComponent(i, 0));
+            _surface_to_volume_points[static_cast<size_t>(i)] = v;
+            _volume_to_surface_points[static_cast<size_t>(v)] = i;
+        }
+    }
+    if (cell_ids) {
+        const vtkIdType num_surface_cells = cell_ids->GetNumberOfTuples();
+        _surface_to_volume_cells.resize(static_cast<size_t>(num_surface_cells));
+        for (vtkIdType i = 0; i < num_surface_cells; ++i) {
+            _surface_to_volume_cells[static_cast<size_t>(i)] =
+                static_cast<vtkIdType>(cell_ids->GetComponent(i, 0));
+        }
+    }
+
     LaShell* shell = new LaShell();
-    shell->SetMesh3D(surface_filter->GetOutput());
+    shell->SetMesh3D(surface);
     return shell;
-}
\ No newline at end of file
+}
+
+
+// ============================================================
+// Surface <-> volume mapping
+// ============================================================
+
+void LaVolume::ClearSurfaceMapping() {
+    _surface_to_volume_points.clear();
+    _volume_to_surface_points.clear();
+    _surface_to_volume_cells.clear();
+}
+
+bool LaVolume::HasSurfaceMapping() const {
+    return !_surface_to_volume_points.empty();
+}
+
+vtkIdType LaVolume::SurfaceToVolumePoint(vtkIdType surface_point_id) const {
+    if (surface_point_id < 0 ||
+        surface_point_id >= static_cast<vtkIdType>(_surface_to_volume_points.size()))
+        return -1;
+    return _surface_to_volume_points[static_cast<size_t>(surface_point_id)];
+}
+
+vtkIdType LaVolume::VolumeToSurfacePoint(vtkIdType volume_point_id) const {
+    if (volume_point_id < 0 ||
+        volume_point_id >= static_cast<vtkIdType>(_volume_to_surface_points.size()))
+        return -1;
+    return _volume_to_surface_points[static_cast<size_t>(volume_point_id)];
+}
+
+vtkIdType LaVolume::SurfaceToVolumeCell(vtkIdType surface_cell_id) const {
+    if (surface_cell_id < 0 ||
+        surface_cell_id >= static_cast<vtkIdType>(_surface_to_volume_cells.size()))
+        return -1;
+    return _surface_to_volume_cells[static_cast<size_t>(surface_cell_id)];
+}
+
+void LaVolume::ScatterSurfaceArray(vtkDataArray* surface_array, double fill_value) {
+    if (!surface_array || !surface_array->GetName()) {
+        std::cerr << "LaVolume::ScatterSurfaceArray — array missing or unnamed."
+                  << std::endl;
+        return;
+    }
+    if (surface_array->GetNumberOfTuples() !=
+        static_cast<vtkIdType>(_surface_to_volume_points.size())) {
+        std::cerr << "LaVolume::ScatterSurfaceArray — array does not match the "
+                     "surface from ConvertToSurface()." << std::endl;
+        return;
+    }
+
+    const int num_components = surface_array->GetNumberOfComponents();
+    vtkSmartPointer<vtkDataArray> volume_array;
+    volume_array.TakeReference(surface_array->NewInstance());
+    volume_array->SetName(surface_array->GetName());
+    volume_array->SetNumberOfComponents(num_components);
+    volume_array->SetNumberOfTuples(_grid->GetNumberOfPoints());
+    for (int c = 0; c < num_components; ++c)
+        volume_array->FillComponent(c, fill_value);
+
+    for (size_t i = 0; i < _surface_to_volume_points.size(); ++i) {
+        volume_array->SetTuple(_surface_to_volume_points[i],
+                               static_cast<vtkIdType>(i), surface_array);
+    }
+
+    _grid->GetPointData()->RemoveArray(surface_array->GetName());
+    _grid->GetPointData()->AddArray(volume_array);
+}
+
+
+// ============================================================
+// Geodesic distance
+// ============================================================
+
+const LaVolumeGraphTraversal& LaVolume::GetGraph() {
+    if (!_graph) {
+        _graph = std::make_unique<LaVolumeGraphTraversal>();
+        _graph->SetInputGrid(_grid);
+        _graph->SetEdgeWeightToEuclidean();
+        _graph->Build();
+    }
+    return *_graph;
+}
+
+void LaVolume::ComputeGeodesicDistance(const std::vector<vtkIdType>& seed_ids,
+                                       double max_distance,
+                                       const char* array_name) {
+    if (seed_ids.empty()) {
+        std::cerr << "LaVolume::ComputeGeodesicDistance — no seed nodes." << std::endl;
+        return;
+    }
+
+    std::vector<float>     distance;
+    std::vector<vtkIdType> nearest_seed;
+    GetGraph().GetDistanceToPoints(seed_ids, max_distance, distance, nearest_seed);
+    if (distance.empty()) return;
+
+    vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+    scalars->SetName(array_name);
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(static_cast<vtkIdType>(distance.size()));
+    std::copy(distance.begin(), distance.end(), scalars->GetPointer(0));
+
+    _grid->GetPointData()->RemoveArray(array_name);
+    _grid->GetPointData()->AddArray(scalars);
+
+    std::cout << "LaVolume: geodesic distance from " << seed_ids.size()
+              << " seeds written to \"" << array_name << "\"" << std::endl;
+}
@@ -0,0 +1,777 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <iterator>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <vtkCellArray.h>
+#include <vtkCellData.h>
+#include <vtkCellType.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkIntArray.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "../include/LaVolumeCarpIO.h"
+
+
+const char* LaVolumeCarpIO::RegionArrayName = "elemTag";
+const char* LaVolumeCarpIO::FibreArrayName  = "fibres";
+const char* LaVolumeCarpIO::SheetArrayName  = "sheets";
+
+
+// ============================================================
+// Internal helpers
+// ============================================================
+
+namespace {
+
+// ---- Memory-mapped input ----------------------------------------------
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& filename);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool        IsOpen() const { return _open; }
+    const char* Begin()  const { return _data; }
+    const char* End()    const { return _data + _size; }
+
+private:
+    const char* _data;
+    size_t      _size;
+    bool        _open;
+#if defined(_WIN32)
+    std::string _buffer;        // no mmap: read the file in one go
+#endif
+};
+
+MappedFile::MappedFile(const std::string& filename) :
+    _data(""),
+    _size(0),
+    _open(false) {
+#if defined(_WIN32)
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) return;
+    _buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    _data = _buffer.data();
+    _size = _buffer.size();
+    _open = true;
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (::fstat(fd, &st) == 0) {
+        _open = true;
+        if (st.st_size > 0) {
+            void* mapped = ::mmap(nullptr, static_cast<size_t>(st.st_size),
+                                  PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                _open = false;
+            } else {
+                ::madvise(mapped, static_cast<size_t>(st.st_size), MADV_SEQUENTIAL);
+                _data = static_cast<const char*>(mapped);
+                _size = static_cast<size_t>(st.st_size);
+            }
+        }
+    }
+    ::close(fd);
+#endif
+}
+
+MappedFile::~MappedFile() {
+#if !defined(_WIN32)
+    if (_size > 0) ::munmap(const_cast<char*>(_data), _size);
+#endif
+}
+
+// ---- Tokens -------------------------------------------------------------
+
+inline bool IsBlank(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline const char* SkipBlanks(const char* p, const char* end) {
+    while (p < end && IsBlank(*p)) ++p;
+    return p;
+}
+
+/*
+ * Parses one number after optional blanks.  Returns the position after
+ * it, or nullptr (value untouched) if there is none.
+ */
+template <typename T>
+const char* ParseValue(const char* p, const char* end, T& value) {
+    p = SkipBlanks(p, end);
+    const std::from_chars_result result = std::from_chars(p, end, value);
+    return (result.ec == std::errc()) ? result.ptr : nullptr;
+}
+
+#if !defined(__cpp_lib_to_chars)
+// Standard libraries without floating-point from_chars: strtof on a
+// null-terminated copy of the token (the mapping is not terminated).
+template <>
+const char* ParseValue<float>(const char* p, const char* end, float& value) {
+    p = SkipBlanks(p, end);
+    char token[64];
+    size_t n = 0;
+    while (p + n < end && n + 1 < sizeof(token) && !IsBlank(p[n]) && p[n] != '\n') {
+        token[n] = p[n];
+        ++n;
+    }
+    token[n] = '\0';
+
+    char* stop = nullptr;
+    const float parsed = std::strtof(token, &stop);
+    if (stop == token) return nullptr;
+    value = parsed;
+    return p + (stop - token);
+}
+#endif
+
+int CountTokens(const char* p, const char* end) {
+    int count = 0;
+    while (true) {
+        p = SkipBlanks(p, end);
+        if (p >= end) return count;
+        ++count;
+        while (p < end && !IsBlank(*p)) ++p;
+    }
+}
+
+// ---- Lines and chunks ---------------------------------------------------
+
+/*
+ * Calls f(line_begin, line_end) for every line of [begin, end) holding a
+ * non-blank character; line_begin is the first such character.
+ */
+template <typename F>
+void ForEachLine(const char* begin, const char* end, F&& f) {
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(
+            std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        const char* line_end = newline ? newline : end;
+
+        const char* first = SkipBlanks(p, line_end);
+        if (first < line_end) f(first, line_end);
+
+        p = newline ? newline + 1 : end;
+    }
+}
+
+/*
+ * Finds the first line of [begin, end) holding a non-blank character:
+ * [line, line_end) from that character, body just past the line.  Only
+ * the lines up to it are scanned.
+ */
+bool FirstLine(const char* begin, const char* end,
+               const char*& line, const char*& line_end, const char*& body) {
+    const char* p = begin;
+    while (p < end) {
+        const char* newline = static_cast<const char*>(
+            std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        line_end = newline ? newline : end;
+        body     = newline ? newline + 1 : end;
+
+        line = SkipBlanks(p, line_end);
+        if (line < line_end) return true;
+        p = body;
+    }
+    return false;
+}
+
+/*
+ * Reads the first non-empty line as the record count and returns the
+ * position after it in body.
+ */
+bool ReadHeader(const char* begin, const char* end, vtkIdType& count, const char*& body) {
+    const char* line = nullptr;
+    const char* line_end = nullptr;
+    return FirstLine(begin, end, line, line_end, body) &&
+           ParseValue(line, line_end, count) != nullptr;
+}
+
+/*
+ * Line-aligned chunks of a file body; chunk c spans
+ * [bounds[c], bounds[c + 1]) and its first record is number first[c].
+ */
+struct Chunks {
+    std::vector<const char*> bounds;
+    std::vector<vtkIdType>   first;
+    vtkIdType                records;
+
+    vtkIdType Size() const { return static_cast<vtkIdType>(first.size()); }
+};
+
+Chunks SplitIntoChunks(const char* begin, const char* end) {
+    const size_t size      = static_cast<size_t>(end - begin);
+    const size_t min_chunk = size_t(1) << 20;
+    const size_t max_count = 4 * static_cast<size_t>(
+        std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads()));
+    const size_t count = std::max<size_t>(1, std::min(size / min_chunk, max_count));
+
+    Chunks chunks;
+    chunks.bounds.push_back(begin);
+    for (size_t i = 1; i < count; ++i) {
+        const char* p = std::max(begin + size * i / count, chunks.bounds.back());
+        const char* newline = static_cast<const char*>(
+            std::memchr(p, '\n', static_cast<size_t>(end - p)));
+        chunks.bounds.push_back(newline ? newline + 1 : end);
+    }
+    chunks.bounds.push_back(end);
+
+    // Counting pass: records per chunk, then each chunk's first record
+    const vtkIdType num_chunks = static_cast<vtkIdType>(chunks.bounds.size() - 1);
+    std::vector<vtkIdType> counts(static_cast<size_t>(num_chunks), 0);
+    vtkSMPTools::For(0, num_chunks, 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType c = first; c < last; ++c) {
+            vtkIdType& n = counts[static_cast<size_t>(c)];
+            ForEachLine(chunks.bounds[static_cast<size_t>(c)],
+                        chunks.bounds[static_cast<size_t>(c) + 1],
+                        [&n](const char*, const char*) { ++n; });
+        }
+    });
+
+    chunks.first.resize(counts.size());
+    chunks.records = 0;
+    for (size_t c = 0; c < counts.size(); ++c) {
+        chunks.first[c] = chunks.records;
+        chunks.records += counts[c];
+    }
+    return chunks;
+}
+
+/*
+ * Parsing pass: calls parse(line_begin, line_end, record, chunk) for every
+ * record, chunks in parallel.  Returns false if any call did.
+ */
+template <typename F>
+bool ParseChunks(const Chunks& chunks, F&& parse) {
+    std::atomic<bool> ok(true);
+    vtkSMPTools::For(0, chunks.Size(), 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType c = first; c < last; ++c) {
+            vtkIdType record = chunks.first[static_cast<size_t>(c)];
+            ForEachLine(chunks.bounds[static_cast<size_t>(c)],
+                        chunks.bounds[static_cast<size_t>(c) + 1],
+                        [&](const char* line_begin, const char* line_end) {
+                            if (!parse(line_begin, line_end, record, c)) ok = false;
+                            ++record;
+                        });
+        }
+    });
+    return ok;
+}
+
+// ---- Element types ------------------------------------------------------
+
+struct CarpElement {
+    char code[3];
+    int  vtk_type;
+    int  num_nodes;
+};
+
+const CarpElement kCarpElements[] = {
+    {"Ln", VTK_LINE,       2},
+    {"Tr", VTK_TRIANGLE,   3},
+    {"Qd", VTK_QUAD,       4},
+    {"Tt", VTK_TETRA,      4},
+    {"Py", VTK_PYRAMID,    5},
+    {"Pr", VTK_WEDGE,      6},
+    {"Hx", VTK_HEXAHEDRON, 8}
+};
+
+const CarpElement* FindCarpElement(const char* p, const char* end) {
+    if (end - p < 2 || (end - p > 2 && !IsBlank(p[2]))) return nullptr;
+    for (const CarpElement& e : kCarpElements) {
+        if (p[0] == e.code[0] && p[1] == e.code[1]) return &e;
+    }
+    return nullptr;
+}
+
+// ---- Node order ---------------------------------------------------------
+
+/*
+ * CARP lists the nodes of a 3D element in VTK's pattern — the base of a
+ * tetrahedron or pyramid then its apex, the two faces of a prism or
+ * hexahedron with matching corners — but does not fix the winding of
+ * the first face, which VTK does:
+ *
+ *   tetra    (0,1,2)    normal points at node 3
+ *   pyramid  (0,1,2,3)  normal points at the apex 4
+ *   wedge    (0,1,2)    normal points away from (3,4,5)
+ *   hexa     (0,1,2,3)  normal points at (4,5,6,7)
+ *
+ * An element wound the other way is mirrored into VTK's order by
+ * swapping matching nodes of each face.  Returns true if it was.
+ */
+bool OrientLikeVtk(int vtk_type, vtkIdType* ids, const float* xyz) {
+    auto point = [&](int k, int axis) {
+        return static_cast<double>(xyz[3 * ids[k] + axis]);
+    };
+
+    int base = 0;
+    bool outward = false;       // wedge: base normal points away from the top
+    switch (vtk_type) {
+        case VTK_TETRA:      base = 3;                  break;
+        case VTK_PYRAMID:    base = 4;                  break;
+        case VTK_WEDGE:      base = 3; outward = true;  break;
+        case VTK_HEXAHEDRON: base = 4;                  break;
+        default:             return false;
+    }
+
+    // Base normal: (1-0) x (2-0) for a triangle, diagonals for a quad
+    double a[3], b[3];
+    for (int axis = 0; axis < 3; ++axis) {
+        a[axis] = (base == 3) ? point(1, axis) - point(0, axis) : point(2, axis) - point(0, axis);
+        b[axis] = (base == 3) ? point(2, axis) - point(0, axis) : point(3, axis) - point(1, axis);
+    }
+    const double normal[3] = {a[1] * b[2] - a[2] * b[1],
+                              a[2] * b[0] - a[0] * b[2],
+                              a[0] * b[1] - a[1] * b[0]};
+
+    // From the base centroid to the centroid of the remaining nodes
+    const int num_nodes = (vtk_type == VTK_TETRA)   ? 4 : (vtk_type == VTK_PYRAMID) ? 5 :
+                          (vtk_type == VTK_WEDGE)   ? 6 : 8;
+    double dot = 0.0;
+    for (int axis = 0; axis < 3; ++axis) {
+        double base_sum = 0.0, top_sum = 0.0;
+        for (int k = 0; k < base; ++k)         base_sum += point(k, axis);
+        for (int k = base; k < num_nodes; ++k) top_sum  += point(k, axis);
+        dot += normal[axis] * (top_sum / (num_nodes - base) - base_sum / base);
+    }
+    if (outward) dot = -dot;
+    if (dot >= 0.0) return false;               // VTK order, or degenerate
+
+    switch (vtk_type) {
+        case VTK_TETRA:      std::swap(ids[1], ids[2]);                             break;
+        case VTK_PYRAMID:    std::swap(ids[1], ids[3]);                             break;
+        case VTK_WEDGE:      std::swap(ids[1], ids[2]); std::swap(ids[4], ids[5]); break;
+        case VTK_HEXAHEDRON: std::swap(ids[1], ids[3]); std::swap(ids[5], ids[7]); break;
+    }
+    return true;
+}
+
+const CarpElement* FindCarpElement(int vtk_type) {
+    for (const CarpElement& e : kCarpElements) {
+        if (e.vtk_type == vtk_type) return &e;
+    }
+    return nullptr;
+}
+
+// ---- Output -------------------------------------------------------------
+
+void AppendInt(std::string& s, long long value) {
+    char buffer[24];
+    const std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    s.append(buffer, result.ptr);
+}
+
+void AppendFloat(std::string& s, double value) {
+    char buffer[32];
+    const int n = std::snprintf(buffer, sizeof(buffer), "%.9g", value);
+    s.append(buffer, static_cast<size_t>(n));
+}
+
+/*
+ * Writes header, then records [0, count) formatted by
+ * format(record, text).  Blocks of records are formatted in parallel a
+ * window at a time and written in order, so memory stays bounded.
+ */
+template <typename F>
+bool WriteRecords(const std::string& filename,
+                  const std::string& header,
+                  vtkIdType count,
+                  F&& format) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "LaVolumeCarpIO: cannot write " << filename << std::endl;
+        return false;
+    }
+    out << header;
+
+    const vtkIdType block      = 1 << 16;
+    const vtkIdType num_blocks = (count + block - 1) / block;
+    const vtkIdType window     = 4 * static_cast<vtkIdType>(
+        std::max(1, vtkSMPTools::GetEstimatedNumberOfThreads()));
+
+    std::vector<std::string> text(static_cast<size_t>(window));
+    for (vtkIdType w = 0; w < num_blocks; w += window) {
+        const vtkIdType w_end = std::min(num_blocks, w + window);
+
+        vtkSMPTools::For(w, w_end, 1, [&](vtkIdType first, vtkIdType last) {
+            for (vtkIdType b = first; b < last; ++b) {
+                std::string& s = text[static_cast<size_t>(b - w)];
+                s.clear();
+                const vtkIdType r_end = std::min(count, (b + 1) * block);
+                for (vtkIdType r = b * block; r < r_end; ++r) format(r, s);
+            }
+        });
+
+        for (vtkIdType b = w; b < w_end; ++b) {
+            const std::string& s = text[static_cast<size_t>(b - w)];
+            out.write(s.data(), static_cast<std::streamsize>(s.size()));
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+} // namespace
+
+
+// ============================================================
+// Readers
+// ============================================================
+
+bool LaVolumeCarpIO::ReadMesh(const std::string& pts_file,
+                              const std::string& elem_file,
+                              vtkUnstructuredGrid* grid) {
+
+    // ---- Points -------------------------------------------------------
+    MappedFile pts(pts_file);
+    if (!pts.IsOpen()) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — cannot open " << pts_file << std::endl;
+        return false;
+    }
+
+    vtkIdType num_points = 0;
+    const char* pts_body = nullptr;
+    if (!ReadHeader(pts.Begin(), pts.End(), num_points, pts_body)) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — missing point count in "
+                  << pts_file << std::endl;
+        return false;
+    }
+
+    const Chunks point_chunks = SplitIntoChunks(pts_body, pts.End());
+    if (point_chunks.records != num_points) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — " << pts_file << " declares "
+                  << num_points << " points but holds " << point_chunks.records
+                  << "." << std::endl;
+        return false;
+    }
+
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataTypeToFloat();
+    points->SetNumberOfPoints(num_points);
+    float* xyz = static_cast<float*>(points->GetVoidPointer(0));
+
+    const bool points_ok = ParseChunks(point_chunks,
+        [xyz](const char* p, const char* end, vtkIdType r, vtkIdType) {
+            float* x = xyz + 3 * r;
+            for (int k = 0; k < 3 && p; ++k) p = ParseValue(p, end, x[k]);
+            return p != nullptr;
+        });
+    if (!points_ok) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — malformed line in " << pts_file << std::endl;
+        return false;
+    }
+
+    // ---- Elements -----------------------------------------------------
+    MappedFile elem(elem_file);
+    if (!elem.IsOpen()) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — cannot open " << elem_file << std::endl;
+        return false;
+    }
+
+    vtkIdType num_cells = 0;
+    const char* elem_body = nullptr;
+    if (!ReadHeader(elem.Begin(), elem.End(), num_cells, elem_body)) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — missing element count in "
+                  << elem_file << std::endl;
+        return false;
+    }
+
+    const Chunks cell_chunks = SplitIntoChunks(elem_body, elem.End());
+    if (cell_chunks.records != num_cells) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — " << elem_file << " declares "
+                  << num_cells << " elements but holds " << cell_chunks.records
+                  << "." << std::endl;
+        return false;
+    }
+
+    // Connectivity size per chunk from the type codes alone, so every
+    // chunk knows where its connectivity starts before parsing.
+    std::vector<vtkIdType> chunk_connectivity(static_cast<size_t>(cell_chunks.Size()) + 1, 0);
+    std::atomic<bool> types_ok(true);
+    vtkSMPTools::For(0, cell_chunks.Size(), 1, [&](vtkIdType first, vtkIdType last) {
+        for (vtkIdType c = first; c < last; ++c) {
+            vtkIdType size = 0;
+            ForEachLine(cell_chunks.bounds[static_cast<size_t>(c)],
+                        cell_chunks.bounds[static_cast<size_t>(c) + 1],
+                        [&](const char* p, const char* end) {
+                            const CarpElement* type = FindCarpElement(p, end);
+                            if (type) size += type->num_nodes;
+                            else      types_ok = false;
+                        });
+            chunk_connectivity[static_cast<size_t>(c) + 1] = size;
+        }
+    });
+    if (!types_ok) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — unknown element type in "
+                  << elem_file << std::endl;
+        return false;
+    }
+    std::partial_sum(chunk_connectivity.begin(), chunk_connectivity.end(),
+                     chunk_connectivity.begin());
+
+    vtkSmartPointer<vtkUnsignedCharArray> types = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    vtkSmartPointer<vtkIdTypeArray> offsets      = vtkSmartPointer<vtkIdTypeArray>::New();
+    vtkSmartPointer<vtkIdTypeArray> connectivity = vtkSmartPointer<vtkIdTypeArray>::New();
+    vtkSmartPointer<vtkIntArray> regions         = vtkSmartPointer<vtkIntArray>::New();
+
+    types->SetNumberOfValues(num_cells);
+    offsets->SetNumberOfValues(num_cells + 1);
+    connectivity->SetNumberOfValues(chunk_connectivity.back());
+    regions->SetName(RegionArrayName);
+    regions->SetNumberOfValues(num_cells);
+
+    unsigned char* type_ptr   = types->GetPointer(0);
+    vtkIdType*     offset_ptr = offsets->GetPointer(0);
+    vtkIdType*     conn_ptr   = connectivity->GetPointer(0);
+    int*           region_ptr = regions->GetPointer(0);
+
+    // Each chunk advances only its own cursor and its own count of
+    // elements mirrored into VTK's node order
+    std::vector<vtkIdType> cursor(chunk_connectivity.begin(), chunk_connectivity.end() - 1);
+    std::vector<vtkIdType> mirrored(static_cast<size_t>(cell_chunks.Size()), 0);
+
+    const bool cells_ok = ParseChunks(cell_chunks,
+        [&](const char* p, const char* end, vtkIdType r, vtkIdType c) {
+            const CarpElement* type = FindCarpElement(p, end);
+            vtkIdType& pos = cursor[static_cast<size_t>(c)];
+
+            type_ptr[r]   = static_cast<unsigned char>(type->vtk_type);
+            offset_ptr[r] = pos;
+
+            p += 2;
+            for (int k = 0; k < type->num_nodes; ++k) {
+                vtkIdType id = -1;
+                p = ParseValue(p, end, id);
+                if (!p || id < 0 || id >= num_points) return false;
+                conn_ptr[pos++] = id;
+            }
+            if (OrientLikeVtk(type->vtk_type, conn_ptr + pos - type->num_nodes, xyz))
+                ++mirrored[static_cast<size_t>(c)];
+
+            int region = 0;
+            ParseValue(p, end, region);         // optional
+            region_ptr[r] = region;
+            return true;
+        });
+    if (!cells_ok) {
+        std::cerr << "LaVolumeCarpIO::ReadMesh — malformed element or node id out "
+                     "of range in " << elem_file << std::endl;
+        return false;
+    }
+    offset_ptr[num_cells] = chunk_connectivity.back();
+
+    vtkSmartPointer<vtkCellArray> cells = vtkSmartPointer<vtkCellArray>::New();
+    cells->SetData(offsets, connectivity);
+
+    grid->Initialize();
+    grid->SetPoints(points);
+    grid->SetCells(types, cells);
+    grid->GetCellData()->AddArray(regions);
+
+    std::cout << "LaVolumeCarpIO: read " << num_points << " points, "
+              << num_cells << " elements." << std::endl;
+
+    const vtkIdType num_mirrored = std::accumulate(mirrored.begin(), mirrored.end(), vtkIdType(0));
+    if (num_mirrored > 0)
+        std::cout << "LaVolumeCarpIO: " << num_mirrored << " elements wound against "
+                     "VTK's node order were mirrored." << std::endl;
+    return true;
+}
+
+bool LaVolumeCarpIO::ReadFibres(const std::string& lon_file,
+                                vtkUnstructuredGrid* grid) {
+    MappedFile lon(lon_file);
+    if (!lon.IsOpen()) {
+        std::cerr << "LaVolumeCarpIO::ReadFibres — cannot open " << lon_file << std::endl;
+        return false;
+    }
+
+    // A single token on the first line is the number of directions
+    // (1 or 2); older files start straight away with 3 or 6 components.
+    const char* body = lon.Begin();
+    const char* line = nullptr;
+    const char* line_end = nullptr;
+    const char* after_line = nullptr;
+    int num_components = 0;
+    if (FirstLine(lon.Begin(), lon.End(), line, line_end, after_line)) {
+        const int tokens = CountTokens(line, line_end);
+        if (tokens == 1) {
+            int directions = 1;
+            ParseValue(line, line_end, directions);
+            num_components = 3 * directions;
+            body = after_line;
+        } else {
+            num_components = tokens;
+        }
+    }
+    if (num_components != 3 && num_components != 6) {
+        std::cerr << "LaVolumeCarpIO::ReadFibres — expected 3 or 6 components in "
+                  << lon_file << std::endl;
+        return false;
+    }
+
+    const Chunks chunks = SplitIntoChunks(body, lon.End());
+    if (chunks.records != grid->GetNumberOfCells()) {
+        std::cerr << "LaVolumeCarpIO::ReadFibres — " << chunks.records
+                  << " fibres for " << grid->GetNumberOfCells() << " elements." << std::endl;
+        return false;
+    }
+
+    vtkSmartPointer<vtkFloatArray> fibres = vtkSmartPointer<vtkFloatArray>::New();
+    fibres->SetName(FibreArrayName);
+    fibres->SetNumberOfComponents(3);
+    fibres->SetNumberOfTuples(chunks.records);
+
+    vtkSmartPointer<vtkFloatArray> sheets;
+    if (num_components == 6) {
+        sheets = vtkSmartPointer<vtkFloatArray>::New();
+        sheets->SetName(SheetArrayName);
+        sheets->SetNumberOfComponents(3);
+        sheets->SetNumberOfTuples(chunks.records);
+    }
+
+    float* fibre_ptr = fibres->GetPointer(0);
+    float* sheet_ptr = sheets ? sheets->GetPointer(0) : nullptr;
+
+    const bool ok = ParseChunks(chunks,
+        [&](const char* p, const char* end, vtkIdType r, vtkIdType) {
+            for (int k = 0; k < 3 && p; ++k) p = ParseValue(p, end, fibre_ptr[3 * r + k]);
+            if (sheet_ptr) {
+                for (int k = 0; k < 3 && p; ++k) p = ParseValue(p, end, sheet_ptr[3 * r + k]);
+            }
+            return p != nullptr;
+        });
+    if (!ok) {
+        std::cerr << "LaVolumeCarpIO::ReadFibres — malformed line in " << lon_file << std::endl;
+        return false;
+    }
+
+    grid->GetCellData()->AddArray(fibres);
+    if (sheets) grid->GetCellData()->AddArray(sheets);
+    return true;
+}
+
+vtkSmartPointer<vtkFloatArray> LaVolumeCarpIO::ReadData(const std::string& dat_file,
+                                                        const char* name) {
+    MappedFile dat(dat_file);
+    if (!dat.IsOpen()) {
+        std::cerr << "LaVolumeCarpIO::ReadData — cannot open " << dat_file << std::endl;
+        return nullptr;
+    }
+
+    const Chunks chunks = SplitIntoChunks(dat.Begin(), dat.End());
+
+    vtkSmartPointer<vtkFloatArray> values = vtkSmartPointer<vtkFloatArray>::New();
+    values->SetName(name);
+    values->SetNumberOfComponents(1);
+    values->SetNumberOfTuples(chunks.records);
+    float* value_ptr = values->GetPointer(0);
+
+    const bool ok = ParseChunks(chunks,
+        [value_ptr](const char* p, const char* end, vtkIdType r, vtkIdType) {
+            return ParseValue(p, end, value_ptr[r]) != nullptr;
+        });
+    if (!ok) {
+        std::cerr << "LaVolumeCarpIO::ReadData — malformed line in " << dat_file << std::endl;
+        return nullptr;
+    }
+    return values;
+}
+
+
+// ============================================================
+// Writers
+// ============================================================
+
+bool LaVolumeCarpIO::WriteMesh(vtkUnstructuredGrid* grid,
+                               const std::string& pts_file,
+                               const std::string& elem_file) {
+    const vtkIdType num_points = grid->GetNumberOfPoints();
+    const vtkIdType num_cells  = grid->GetNumberOfCells();
+
+    // ---- Points -------------------------------------------------------
+    const bool points_ok = WriteRecords(pts_file, std::to_string(num_points) + "\n",
+        num_points, [grid](vtkIdType r, std::string& s) {
+            double x[3];
+            grid->GetPoint(r, x);
+            AppendFloat(s, x[0]); s += ' ';
+            AppendFloat(s, x[1]); s += ' ';
+            AppendFloat(s, x[2]); s += '\n';
+        });
+    if (!points_ok) return false;
+
+    // ---- Elements -----------------------------------------------------
+    std::vector<vtkIdType> written;
+    written.reserve(static_cast<size_t>(num_cells));
+    for (vtkIdType c = 0; c < num_cells; ++c) {
+        if (FindCarpElement(grid->GetCellType(c))) written.push_back(c);
+    }
+    if (static_cast<vtkIdType>(written.size()) != num_cells) {
+        std::cerr << "LaVolumeCarpIO::WriteMesh — skipping "
+                  << num_cells - static_cast<vtkIdType>(written.size())
+                  << " cells with no CARP element type." << std::endl;
+    }
+
+    vtkDataArray* regions = grid->GetCellData()->GetArray(RegionArrayName);
+    vtkSMPThreadLocalObject<vtkIdList> thread_ids;
+
+    return WriteRecords(elem_file, std::to_string(written.size()) + "\n",
+        static_cast<vtkIdType>(written.size()),
+        [&](vtkIdType r, std::string& s) {
+            const vtkIdType c = written[static_cast<size_t>(r)];
+            vtkIdList* ids = thread_ids.Local();
+            grid->GetCellPoints(c, ids);
+
+            s.append(FindCarpElement(grid->GetCellType(c))->code, 2);
+            for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
+                s += ' ';
+                AppendInt(s, ids->GetId(k));
+            }
+            s += ' ';
+            AppendInt(s, regions ? static_cast<long long>(regions->GetComponent(c, 0)) : 0);
+            s += '\n';
+        });
+}
+
+bool LaVolumeCarpIO::WriteData(vtkDataArray* array,
+                               const std::string& dat_file) {
+    const int num_components = array->GetNumberOfComponents();
+    return WriteRecords(dat_file, "", array->GetNumberOfTuples(),
+        [array, num_components](vtkIdType r, std::string& s) {
+            for (int k = 0; k < num_components; ++k) {
+                if (k > 0) s += ' ';
+                AppendFloat(s, array->GetComponent(r, k));
+            }
+            s += '\n';
+        });
+}
+
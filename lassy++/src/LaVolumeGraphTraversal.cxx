@@ -1,17 +1,71 @@
 #define HAS_VTK 1
 
 #include <iostream>
-#include <queue>
-#include <unordered_map>
 #include <algorithm>
+#include <numeric>
 #include <cmath>
+#include <cstring>
 
 #include <vtkCell.h>
+#include <vtkCellType.h>
+#include <vtkGenericCell.h>
+#include <vtkSMPTools.h>
+#include <vtkSMPThreadLocal.h>
+#include <vtkSMPThreadLocalObject.h>
 #include <vtkIdList.h>
 
 #include "../include/LaVolumeGraphTraversal.h"
 
 
+// ============================================================
+// Cell edge tables
+// ============================================================
+
+namespace {
+
+/*
+ * Local edges of the common linear cells, in VTK's own edge order.
+ * Cell types without a table go through vtkCell::GetEdge().
+ */
+struct EdgeTable {
+    int count;
+    int edges[12][2];
+};
+
+const EdgeTable kLineEdges     = {1,  {{0,1}}};
+const EdgeTable kTriangleEdges = {3,  {{0,1}, {1,2}, {2,0}}};
+const EdgeTable kQuadEdges     = {4,  {{0,1}, {1,2}, {2,3}, {3,0}}};
+const EdgeTable kPixelEdges    = {4,  {{0,1}, {1,3}, {2,3}, {0,2}}};
+const EdgeTable kTetraEdges    = {6,  {{0,1}, {1,2}, {2,0}, {0,3}, {1,3}, {2,3}}};
+const EdgeTable kPyramidEdges  = {8,  {{0,1}, {1,2}, {2,3}, {3,0},
+                                       {0,4}, {1,4}, {2,4}, {3,4}}};
+const EdgeTable kWedgeEdges    = {9,  {{0,1}, {1,2}, {2,0}, {3,4}, {4,5},
+                                       {5,3}, {0,3}, {1,4}, {2,5}}};
+const EdgeTable kHexEdges      = {12, {{0,1}, {1,2}, {3,2}, {0,3},
+                                       {4,5}, {5,6}, {7,6}, {4,7},
+                                       {0,4}, {1,5}, {3,7}, {2,6}}};
+const EdgeTable kVoxelEdges    = {12, {{0,1}, {1,3}, {2,3}, {0,2},
+                                       {4,5}, {5,7}, {6,7}, {4,6},
+                                       {0,4}, {1,5}, {2,6}, {3,7}}};
+
+const EdgeTable* FindEdgeTable(int cell_type) {
+    switch (cell_type) {
+        case VTK_LINE:       return &kLineEdges;
+        case VTK_TRIANGLE:   return &kTriangleEdges;
+        case VTK_QUAD:       return &kQuadEdges;
+        case VTK_PIXEL:      return &kPixelEdges;
+        case VTK_TETRA:      return &kTetraEdges;
+        case VTK_PYRAMID:    return &kPyramidEdges;
+        case VTK_WEDGE:      return &kWedgeEdges;
+        case VTK_HEXAHEDRON: return &kHexEdges;
+        case VTK_VOXEL:      return &kVoxelEdges;
+        default:             return nullptr;
+    }
+}
+
+} // namespace
+
+
 // ============================================================
 // Constructor
 // ============================================================
@@ -20,18 +74,23 @@ LaVolumeGraphTraversal::LaVolumeGraphTraversal() :
     _grid(nullptr),
     _weight_mode(EdgeWeight::Euclidean),
     _built(false),
-    _num_nodes(0) {}
+    _num_nodes(0),
+    _edge_stats{0.0, 0.0, 0.0, 0.0, 0, {}},
+    _edge_stats_valid(false) {}
 
 
 // ============================================================
 // Setup
 // ============================================================
 
-void LaVolumeGraphTraversal::SetInputGrid(vtkUnstructuredGrid* grid) {
+void LaVolumeGraphTraversal::SetInputGrid(vtkDataSet* grid) {
     _grid  = grid;
     _built = false;
-    _adj.clear();
+    _offsets.clear();
+    _targets.clear();
+    _weights.clear();
     _num_nodes = 0;
+    _edge_stats_valid = false;
 }
 
 void LaVolumeGraphTraversal::SetEdgeWeightToEuclidean() {
@@ -42,26 +101,116 @@ void LaVolumeGraphTraversal::SetEdgeWeightToTopological() {
     _weight_mode = EdgeWeight::Topological;
 }
 
-void LaVolumeGraphTraversal::InsertCellEdges(vtkIdList* point_ids) {
-    const vtkIdType n = point_ids->GetNumberOfIds();
-    for (vtkIdType i = 0; i < n; ++i) {
-        for (vtkIdType j = i + 1; j < n; ++j) {
-            const vtkIdType a = point_ids->GetId(i);
-            const vtkIdType b = point_ids->GetId(j);
+std::vector<std::uint64_t> LaVolumeGraphTraversal::CollectCellEdges() const {
+    const vtkIdType num_cells = _grid->GetNumberOfCells();
+    if (num_cells == 0) return {};
+
+    // vtkDataSet cell accessors are thread-safe once they have been
+    // called from a single thread (vtkPolyData builds its cell map here).
+    {
+        vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+        vtkSmartPointer<vtkGenericCell> cell = vtkSmartPointer<vtkGenericCell>::New();
+        _grid->GetCellType(0);
+        _grid->GetCellPoints(0, ids);
+        _grid->GetCell(0, cell);
+    }
 
-            double weight = 1.0;
-            if (_weight_mode == EdgeWeight::Euclidean) {
-                double pa[3], pb[3];
-                _grid->GetPoint(a, pa);
-                _grid->GetPoint(b, pb);
-                weight = Euclidean(pa, pb);
+    vtkSMPThreadLocal<std::vector<std::uint64_t>> thread_edges;
+    vtkSMPThreadLocalObject<vtkIdList>            thread_ids;
+    vtkSMPThreadLocalObject<vtkGenericCell>       thread_cells;
+
+    vtkSMPTools::For(0, num_cells, [&](vtkIdType begin, vtkIdType end) {
+        std::vector<std::uint64_t>& edges = thread_edges.Local();
+        vtkIdList*      ids     = thread_ids.Local();
+        vtkGenericCell* generic = thread_cells.Local();
+
+        auto emit = [&edges](vtkIdType a, vtkIdType b) {
+            if (a == b) return;
+            if (a > b) std::swap(a, b);
+            edges.push_back((static_cast<std::uint64_t>(a) << 32) |
+                            static_cast<std::uint64_t>(b));
+        };
+
+        for (vtkIdType c = begin; c < end; ++c) {
+            const int cell_type = _grid->GetCellType(c);
+
+            if (const EdgeTable* table = FindEdgeTable(cell_type)) {
+                _grid->GetCellPoints(c, ids);
+                for (int e = 0; e < table->count; ++e) {
+                    emit(ids->GetId(table->edges[e][0]),
+                         ids->GetId(table->edges[e][1]));
+                }
+                continue;
             }
 
-            // Insert both directions — undirected graph
-            _adj[static_cast<size_t>(a)].push_back({b, weight});
-            _adj[static_cast<size_t>(b)].push_back({a, weight});
+            switch (cell_type) {
+                case VTK_EMPTY_CELL:
+                case VTK_VERTEX:
+                case VTK_POLY_VERTEX:
+                    break;
+
+                case VTK_POLY_LINE: {
+                    _grid->GetCellPoints(c, ids);
+                    const vtkIdType n = ids->GetNumberOfIds();
+                    for (vtkIdType i = 0; i + 1 < n; ++i)
+                        emit(ids->GetId(i), ids->GetId(i + 1));
+                    break;
+                }
+                case VTK_POLYGON: {
+                    _grid->GetCellPoints(c, ids);
+                    const vtkIdType n = ids->GetNumberOfIds();
+                    for (vtkIdType i = 0; i < n; ++i)
+                        emit(ids->GetId(i), ids->GetId((i + 1) % n));
+                    break;
+                }
+                case VTK_TRIANGLE_STRIP: {
+                    _grid->GetCellPoints(c, ids);
+                    const vtkIdType n = ids->GetNumberOfIds();
+                    for (vtkIdType i = 0; i + 1 < n; ++i) {
+                        emit(ids->GetId(i), ids->GetId(i + 1));
+                        if (i + 2 < n) emit(ids->GetId(i), ids->GetId(i + 2));
+                    }
+                    break;
+                }
+                default: {
+                    // Higher-order and other cells: walk each edge from one
+                    // end through its mid-edge nodes to the other end
+                    // (edge point order is end, end, interior...).
+                    _grid->GetCell(c, generic);
+                    for (int e = 0; e < generic->GetNumberOfEdges(); ++e) {
+                        vtkIdList* edge_ids = generic->GetEdge(e)->GetPointIds();
+                        const vtkIdType n = edge_ids->GetNumberOfIds();
+                        if (n < 2) continue;
+
+                        vtkIdType previous = edge_ids->GetId(0);
+                        for (vtkIdType i = 2; i < n; ++i) {
+                            emit(previous, edge_ids->GetId(i));
+                            previous = edge_ids->GetId(i);
+                        }
+                        emit(previous, edge_ids->GetId(1));
+                    }
+                    break;
+                }
+            }
         }
+    });
+
+    // ---- Merge, sort and deduplicate (shared faces repeat edges) ------
+    size_t total = 0;
+    for (auto it = thread_edges.begin(); it != thread_edges.end(); ++it)
+        total += it->size();
+
+    std::vector<std::uint64_t> edges;
+    edges.reserve(total);
+    for (auto it = thread_edges.begin(); it != thread_edges.end(); ++it) {
+        edges.insert(edges.end(), it->begin(), it->end());
+        std::vector<std::uint64_t>().swap(*it);
     }
+
+    vtkSMPTools::Sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    edges.shrink_to_fit();
+    return edges;
 }
 
 void LaVolumeGraphTraversal::Build() {
@@ -71,27 +220,160 @@ void LaVolumeGraphTraversal::Build() {
         return;
     }
 
+    ReleaseWorkspaces();     // sized to the previous graph
+
     _num_nodes = _grid->GetNumberOfPoints();
-    _adj.assign(static_cast<size_t>(_num_nodes), {});
+    if (_num_nodes > static_cast<vtkIdType>(std::numeric_limits<NodeIndex>::max())) {
+        std::cerr << "LaVolumeGraphTraversal::Build — " << _num_nodes
+                  << " points exceed the 32-bit node index." << std::endl;
+        _num_nodes = 0;
+        return;
+    }
 
-    const vtkIdType num_cells = _grid->GetNumberOfCells();
-    for (vtkIdType c = 0; c < num_cells; ++c) {
-        vtkSmartPointer<vtkIdList> point_ids =
-            vtkSmartPointer<vtkIdList>::New();
-        _grid->GetCellPoints(c, point_ids);
-        InsertCellEdges(point_ids);
+    const std::vector<std::uint64_t> edges = CollectCellEdges();
+    const size_t n = static_cast<size_t>(_num_nodes);
+
+    // ---- Degrees -> offsets -------------------------------------------
+    _offsets.assign(n + 1, 0);
+    for (const std::uint64_t key : edges) {
+        ++_offsets[static_cast<size_t>(key >> 32) + 1];
+        ++_offsets[static_cast<size_t>(key & 0xffffffffu) + 1];
+    }
+    std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+
+    // ---- Scatter both directions --------------------------------------
+    // Keys are sorted by (low, high), so node u first receives its lower
+    // neighbours in increasing order, then its higher ones: every row
+    // comes out sorted without a further pass.
+    _targets.resize(_offsets.back());
+    std::vector<size_t> cursor(_offsets.begin(), _offsets.end() - 1);
+    for (const std::uint64_t key : edges) {
+        const NodeIndex a = static_cast<NodeIndex>(key >> 32);
+        const NodeIndex b = static_cast<NodeIndex>(key & 0xffffffffu);
+        _targets[cursor[static_cast<size_t>(a)]++] = b;
+        _targets[cursor[static_cast<size_t>(b)]++] = a;
     }
 
-    // Deduplicate edges per node (multiple cells may share the same edge)
-    for (auto& neighbours : _adj) {
-        sort(neighbours.begin(), neighbours.end());
-        neighbours.erase(unique(neighbours.begin(), neighbours.end()),
-                         neighbours.end());
+    // ---- Weights -------------------------------------------------------
+    _weights.resize(_targets.size());
+    if (_weight_mode == EdgeWeight::Euclidean) {
+        vtkSMPTools::For(0, _num_nodes, [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType u = begin; u < end; ++u) {
+                double pu[3], pv[3];
+                _grid->GetPoint(u, pu);
+                for (size_t k = _offsets[static_cast<size_t>(u)];
+                     k < _offsets[static_cast<size_t>(u) + 1]; ++k) {
+                    _grid->GetPoint(_targets[k], pv);
+                    _weights[k] = static_cast<float>(Euclidean(pu, pv));
+                }
+            }
+        });
+    } else {
+        std::fill(_weights.begin(), _weights.end(), 1.0f);
     }
 
     _built = true;
+    _edge_stats_valid = false;
     std::cout << "LaVolumeGraphTraversal::Build complete — "
-         << _num_nodes << " nodes, " << num_cells << " cells." << std::endl;
+         << _num_nodes << " nodes, " << edges.size() << " edges, "
+         << _grid->GetNumberOfCells() << " cells." << std::endl;
+}
+
+
+// ============================================================
+// Radix heap + query workspace
+// ============================================================
+
+namespace {
+
+std::uint32_t KeyBits(float key) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &key, sizeof(bits));
+    return bits;
+}
+
+float KeyValue(std::uint32_t bits) {
+    float key;
+    std::memcpy(&key, &bits, sizeof(key));
+    return key;
+}
+
+// Index of the highest set bit, plus one (0 for x == 0)
+int BitLength(std::uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? 32 - __builtin_clz(x) : 0;
+#else
+    int length = 0;
+    while (x) { ++length; x >>= 1; }
+    return length;
+#endif
+}
+
+} // namespace
+
+LaVolumeGraphTraversal::RadixHeap::RadixHeap() :
+    _last(0),
+    _size(0) {}
+
+void LaVolumeGraphTraversal::RadixHeap::Push(float key, NodeIndex node) {
+    const std::uint32_t bits = KeyBits(key);
+    _buckets[BitLength(bits ^ _last)].push_back({bits, node});
+    ++_size;
+}
+
+LaVolumeGraphTraversal::NodeIndex LaVolumeGraphTraversal::RadixHeap::Pop(float& key) {
+    if (_buckets[0].empty()) {
+        int b = 1;
+        while (_buckets[b].empty()) ++b;
+
+        // Every key in the first non-empty bucket shares the bits above
+        // b - 1 with each other, so redistributing around their minimum
+        // sends each one to a strictly lower bucket.
+        auto& bucket = _buckets[b];
+        _last = std::min_element(bucket.begin(), bucket.end())->first;
+        for (const auto& entry : bucket)
+            _buckets[BitLength(entry.first ^ _last)].push_back(entry);
+        bucket.clear();
+    }
+
+    const auto entry = _buckets[0].back();
+    _buckets[0].pop_back();
+    --_size;
+    key = KeyValue(entry.first);
+    return entry.second;
+}
+
+void LaVolumeGraphTraversal::RadixHeap::Clear() {
+    for (auto& bucket : _buckets) bucket.clear();
+    _last = 0;
+    _size = 0;
+}
+
+LaVolumeGraphTraversal::QueryWorkspace& LaVolumeGraphTraversal::LocalWorkspace(
+    unsigned parts) const {
+    QueryWorkspace& ws = _workspaces.Local();
+    const size_t n = static_cast<size_t>(_num_nodes);
+
+    // Workspaces are left clean by every query, so only the first query
+    // of a kind, or a change of graph size, needs a fresh allocation.
+    if ((parts & DijkstraState) && ws.dist.size() != n) {
+        ws.dist.assign(n, std::numeric_limits<float>::infinity());
+        ws.predecessor.assign(n, -1);
+        ws.origin.assign(n, -1);
+        ws.target.assign(n, 0);
+        ws.touched.clear();
+        ws.heap.Clear();
+    }
+    if ((parts & BFSState) && ws.stamp.size() != n) {
+        ws.stamp.assign(n, 0);
+        ws.generation = 0;
+        ws.queue.assign(n, -1);
+    }
+    return ws;
+}
+
+void LaVolumeGraphTraversal::ReleaseWorkspaces() {
+    for (QueryWorkspace& ws : _workspaces) ws = QueryWorkspace();
 }
 
 
@@ -101,57 +383,208 @@ void LaVolumeGraphTraversal::Build() {
 
 std::vector<vtkIdType> LaVolumeGraphTraversal::ShortestPath(vtkIdType start_id,
                                                         vtkIdType end_id) const {
+    std::vector<std::vector<vtkIdType>> paths = ShortestPaths(start_id, {end_id});
+    if (paths.empty() || paths[0].empty()) {
+        if (_built) {
+            std::cerr << "LaVolumeGraphTraversal::ShortestPath — no path from "
+                 << start_id << " to " << end_id << std::endl;
+        }
+        return {};
+    }
+    return std::move(paths[0]);
+}
+
+std::vector<std::vector<vtkIdType>> LaVolumeGraphTraversal::ShortestPaths(
+    vtkIdType                     source_id,
+    const std::vector<vtkIdType>& target_ids) const {
+
     if (!_built) {
         std::cerr << "LaVolumeGraphTraversal::ShortestPath — graph not built. "
                 "Call Build() first." << std::endl;
         return {};
     }
 
-    const size_t n = static_cast<size_t>(_num_nodes);
-    constexpr double inf = std::numeric_limits<double>::infinity();
+    std::vector<std::vector<vtkIdType>> paths(target_ids.size());
+    if (source_id < 0 || source_id >= _num_nodes) {
+        std::cerr << "LaVolumeGraphTraversal::ShortestPaths — source "
+                  << source_id << " out of range." << std::endl;
+        return paths;
+    }
 
-    std::vector<double>    dist(n, inf);
-    std::vector<vtkIdType> predecessor(n, -1);
+    QueryWorkspace& ws = LocalWorkspace(DijkstraState);
+    constexpr float inf = std::numeric_limits<float>::infinity();
 
-    // Min-heap: (distance, node_id)
-    std::priority_queue<std::pair<double, vtkIdType>,
-                   std::vector<std::pair<double, vtkIdType>>,
-                   std::greater<std::pair<double, vtkIdType>>> pq;
+    // ---- Mark targets ---------------------------------------------------
+    size_t remaining = 0;
+    for (const vtkIdType t : target_ids) {
+        if (t < 0 || t >= _num_nodes) continue;
+        unsigned char& mark = ws.target[static_cast<size_t>(t)];
+        if (!mark) { mark = 1; ++remaining; }
+    }
 
-    dist[static_cast<size_t>(start_id)] = 0.0;
-    pq.push({0.0, start_id});
+    // ---- Search until every target is settled ---------------------------
+    if (remaining > 0) {
+        SeedDijkstra(ws, static_cast<NodeIndex>(source_id));
+        RunDijkstra(ws, inf, remaining);
+    }
 
-    while (!pq.empty()) {
-        const auto [d, u] = pq.top();
-        pq.pop();
+    // ---- Reconstruct paths ----------------------------------------------
+    for (size_t i = 0; i < target_ids.size(); ++i) {
+        const vtkIdType t = target_ids[i];
+        if (t < 0 || t >= _num_nodes) continue;
+        if (ws.dist[static_cast<size_t>(t)] == inf) continue;
 
-        if (d > dist[static_cast<size_t>(u)]) continue; // stale entry
-        if (u == end_id) break;                          // early exit
+        std::vector<vtkIdType>& path = paths[i];
+        for (NodeIndex cur = static_cast<NodeIndex>(t); cur != -1;
+             cur = ws.predecessor[static_cast<size_t>(cur)]) {
+            path.push_back(cur);
+        }
+        std::reverse(path.begin(), path.end());
+    }
+
+    for (const vtkIdType t : target_ids) {
+        if (t >= 0 && t < _num_nodes) ws.target[static_cast<size_t>(t)] = 0;
+    }
+    ResetDijkstra(ws);
+
+    return paths;
+}
+
+
+// ============================================================
+// GetDistanceToPoints — multi-source Dijkstra with cutoff
+// ============================================================
 
-        for (const auto& [v, w] : _adj[static_cast<size_t>(u)]) {
-            const double new_dist = dist[static_cast<size_t>(u)] + w;
-            if (new_dist < dist[static_cast<size_t>(v)]) {
-                dist[static_cast<size_t>(v)] = new_dist;
-                predecessor[static_cast<size_t>(v)] = u;
-                pq.push({new_dist, v});
+void LaVolumeGraphTraversal::GetDistanceToPoints(
+    const std::vector<vtkIdType>& source_ids,
+    double                        max_distance,
+    std::vector<float>&           distance,
+    std::vector<vtkIdType>&       nearest_source) const {
+
+    if (!_built) {
+        std::cerr << "LaVolumeGraphTraversal::GetDistanceToPoints — "
+                "graph not built." << std::endl;
+        distance.clear();
+        nearest_source.clear();
+        return;
+    }
+
+    const size_t n = static_cast<size_t>(_num_nodes);
+    distance.assign(n, -1.0f);
+    nearest_source.assign(n, -1);
+
+    std::vector<NodeIndex> sources;
+    sources.reserve(source_ids.size());
+    for (const vtkIdType s : source_ids) {
+        if (s >= 0 && s < _num_nodes) sources.push_back(static_cast<NodeIndex>(s));
+    }
+    if (sources.empty()) return;
+
+    const float cutoff = (max_distance > 0.0)
+        ? static_cast<float>(max_distance)
+        : std::numeric_limits<float>::infinity();
+
+    // Sources are split into one group per thread; each group is a single
+    // multi-source search, and the groups are merged by minimum distance.
+    struct Reached {
+        NodeIndex node;
+        NodeIndex source;
+        float     dist;
+    };
+    vtkSMPThreadLocal<std::vector<Reached>> thread_reached;
+
+    const vtkIdType num_sources = static_cast<vtkIdType>(sources.size());
+    const vtkIdType num_threads =
+        std::max<vtkIdType>(1, vtkSMPTools::GetEstimatedNumberOfThreads());
+    const vtkIdType grain = (num_sources + num_threads - 1) / num_threads;
+
+    vtkSMPTools::For(0, num_sources, grain, [&](vtkIdType begin, vtkIdType end) {
+        QueryWorkspace& ws = LocalWorkspace(DijkstraState);
+        std::vector<Reached>& reached = thread_reached.Local();
+
+        for (vtkIdType i = begin; i < end; ++i)
+            SeedDijkstra(ws, sources[static_cast<size_t>(i)]);
+        RunDijkstra(ws, cutoff, 0);
+
+        for (const NodeIndex v : ws.touched) {
+            reached.push_back({v, ws.origin[static_cast<size_t>(v)],
+                               ws.dist[static_cast<size_t>(v)]});
+        }
+        ResetDijkstra(ws);
+    });
+
+    for (auto it = thread_reached.begin(); it != thread_reached.end(); ++it) {
+        for (const Reached& r : *it) {
+            float&     d   = distance[static_cast<size_t>(r.node)];
+            vtkIdType& src = nearest_source[static_cast<size_t>(r.node)];
+            // Ties go to the lower source id, independent of thread order
+            if (d < 0.0f || r.dist < d || (r.dist == d && r.source < src)) {
+                d   = r.dist;
+                src = r.source;
             }
         }
     }
+}
 
-    // Reconstruct path
-    std::vector<vtkIdType> path;
-    if (dist[static_cast<size_t>(end_id)] == inf) {
-        std::cerr << "LaVolumeGraphTraversal::ShortestPath — no path from "
-             << start_id << " to " << end_id << std::endl;
-        return {};
+
+// ============================================================
+// Dijkstra core
+// ============================================================
+
+void LaVolumeGraphTraversal::SeedDijkstra(QueryWorkspace& ws, NodeIndex source) const {
+    float& dist = ws.dist[static_cast<size_t>(source)];
+    if (dist == 0.0f) return;                        // duplicate source
+
+    if (dist == std::numeric_limits<float>::infinity()) ws.touched.push_back(source);
+    dist = 0.0f;
+    ws.origin[static_cast<size_t>(source)] = source;
+    ws.heap.Push(0.0f, source);
+}
+
+void LaVolumeGraphTraversal::RunDijkstra(QueryWorkspace& ws,
+                                         float           cutoff,
+                                         size_t          remaining) const {
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    const bool stop_at_targets = (remaining > 0);
+
+    while (!ws.heap.Empty()) {
+        float d;
+        const NodeIndex u = ws.heap.Pop(d);
+        if (d > ws.dist[static_cast<size_t>(u)]) continue;   // stale entry
+
+        unsigned char& mark = ws.target[static_cast<size_t>(u)];
+        if (mark == 1) {                                      // settled
+            mark = 2;
+            if (stop_at_targets && --remaining == 0) break;
+        }
+
+        const NodeIndex origin = ws.origin[static_cast<size_t>(u)];
+        for (size_t k = _offsets[static_cast<size_t>(u)];
+             k < _offsets[static_cast<size_t>(u) + 1]; ++k) {
+            const NodeIndex v = _targets[k];
+            const float new_dist = d + _weights[k];
+            if (new_dist > cutoff) continue;
+
+            float& dist_v = ws.dist[static_cast<size_t>(v)];
+            if (new_dist < dist_v) {
+                if (dist_v == inf) ws.touched.push_back(v);
+                dist_v = new_dist;
+                ws.predecessor[static_cast<size_t>(v)] = u;
+                ws.origin[static_cast<size_t>(v)]      = origin;
+                ws.heap.Push(new_dist, v);
+            }
+        }
     }
+}
 
-    for (vtkIdType cur = end_id; cur != -1;
-        cur = predecessor[static_cast<size_t>(cur)]) {
-        path.push_back(cur);
+void LaVolumeGraphTraversal::ResetDijkstra(QueryWorkspace& ws) const {
+    // Lazy reset: restore only what the query changed
+    for (const NodeIndex v : ws.touched) {
+        ws.dist[static_cast<size_t>(v)]        = std::numeric_limits<float>::infinity();
+        ws.predecessor[static_cast<size_t>(v)] = -1;
     }
-    std::reverse(path.begin(), path.end());
-    return path;
+    ws.touched.clear();
+    ws.heap.Clear();
 }
 
 
@@ -159,41 +592,259 @@ std::vector<vtkIdType> LaVolumeGraphTraversal::ShortestPath(vtkIdType start_id,
 // GetNeighboursAroundPoint — BFS
 // ============================================================
 
+void LaVolumeGraphTraversal::NextGeneration(QueryWorkspace& ws) {
+    if (++ws.generation == 0) {
+        std::fill(ws.stamp.begin(), ws.stamp.end(), 0u);
+        ws.generation = 1;
+    }
+}
+
+size_t LaVolumeGraphTraversal::ExpandBFS(QueryWorkspace& ws,
+                                         size_t          num_seeds,
+                                         int             max_hops,
+                                         vtkIdType*      nearest_source) const {
+    size_t head = 0;
+    size_t tail = num_seeds;
+
+    ws.level_starts.assign(1, 0);
+    for (int depth = 0; depth < max_hops && head < tail; ++depth) {
+        const size_t level_end = tail;
+        ws.level_starts.push_back(level_end);
+
+        for (; head < level_end; ++head) {
+            const NodeIndex u = ws.queue[head];
+            for (size_t k = _offsets[static_cast<size_t>(u)];
+                 k < _offsets[static_cast<size_t>(u) + 1]; ++k) {
+                const NodeIndex v = _targets[k];
+                std::uint32_t& stamp = ws.stamp[static_cast<size_t>(v)];
+                if (stamp == ws.generation) continue;
+
+                stamp = ws.generation;
+                ws.queue[tail++] = v;
+                if (nearest_source) {
+                    nearest_source[v] = nearest_source[u];
+                }
+            }
+        }
+    }
+    ws.level_starts.push_back(tail);    // sentinel: end of the last level
+    return tail;
+}
+
 std::vector<std::pair<vtkIdType, int>> LaVolumeGraphTraversal::GetNeighboursAroundPoint(
     vtkIdType point_id,
     int       max_hops) const {
 
+    std::vector<std::pair<vtkIdType, int>> result;
+    GetNeighboursAroundPoint(point_id, max_hops, result);
+    return result;
+}
+
+void LaVolumeGraphTraversal::GetNeighboursAroundPoint(
+    vtkIdType point_id,
+    int       max_hops,
+    std::vector<std::pair<vtkIdType, int>>& result) const {
+
+    result.clear();
     if (!_built) {
         std::cerr << "LaVolumeGraphTraversal::GetNeighboursAroundPoint — "
                 "graph not built." << std::endl;
-        return {};
+        return;
+    }
+    if (point_id < 0 || point_id >= _num_nodes) {
+        std::cerr << "LaVolumeGraphTraversal::GetNeighboursAroundPoint — point "
+                  << point_id << " out of range." << std::endl;
+        return;
     }
 
-    std::vector<std::pair<vtkIdType, int>> result;
-    std::unordered_map<vtkIdType, int> visited;
+    QueryWorkspace& ws = LocalWorkspace(BFSState);
+    NextGeneration(ws);
+
+    ws.queue[0] = static_cast<NodeIndex>(point_id);
+    ws.stamp[static_cast<size_t>(point_id)] = ws.generation;
+
+    const size_t visited = ExpandBFS(ws, 1, max_hops, nullptr);
+
+    result.reserve(visited);
+    for (size_t depth = 0; depth + 1 < ws.level_starts.size(); ++depth) {
+        for (size_t i = ws.level_starts[depth]; i < ws.level_starts[depth + 1]; ++i) {
+            result.push_back({ws.queue[i], static_cast<int>(depth)});
+        }
+    }
+}
+
+void LaVolumeGraphTraversal::GetNeighboursAroundPoint(
+    vtkIdType point_id,
+    int       max_hops,
+    std::vector<std::pair<vtkIdType, int>>& result,
+    std::vector<float>& distance) const {
+
+    distance.clear();
+    GetNeighboursAroundPoint(point_id, max_hops, result);
+    if (result.empty()) return;
+
+    // Dijkstra over the nodes the BFS just stamped; the ball is connected
+    // through them, so every node of result is reached.
+    constexpr float inf = std::numeric_limits<float>::infinity();
+    QueryWorkspace& ws = LocalWorkspace(DijkstraState | BFSState);
+    SeedDijkstra(ws, static_cast<NodeIndex>(point_id));
+
+    while (!ws.heap.Empty()) {
+        float d;
+        const NodeIndex u = ws.heap.Pop(d);
+        if (d > ws.dist[static_cast<size_t>(u)]) continue;   // stale entry
+
+        for (size_t k = _offsets[static_cast<size_t>(u)];
+             k < _offsets[static_cast<size_t>(u) + 1]; ++k) {
+            const NodeIndex v = _targets[k];
+            if (ws.stamp[static_cast<size_t>(v)] != ws.generation) continue;
+
+            const float new_dist = d + _weights[k];
+            float& dist_v = ws.dist[static_cast<size_t>(v)];
+            if (new_dist < dist_v) {
+                if (dist_v == inf) ws.touched.push_back(v);
+                dist_v = new_dist;
+                ws.predecessor[static_cast<size_t>(v)] = u;
+                ws.heap.Push(new_dist, v);
+            }
+        }
+    }
+
+    distance.resize(result.size());
+    for (size_t i = 0; i < result.size(); ++i)
+        distance[i] = ws.dist[static_cast<size_t>(result[i].first)];
+    ResetDijkstra(ws);
+}
+
+void LaVolumeGraphTraversal::GetNeighboursAroundPoints(
+    const std::vector<vtkIdType>& source_ids,
+    int                           max_hops,
+    std::vector<int>&             hops,
+    std::vector<vtkIdType>&       nearest_source) const {
+
+    if (!_built) {
+        std::cerr << "LaVolumeGraphTraversal::GetNeighboursAroundPoints — "
+                "graph not built." << std::endl;
+        hops.clear();
+        nearest_source.clear();
+        return;
+    }
+
+    const size_t n = static_cast<size_t>(_num_nodes);
+    hops.assign(n, -1);
+    nearest_source.assign(n, -1);
 
-    // BFS queue: (node_id, depth)
-    std::queue<std::pair<vtkIdType, int>> bfs;
-    bfs.push({point_id, 0});
-    visited[point_id] = 0;
+    QueryWorkspace& ws = LocalWorkspace(BFSState);
+    NextGeneration(ws);
 
-    while (!bfs.empty()) {
-        const auto [node, depth] = bfs.front();
-        bfs.pop();
+    size_t num_seeds = 0;
+    for (const vtkIdType s : source_ids) {
+        if (s < 0 || s >= _num_nodes) continue;
+        std::uint32_t& stamp = ws.stamp[static_cast<size_t>(s)];
+        if (stamp == ws.generation) continue;     // duplicate source
 
-        result.push_back({node, depth});
+        stamp = ws.generation;
+        ws.queue[num_seeds++] = static_cast<NodeIndex>(s);
+        nearest_source[static_cast<size_t>(s)] = s;
+    }
 
-        if (depth >= max_hops) continue;
+    ExpandBFS(ws, num_seeds, max_hops, nearest_source.data());
 
-        for (const auto& [neighbour, weight] : _adj[static_cast<size_t>(node)]) {
-            if (visited.find(neighbour) == visited.end()) {
-                visited[neighbour] = depth + 1;
-                bfs.push({neighbour, depth + 1});
+    for (size_t depth = 0; depth + 1 < ws.level_starts.size(); ++depth) {
+        for (size_t i = ws.level_starts[depth]; i < ws.level_starts[depth + 1]; ++i) {
+            hops[static_cast<size_t>(ws.queue[i])] = static_cast<int>(depth);
+        }
+    }
+}
+
+
+// ============================================================
+// Edge statistics
+// ============================================================
+
+void LaVolumeGraphTraversal::ComputeEdgeStatistics() {
+    const size_t n = static_cast<size_t>(_num_nodes);
+
+    // Rows are sorted, so the edges a node owns (v > u) are the tail of
+    // its row and every unique edge is counted once; local sums cover
+    // both directions.
+    std::vector<size_t> owned_offsets(n + 1, 0);
+    for (size_t u = 0; u < n; ++u) {
+        const NodeIndex* row_begin = _targets.data() + _offsets[u];
+        const NodeIndex* row_end   = _targets.data() + _offsets[u + 1];
+        const NodeIndex* owned = std::upper_bound(row_begin, row_end,
+                                                  static_cast<NodeIndex>(u));
+        owned_offsets[u + 1] = owned_offsets[u] +
+                               static_cast<size_t>(row_end - owned);
+    }
+
+    std::vector<double> lengths(owned_offsets[n]);
+    _edge_stats.local.assign(n, 0.0);
+
+    const bool euclidean = (_weight_mode == EdgeWeight::Euclidean);
+
+    vtkSMPTools::For(0, _num_nodes, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType u = begin; u < end; ++u) {
+            const size_t first = _offsets[static_cast<size_t>(u)];
+            const size_t last  = _offsets[static_cast<size_t>(u) + 1];
+            if (first == last) continue;
+
+            double pu[3];
+            if (!euclidean) _grid->GetPoint(u, pu);
+
+            size_t owned = owned_offsets[static_cast<size_t>(u)];
+            double local_sum = 0.0;
+            for (size_t k = first; k < last; ++k) {
+                const vtkIdType v = _targets[k];
+                double length = _weights[k];
+                if (!euclidean) {
+                    double pv[3];
+                    _grid->GetPoint(v, pv);
+                    length = Euclidean(pu, pv);
+                }
+                local_sum += length;
+                if (v > u) lengths[owned++] = length;
             }
+            _edge_stats.local[static_cast<size_t>(u)] =
+                local_sum / static_cast<double>(last - first);
         }
+    });
+
+    _edge_stats.num_edges = lengths.size();
+    if (lengths.empty()) {
+        _edge_stats.mean = _edge_stats.median = 1.0;   // avoid /0 downstream
+        _edge_stats.min  = _edge_stats.max    = 0.0;
+    } else {
+        _edge_stats.mean = std::accumulate(lengths.begin(), lengths.end(), 0.0) /
+                           static_cast<double>(lengths.size());
+        const auto [min_it, max_it] = std::minmax_element(lengths.begin(), lengths.end());
+        _edge_stats.min = *min_it;
+        _edge_stats.max = *max_it;
+
+        auto mid = lengths.begin() + static_cast<std::ptrdiff_t>(lengths.size() / 2);
+        std::nth_element(lengths.begin(), mid, lengths.end());
+        _edge_stats.median = *mid;
     }
 
-    return result;
+    _edge_stats_valid = true;
+    std::cout << "LaVolumeGraphTraversal: " << _edge_stats.num_edges
+              << " edges, mean length " << _edge_stats.mean
+              << ", median " << _edge_stats.median << std::endl;
+}
+
+const LaVolumeGraphTraversal::EdgeStatistics&
+LaVolumeGraphTraversal::GetEdgeStatistics() {
+    if (!_built) {
+        std::cerr << "LaVolumeGraphTraversal::GetEdgeStatistics — graph not built. "
+                "Call Build() first." << std::endl;
+    } else if (!_edge_stats_valid) {
+        ComputeEdgeStatistics();
+    }
+    return _edge_stats;
+}
+
+double LaVolumeGraphTraversal::HopsToDistance(int hops) {
+    return GetEdgeStatistics().mean * hops;
 }
 
 
@@ -205,6 +856,10 @@ vtkIdType LaVolumeGraphTraversal::GetNumberOfNodes() const {
     return _num_nodes;
 }
 
+size_t LaVolumeGraphTraversal::GetNumberOfEdges() const {
+    return _targets.size() / 2;
+}
+
 double LaVolumeGraphTraversal::Euclidean(const double* a, const double* b) {
     const double dx = a[0] - b[0];
     const double dy = a[1] - b[1];
@@ -0,0 +1,350 @@
+#define HAS_VTK 1
+
+#include <iostream>
+#include <algorithm>
+#include <utility>
+
+#include <vtkCellData.h>
+#include <vtkDataSetAttributes.h>
+#include <vtkIdList.h>
+#include <vtkIdTypeArray.h>
+#include <vtkPointData.h>
+#include <vtkPoints.h>
+#include <vtkSMPTools.h>
+#include <vtkSMPThreadLocalObject.h>
+#include <vtkUnsignedCharArray.h>
+
+#include "../include/LaVolumePartition.h"
+
+
+// ============================================================
+// Morton codes
+// ============================================================
+
+namespace {
+
+// Spreads the low 21 bits of v so they occupy every third bit
+std::uint64_t SpreadBits(std::uint32_t v) {
+    std::uint64_t x = v & 0x1fffffu;
+    x = (x | x << 32) & 0x001f00000000ffffull;
+    x = (x | x << 16) & 0x001f0000ff0000ffull;
+    x = (x | x << 8)  & 0x100f00f00f00f00full;
+    x = (x | x << 4)  & 0x10c30c30c30c30c3ull;
+    x = (x | x << 2)  & 0x1249249249249249ull;
+    return x;
+}
+
+const double kMortonScale = static_cast<double>((1u << 21) - 1);
+
+} // namespace
+
+std::uint64_t LaVolumePartition::MortonCode(std::uint32_t x,
+                                            std::uint32_t y,
+                                            std::uint32_t z) {
+    return SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+}
+
+
+// ============================================================
+// Constructor / setup
+// ============================================================
+
+LaVolumePartition::LaVolumePartition() :
+    _num_chunks(8),
+    _ghost_layers(1) {}
+
+void LaVolumePartition::SetInputGrid(vtkUnstructuredGrid* grid) {
+    _grid = grid;
+}
+
+void LaVolumePartition::SetNumberOfChunks(int num_chunks) {
+    _num_chunks = std::max(1, num_chunks);
+}
+
+void LaVolumePartition::SetGhostLayers(int layers) {
+    _ghost_layers = std::max(0, layers);
+}
+
+
+// ============================================================
+// Build
+// ============================================================
+
+void LaVolumePartition::Build() {
+    _cell_order.clear();
+    _chunk_offsets.clear();
+    _cell_chunk.clear();
+    _point_owner.clear();
+    _point_cell_offsets.clear();
+    _point_cells.clear();
+
+    if (!_grid || _grid->GetNumberOfCells() == 0) {
+        std::cerr << "LaVolumePartition::Build — no input grid or no cells." << std::endl;
+        return;
+    }
+
+    const vtkIdType num_cells = _grid->GetNumberOfCells();
+
+    SortCellsByMortonCode();
+
+    // ---- Equal cuts of the Morton order --------------------------------
+    const vtkIdType num_chunks = std::min<vtkIdType>(_num_chunks, num_cells);
+    _chunk_offsets.resize(static_cast<size_t>(num_chunks) + 1);
+    for (vtkIdType c = 0; c <= num_chunks; ++c)
+        _chunk_offsets[static_cast<size_t>(c)] = num_cells * c / num_chunks;
+
+    _cell_chunk.resize(static_cast<size_t>(num_cells));
+    for (vtkIdType c = 0; c < num_chunks; ++c) {
+        for (vtkIdType r = _chunk_offsets[static_cast<size_t>(c)];
+             r < _chunk_offsets[static_cast<size_t>(c) + 1]; ++r) {
+            _cell_chunk[static_cast<size_t>(_cell_order[static_cast<size_t>(r)])] =
+                static_cast<int>(c);
+        }
+    }
+
+    BuildPointCells();
+
+    // ---- Point ownership: chunk of the first incident cell -------------
+    // Incident cells are listed in Morton order, so the first one has the
+    // lowest rank.  Points used by no cell belong to no chunk.
+    const vtkIdType num_points = _grid->GetNumberOfPoints();
+    _point_owner.resize(static_cast<size_t>(num_points));
+    vtkSMPTools::For(0, num_points, [&](vtkIdType begin, vtkIdType end) {
+        for (vtkIdType p = begin; p < end; ++p) {
+            const vtkIdType first = _point_cell_offsets[static_cast<size_t>(p)];
+            const vtkIdType last  = _point_cell_offsets[static_cast<size_t>(p) + 1];
+            _point_owner[static_cast<size_t>(p)] = (first == last) ? -1 :
+                _cell_chunk[static_cast<size_t>(_point_cells[static_cast<size_t>(first)])];
+        }
+    });
+
+    std::cout << "LaVolumePartition::Build complete — " << num_chunks
+              << " chunks of ~" << num_cells / num_chunks << " cells, "
+              << _ghost_layers << " ghost layers." << std::endl;
+}
+
+void LaVolumePartition::SortCellsByMortonCode() {
+    const vtkIdType num_cells = _grid->GetNumberOfCells();
+
+    double bounds[6];
+    _grid->GetBounds(bounds);
+
+    double scale[3];
+    for (int k = 0; k < 3; ++k) {
+        const double extent = bounds[2 * k + 1] - bounds[2 * k];
+        scale[k] = (extent > 0.0) ? kMortonScale / extent : 0.0;
+    }
+
+    // Cell accessors are thread-safe once called from a single thread
+    {
+        vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+        _grid->GetCellPoints(0, ids);
+    }
+
+    std::vector<std::pair<std::uint64_t, vtkIdType>> keys(static_cast<size_t>(num_cells));
+    vtkSMPThreadLocalObject<vtkIdList> thread_ids;
+
+    vtkSMPTools::For(0, num_cells, [&](vtkIdType begin, vtkIdType end) {
+        vtkIdList* ids = thread_ids.Local();
+        for (vtkIdType c = begin; c < end; ++c) {
+            _grid->GetCellPoints(c, ids);
+            const vtkIdType n = ids->GetNumberOfIds();
+
+            double centroid[3] = {0.0, 0.0, 0.0};
+            for (vtkIdType k = 0; k < n; ++k) {
+                double x[3];
+                _grid->GetPoint(ids->GetId(k), x);
+                centroid[0] += x[0];
+                centroid[1] += x[1];
+                centroid[2] += x[2];
+            }
+
+            std::uint32_t q[3];
+            for (int k = 0; k < 3; ++k) {
+                const double mean = (n > 0) ? centroid[k] / static_cast<double>(n) : bounds[2 * k];
+                const double t = std::min(kMortonScale,
+                    std::max(0.0, (mean - bounds[2 * k]) * scale[k]));
+                q[k] = static_cast<std::uint32_t>(t);
+            }
+            keys[static_cast<size_t>(c)] = {MortonCode(q[0], q[1], q[2]), c};
+        }
+    });
+
+    // Ties broken by cell id, so the order does not depend on threading
+    vtkSMPTools::Sort(keys.begin(), keys.end());
+
+    _cell_order.resize(keys.size());
+    for (size_t r = 0; r < keys.size(); ++r) _cell_order[r] = keys[r].second;
+}
+
+void LaVolumePartition::BuildPointCells() {
+    const vtkIdType num_points = _grid->GetNumberOfPoints();
+    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+
+    _point_cell_offsets.assign(static_cast<size_t>(num_points) + 1, 0);
+    for (const vtkIdType c : _cell_order) {
+        _grid->GetCellPoints(c, ids);
+        for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k)
+            ++_point_cell_offsets[static_cast<size_t>(ids->GetId(k)) + 1];
+    }
+    for (size_t p = 1; p < _point_cell_offsets.size(); ++p)
+        _point_cell_offsets[p] += _point_cell_offsets[p - 1];
+
+    // Filled in Morton order: each point's cells come out sorted by rank
+    _point_cells.resize(static_cast<size_t>(_point_cell_offsets.back()));
+    std::vector<vtkIdType> cursor(_point_cell_offsets.begin(), _point_cell_offsets.end() - 1);
+    for (const vtkIdType c : _cell_order) {
+        _grid->GetCellPoints(c, ids);
+        for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
+            vtkIdType& pos = cursor[static_cast<size_t>(ids->GetId(k))];
+            _point_cells[static_cast<size_t>(pos++)] = c;
+        }
+    }
+}
+
+
+// ============================================================
+// Queries
+// ============================================================
+
+int LaVolumePartition::GetNumberOfChunks() const {
+    return _chunk_offsets.empty() ? 0 : static_cast<int>(_chunk_offsets.size() - 1);
+}
+
+const std::vector<vtkIdType>& LaVolumePartition::GetCellOrder() const {
+    return _cell_order;
+}
+
+vtkIdType LaVolumePartition::GetChunkOffset(int index) const {
+    return _chunk_offsets[static_cast<size_t>(index)];
+}
+
+int LaVolumePartition::GetPointOwner(vtkIdType point_id) const {
+    return _point_owner[static_cast<size_t>(point_id)];
+}
+
+void LaVolumePartition::ExtractChunk(int index, Chunk& chunk) const {
+    chunk.grid = vtkSmartPointer<vtkUnstructuredGrid>::New();
+    chunk.point_ids.clear();
+    chunk.cell_ids.clear();
+    chunk.owned_points.clear();
+    chunk.num_owned_cells = 0;
+
+    if (index < 0 || index >= GetNumberOfChunks()) {
+        std::cerr << "LaVolumePartition::ExtractChunk — chunk " << index
+                  << " out of range." << std::endl;
+        return;
+    }
+
+    vtkSmartPointer<vtkIdList> ids = vtkSmartPointer<vtkIdList>::New();
+
+    // ---- Owned cells, then ghost rings ---------------------------------
+    std::vector<unsigned char> cell_mark(static_cast<size_t>(_grid->GetNumberOfCells()), 0);
+    std::vector<unsigned char> point_mark(static_cast<size_t>(_grid->GetNumberOfPoints()), 0);
+
+    chunk.cell_ids.assign(_cell_order.begin() + _chunk_offsets[static_cast<size_t>(index)],
+                          _cell_order.begin() + _chunk_offsets[static_cast<size_t>(index) + 1]);
+    chunk.num_owned_cells = static_cast<vtkIdType>(chunk.cell_ids.size());
+    for (const vtkIdType c : chunk.cell_ids) cell_mark[static_cast<size_t>(c)] = 1;
+
+    size_t ring_begin = 0;
+    for (int layer = 0; layer < _ghost_layers; ++layer) {
+        const size_t ring_end = chunk.cell_ids.size();
+        for (size_t i = ring_begin; i < ring_end; ++i) {
+            _grid->GetCellPoints(chunk.cell_ids[i], ids);
+            for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k) {
+                const vtkIdType p = ids->GetId(k);
+                if (point_mark[static_cast<size_t>(p)]) continue;
+                point_mark[static_cast<size_t>(p)] = 1;
+
+                for (vtkIdType j = _point_cell_offsets[static_cast<size_t>(p)];
+                     j < _point_cell_offsets[static_cast<size_t>(p) + 1]; ++j) {
+                    const vtkIdType neighbour = _point_cells[static_cast<size_t>(j)];
+                    if (cell_mark[static_cast<size_t>(neighbour)]) continue;
+                    cell_mark[static_cast<size_t>(neighbour)] = 1;
+                    chunk.cell_ids.push_back(neighbour);
+                }
+            }
+        }
+        if (ring_end == chunk.cell_ids.size()) break;
+        ring_begin = ring_end;
+    }
+
+    // ---- Local points ------------------------------------------------
+    for (const vtkIdType c : chunk.cell_ids) {
+        _grid->GetCellPoints(c, ids);
+        for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k)
+            chunk.point_ids.push_back(ids->GetId(k));
+    }
+    std::sort(chunk.point_ids.begin(), chunk.point_ids.end());
+    chunk.point_ids.erase(std::unique(chunk.point_ids.begin(), chunk.point_ids.end()),
+                          chunk.point_ids.end());
+
+    const vtkIdType num_points = static_cast<vtkIdType>(chunk.point_ids.size());
+    const vtkIdType num_cells  = static_cast<vtkIdType>(chunk.cell_ids.size());
+
+    auto local_point = [&chunk](vtkIdType input_id) {
+        return static_cast<vtkIdType>(
+            std::lower_bound(chunk.point_ids.begin(), chunk.point_ids.end(), input_id) -
+            chunk.point_ids.begin());
+    };
+
+    // ---- Geometry and topology ---------------------------------------
+    vtkSmartPointer<vtkPoints> points = vtkSmartPointer<vtkPoints>::New();
+    points->SetDataType(_grid->GetPoints()->GetDataType());
+    points->SetNumberOfPoints(num_points);
+    for (vtkIdType i = 0; i < num_points; ++i)
+        points->SetPoint(i, _grid->GetPoint(chunk.point_ids[static_cast<size_t>(i)]));
+    chunk.grid->SetPoints(points);
+
+    chunk.grid->Allocate(num_cells);
+    for (const vtkIdType c : chunk.cell_ids) {
+        _grid->GetCellPoints(c, ids);
+        for (vtkIdType k = 0; k < ids->GetNumberOfIds(); ++k)
+            ids->SetId(k, local_point(ids->GetId(k)));
+        chunk.grid->InsertNextCell(_grid->GetCellType(c), ids);
+    }
+
+    // ---- Attributes, ghost flags and original ids ---------------------
+    vtkPointData* point_data = chunk.grid->GetPointData();
+    point_data->CopyAllocate(_grid->GetPointData(), num_points);
+    for (vtkIdType i = 0; i < num_points; ++i)
+        point_data->CopyData(_grid->GetPointData(), chunk.point_ids[static_cast<size_t>(i)], i);
+
+    vtkCellData* cell_data = chunk.grid->GetCellData();
+    cell_data->CopyAllocate(_grid->GetCellData(), num_cells);
+    for (vtkIdType i = 0; i < num_cells; ++i)
+        cell_data->CopyData(_grid->GetCellData(), chunk.cell_ids[static_cast<size_t>(i)], i);
+
+    vtkSmartPointer<vtkUnsignedCharArray> point_ghosts = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    vtkSmartPointer<vtkIdTypeArray> original_points    = vtkSmartPointer<vtkIdTypeArray>::New();
+    point_ghosts->SetName(vtkDataSetAttributes::GhostArrayName());
+    point_ghosts->SetNumberOfValues(num_points);
+    original_points->SetName("vtkOriginalPointIds");
+    original_points->SetNumberOfValues(num_points);
+
+    chunk.owned_points.resize(static_cast<size_t>(num_points));
+    for (vtkIdType i = 0; i < num_points; ++i) {
+        const vtkIdType input_id = chunk.point_ids[static_cast<size_t>(i)];
+        const bool owned = (_point_owner[static_cast<size_t>(input_id)] == index);
+        chunk.owned_points[static_cast<size_t>(i)] = owned ? 1 : 0;
+        point_ghosts->SetValue(i, owned ? 0 : vtkDataSetAttributes::DUPLICATEPOINT);
+        original_points->SetValue(i, input_id);
+    }
+    point_data->AddArray(point_ghosts);
+    point_data->AddArray(original_points);
+
+    vtkSmartPointer<vtkUnsignedCharArray> cell_ghosts = vtkSmartPointer<vtkUnsignedCharArray>::New();
+    vtkSmartPointer<vtkIdTypeArray> original_cells    = vtkSmartPointer<vtkIdTypeArray>::New();
+    cell_ghosts->SetName(vtkDataSetAttributes::GhostArrayName());
+    cell_ghosts->SetNumberOfValues(num_cells);
+    original_cells->SetName("vtkOriginalCellIds");
+    original_cells->SetNumberOfValues(num_cells);
+    for (vtkIdType i = 0; i < num_cells; ++i) {
+        cell_ghosts->SetValue(i, (i < chunk.num_owned_cells) ? 0 :
+                                 vtkDataSetAttributes::DUPLICATECELL);
+        original_cells->SetValue(i, chunk.cell_ids[static_cast<size_t>(i)]);
+    }
+    cell_data->AddArray(cell_ghosts);
+    cell_data->AddArray(original_cells);
+}
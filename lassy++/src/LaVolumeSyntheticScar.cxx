@@ -14,6 +14,7 @@
 #include <vtkPolyData.h>
 #include <vtkFloatArray.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
 
 #include "../include/LaVolumeSyntheticScar.h"
 
@@ -29,7 +30,10 @@ LaVolumeSyntheticScar::LaVolumeSyntheticScar() :
     _neighbourhood_size(15),
     _sigma(-1.0),
     _falloff(VolumeFalloffKernel::Gaussian),
-    _output_array_name("synthetic_scar") {}
+    _output_array_name("synthetic_scar"),
+    _geodesic_output(false),
+    _geodesic_kernels(false),
+    _num_partitions(1) {}
 
 
 // ============================================================
@@ -54,18 +58,33 @@ void LaVolumeSyntheticScar::SetSurfaceSeeds(
         return;
     }
 
-    vtkSmartPointer<vtkPolyData> surface_poly =
-        vtkSmartPointer<vtkPolyData>::New();
-    surface_shell->GetMesh3D(surface_poly);
+    vtkSmartPointer<vtkPolyData> surface_poly = surface_shell->GetMesh3DView();
+
+    _seed_node_ids.clear();
+    _seed_node_ids.reserve(surface_point_ids.size());
+
+    // Surfaces from LaVolume::ConvertToSurface carry their volume node
+    // ids — map directly, no spatial search.
+    vtkDataArray* original_ids =
+        surface_poly->GetPointData()->GetArray("vtkOriginalPointIds");
+    if (original_ids) {
+        for (const int surface_id : surface_point_ids) {
+            if (surface_id < 0 || surface_id >= original_ids->GetNumberOfTuples())
+                continue;
+            _seed_node_ids.push_back(
+                static_cast<vtkIdType>(original_ids->GetComponent(surface_id, 0)));
+        }
+        std::cout << "LaVolumeSyntheticScar: mapped "
+                  << surface_point_ids.size() << " surface seeds to "
+                  << _seed_node_ids.size() << " volumetric nodes by id." << std::endl;
+        return;
+    }
 
     vtkSmartPointer<vtkPointLocator> locator =
         vtkSmartPointer<vtkPointLocator>::New();
     locator->SetDataSet(_source_volume->GetGridPointer());
     locator->BuildLocator();
 
-    _seed_node_ids.clear();
-    _seed_node_ids.reserve(surface_point_ids.size());
-
     for (const int surface_id : surface_point_ids) {
         double pt[3];
         surface_poly->GetPoint(surface_id, pt);
@@ -188,27 +207,27 @@ void LaVolumeSyntheticScar::SetOutputArrayName(const char* name) {
     _output_array_name = std::string(name);
 }
 
+const std::string& LaVolumeSyntheticScar::GetOutputArrayName() const {
+    return _output_array_name;
+}
 
-// ============================================================
-// Private helpers
-// ============================================================
+void LaVolumeSyntheticScar::SetGeodesicDistanceOutput(bool enable) {
+    _geodesic_output = enable;
+}
 
-double LaVolumeSyntheticScar::EvaluateFalloff(double d, double max_d) const {
-    if (max_d <= 0.0) return 1.0;
+void LaVolumeSyntheticScar::SetGeodesicKernelDistance(bool enable) {
+    _geodesic_kernels = enable;
+}
 
-    switch (_falloff) {
-        case VolumeFalloffKernel::Gaussian: {
-            const double effective_sigma =
-                (_sigma > 0.0) ? _sigma : (max_d / 2.0);
-            return exp(-(d * d) / (2.0 * effective_sigma * effective_sigma));
-        }
-        case VolumeFalloffKernel::Linear: {
-            return std::max(0.0, 1.0 - (d / max_d));
-        }
-    }
-    return 0.0;
+void LaVolumeSyntheticScar::SetNumberOfPartitions(int num_partitions) {
+    _num_partitions = std::max(1, num_partitions);
 }
 
+
+// ============================================================
+// Private helpers
+// ============================================================
+
 std::string LaVolumeSyntheticScar::UniqueArrayName(
     vtkUnstructuredGrid* grid,
     const std::string& candidate) {
@@ -234,29 +253,143 @@ std::string LaVolumeSyntheticScar::UniqueArrayName(
     }
 }
 
-double LaVolumeSyntheticScar::EstimateMeanEdgeLength() const {
-    vtkUnstructuredGrid* grid = _source_volume->GetGridPointer();
-    const int sample_count = std::min(
-        static_cast<int>(grid->GetNumberOfPoints()), 200);
+std::vector<vtkIdType> LaVolumeSyntheticScar::BuildPathVertices() const {
+    std::map<vtkIdType, int> path_vertex_map;
+    const int num_seeds = static_cast<int>(_seed_node_ids.size());
+
+    // Loop segments are independent searches — run them in parallel,
+    // each thread reusing its graph workspace.
+    std::vector<std::vector<vtkIdType>> segments(static_cast<size_t>(num_seeds));
+    vtkSMPTools::For(0, static_cast<vtkIdType>(num_seeds),
+        [&](vtkIdType begin, vtkIdType end) {
+            for (vtkIdType i = begin; i < end; ++i) {
+                const vtkIdType start = _seed_node_ids[static_cast<size_t>(i)];
+                const vtkIdType stop  =
+                    _seed_node_ids[static_cast<size_t>((i + 1) % num_seeds)];
+                segments[static_cast<size_t>(i)] = _graph->ShortestPath(start, stop);
+            }
+        });
+
+    for (const auto& path : segments) {
+        for (const vtkIdType v : path) {
+            path_vertex_map.insert({v, 1});
+        }
+    }
 
-    double total = 0.0;
-    int sampled = 0;
+    std::vector<vtkIdType> path_vertices;
+    path_vertices.reserve(path_vertex_map.size());
+    for (const auto& kv : path_vertex_map) {
+        path_vertices.push_back(kv.first);
+    }
+
+    std::cout << "Path built from " << num_seeds << " seeds, "
+              << path_vertices.size() << " unique path nodes." << std::endl;
+    return path_vertices;
+}
 
-    for (int i = 0; i < sample_count; ++i) {
-        const auto neighbours =
-            _graph->GetNeighboursAroundPoint(
-                static_cast<vtkIdType>(i), 1);
 
-        if (neighbours.size() < 2) continue;
+std::string LaVolumeSyntheticScar::AddGeodesicDistance(
+    vtkUnstructuredGrid* grid,
+    const std::vector<vtkIdType>& path_vertices,
+    double max_d) const {
+
+    std::vector<float>     distance;
+    std::vector<vtkIdType> nearest_path_node;
+    _graph->GetDistanceToPoints(path_vertices, max_d, distance, nearest_path_node);
+    if (distance.empty()) return "";
+
+    const std::string array_name =
+        UniqueArrayName(grid, _output_array_name + "_geodesic");
+
+    vtkSmartPointer<vtkFloatArray> scalars = vtkSmartPointer<vtkFloatArray>::New();
+    scalars->SetName(array_name.c_str());
+    scalars->SetNumberOfComponents(1);
+    scalars->SetNumberOfTuples(static_cast<vtkIdType>(distance.size()));
+    std::copy(distance.begin(), distance.end(), scalars->GetPointer(0));
+
+    grid->GetPointData()->AddArray(scalars);
+    std::cout << "Writing geodesic distance array: " << array_name << std::endl;
+    return array_name;
+}
+
 
-        double pi[3], pj[3];
-        grid->GetPoint(i, pi);
-        grid->GetPoint(neighbours[1].first, pj);
-        total += LaVolumeGraphTraversal::Euclidean(pi, pj);
-        ++sampled;
+void LaVolumeSyntheticScar::AccumulateKernels(
+    vtkUnstructuredGrid* grid,
+    const std::vector<vtkIdType>& path_vertices,
+    int max_hops,
+    const std::vector<KernelSpec>& kernels,
+    const std::function<void(size_t, const std::vector<double>&)>& consume) const {
+
+    if (_num_partitions <= 1) {
+        LaSyntheticScarField field;
+        field.Build(*_graph, grid, path_vertices, max_hops, _geodesic_kernels);
+
+        std::vector<double> accumulator;
+        for (size_t k = 0; k < kernels.size(); ++k) {
+            field.Accumulate(kernels[k].falloff, kernels[k].hops,
+                             kernels[k].max_d, kernels[k].sigma, accumulator);
+            consume(k, accumulator);
+        }
+        return;
     }
 
-    return (sampled > 0) ? (total / sampled) : 1.0;
+    // ---- Partitioned: one chunk's field at a time ---------------------
+    // max_hops ghost layers hold every hop path reaching an owned node,
+    // so owned nodes receive exactly the contributions of the whole-grid
+    // field; ghost nodes are left to the chunk that owns them.  Geodesic
+    // distances are shortest paths within the hop ball of each path node,
+    // which reaches max_hops beyond a ghost path node: 2 * max_hops + 1
+    // layers hold those balls and every edge between their nodes.
+    //
+    // Kernels are the outer loop, so one accumulator is alive at a time
+    // and is consumed before the next kernel; each kernel pays for its
+    // own pass over the chunks instead.
+    const vtkIdType num_points = grid->GetNumberOfPoints();
+
+    LaVolumePartition partition;
+    partition.SetInputGrid(grid);
+    partition.SetNumberOfChunks(_num_partitions);
+    partition.SetGhostLayers(_geodesic_kernels ? 2 * max_hops + 1 : max_hops);
+    partition.Build();
+
+    std::vector<unsigned char> is_path(static_cast<size_t>(num_points), 0);
+    for (const vtkIdType v : path_vertices) is_path[static_cast<size_t>(v)] = 1;
+
+    LaVolumePartition::Chunk chunk;
+    std::vector<vtkIdType>   local_path;
+    std::vector<double>      local_accumulator;
+    std::vector<double>      accumulator;
+
+    for (size_t k = 0; k < kernels.size(); ++k) {
+        accumulator.assign(static_cast<size_t>(num_points), 0.0);
+
+        for (int c = 0; c < partition.GetNumberOfChunks(); ++c) {
+            partition.ExtractChunk(c, chunk);
+
+            local_path.clear();
+            for (size_t i = 0; i < chunk.point_ids.size(); ++i) {
+                if (is_path[static_cast<size_t>(chunk.point_ids[i])])
+                    local_path.push_back(static_cast<vtkIdType>(i));
+            }
+            if (local_path.empty()) continue;
+
+            LaVolumeGraphTraversal chunk_graph;
+            chunk_graph.SetInputGrid(chunk.grid);
+            chunk_graph.SetEdgeWeightToEuclidean();
+            chunk_graph.Build();
+
+            LaSyntheticScarField field;
+            field.Build(chunk_graph, chunk.grid, local_path, kernels[k].hops, _geodesic_kernels);
+            field.Accumulate(kernels[k].falloff, kernels[k].hops,
+                             kernels[k].max_d, kernels[k].sigma, local_accumulator);
+            for (size_t i = 0; i < chunk.point_ids.size(); ++i) {
+                if (chunk.owned_points[i])
+                    accumulator[static_cast<size_t>(chunk.point_ids[i])] = local_accumulator[i];
+            }
+        }
+
+        consume(k, accumulator);
+    }
 }
 
 
@@ -265,6 +398,8 @@ double LaVolumeSyntheticScar::EstimateMeanEdgeLength() const {
 // ============================================================
 
 void LaVolumeSyntheticScar::Update() {
+    _written_arrays.clear();
+
     if (!_source_volume) {
         std::cerr << "LaVolumeSyntheticScar::Update — no input set." << std::endl;
         return;
@@ -290,99 +425,157 @@ void LaVolumeSyntheticScar::Update() {
     _graph->Build();
 
     // ---- Step 2: build path vertices ----------------------------------
-    std::map<vtkIdType, int> path_vertex_map;
-    const int num_seeds = static_cast<int>(_seed_node_ids.size());
-
-    for (int i = 0; i < num_seeds; ++i) {
-        const vtkIdType start = _seed_node_ids[static_cast<size_t>(i)];
-        const vtkIdType end   =
-            _seed_node_ids[static_cast<size_t>((i + 1) % num_seeds)];
+    const std::vector<vtkIdType> path_vertices = BuildPathVertices();
 
-        const std::vector<vtkIdType> path = _graph->ShortestPath(start, end);
-        for (const vtkIdType v : path) {
-            path_vertex_map.insert({v, 1});
-        }
-    }
-
-    std::vector<vtkIdType> path_vertices;
-    path_vertices.reserve(path_vertex_map.size());
-    for (const auto& kv : path_vertex_map) {
-        path_vertices.push_back(kv.first);
-    }
-
-    std::cout << "Path built from " << num_seeds << " seeds, "
-              << path_vertices.size() << " unique path nodes." << std::endl;
-
-    // ---- Step 3: estimate world-space corridor radius -----------------
-    const double mean_edge = EstimateMeanEdgeLength();
+    // ---- Step 3: world-space corridor radius from the edge lengths -----
+    const double mean_edge = _graph->GetEdgeStatistics().mean;
     const double max_d     = mean_edge * _neighbourhood_size;
 
-    std::cout << "Estimated mean edge length: " << mean_edge
+    std::cout << "Mean edge length: " << mean_edge
               << ", corridor radius (max_d): " << max_d << std::endl;
 
-    // ---- Step 4: accumulate scalar contributions ----------------------
-    std::vector<double> accumulator(static_cast<size_t>(num_points), 0.0);
+    // ---- Step 4: output grid ------------------------------------------
+    // The output shares the input arrays; only new arrays are added.
+    vtkSmartPointer<vtkUnstructuredGrid> output_grid =
+        vtkSmartPointer<vtkUnstructuredGrid>::New();
+    output_grid->ShallowCopy(grid);
 
-    for (const vtkIdType path_vtx : path_vertices) {
-        double path_point[3];
-        grid->GetPoint(path_vtx, path_point);
+    const std::string array_name =
+        UniqueArrayName(output_grid, _output_array_name);
 
-        accumulator[static_cast<size_t>(path_vtx)] +=
-            EvaluateFalloff(0.0, max_d);
+    // ---- Step 5: distance-to-path field, normalised scalar array ------
+    vtkSmartPointer<vtkFloatArray> scar_scalars;
+    AccumulateKernels(grid, path_vertices, _neighbourhood_size,
+        {{static_cast<int>(_falloff), _neighbourhood_size, max_d, _sigma}},
+        [&](size_t, const std::vector<double>& accumulator) {
+            scar_scalars = LaSyntheticScarField::NormalisedArray(accumulator, array_name);
+        });
+    if (!scar_scalars) {
+        std::cerr << "LaVolumeSyntheticScar::Update — all accumulator values "
+                     "are zero. Check seed IDs and neighbourhood size."
+                  << std::endl;
+        return;
+    }
+    std::cout << "Writing scalar array: " << array_name << std::endl;
 
-        const auto neighbours =
-            _graph->GetNeighboursAroundPoint(path_vtx, _neighbourhood_size);
+    output_grid->GetPointData()->AddArray(scar_scalars);
+    _written_arrays.push_back(array_name);
+    if (_geodesic_output) {
+        const std::string geodesic_name = AddGeodesicDistance(output_grid, path_vertices, max_d);
+        if (!geodesic_name.empty()) _written_arrays.push_back(geodesic_name);
+    }
+    _output_volume->SetGrid(output_grid);
 
-        for (const auto& [neighbour_id, depth] : neighbours) {
-            if (neighbour_id < 0 ||
-                neighbour_id >= static_cast<vtkIdType>(num_points)) continue;
+    std::cout << "LaVolumeSyntheticScar::Update complete. Array \""
+              << array_name << "\" added to output volume." << std::endl;
+}
 
-            double neighbour_point[3];
-            grid->GetPoint(neighbour_id, neighbour_point);
-            const double dist =
-                LaVolumeGraphTraversal::Euclidean(path_point, neighbour_point);
 
-            accumulator[static_cast<size_t>(neighbour_id)] +=
-                EvaluateFalloff(dist, max_d);
-        }
-    }
+// ============================================================
+// UpdateSweep — one traversal, many kernels
+// ============================================================
 
-    // ---- Step 5: normalise to [0, 1] ----------------------------------
-    const double max_acc =
-        *std::max_element(accumulator.begin(), accumulator.end());
+void LaVolumeSyntheticScar::UpdateSweep(const std::vector<int>& neighbourhood_sizes,
+                                        const std::vector<int>& falloffs,
+                                        const std::vector<double>& sigmas) {
+    _sweep_variants.clear();
+    _written_arrays.clear();
 
-    if (max_acc <= 0.0) {
-        std::cerr << "LaVolumeSyntheticScar::Update — all accumulator values "
-                     "are zero. Check seed IDs and neighbourhood size."
-                  << std::endl;
+    if (!_source_volume) {
+        std::cerr << "LaVolumeSyntheticScar::UpdateSweep — no input set." << std::endl;
+        return;
+    }
+    if (_seed_node_ids.size() < 2) {
+        std::cerr << "LaVolumeSyntheticScar::UpdateSweep — at least 2 seed node IDs "
+                     "required." << std::endl;
+        return;
+    }
+    if (neighbourhood_sizes.empty() || falloffs.empty()) {
+        std::cerr << "LaVolumeSyntheticScar::UpdateSweep — empty neighbourhood or "
+                     "falloff list." << std::endl;
         return;
     }
 
-    // ---- Step 6: write scalar array -----------------------------------
-    vtkSmartPointer<vtkUnstructuredGrid> output_grid =
-        vtkSmartPointer<vtkUnstructuredGrid>::New();
-    output_grid->DeepCopy(grid);
-
-    const std::string array_name =
-        UniqueArrayName(output_grid, _output_array_name);
-    std::cout << "Writing scalar array: " << array_name << std::endl;
+    vtkUnstructuredGrid* grid = _source_volume->GetGridPointer();
+    if (grid->GetNumberOfPoints() == 0) {
+        std::cerr << "LaVolumeSyntheticScar::UpdateSweep — source grid has no points."
+                  << std::endl;
+        return;
+    }
 
-    vtkSmartPointer<vtkFloatArray> scar_scalars =
-        vtkSmartPointer<vtkFloatArray>::New();
-    scar_scalars->SetName(array_name.c_str());
-    scar_scalars->SetNumberOfComponents(1);
+    // ---- Shared work, done once ---------------------------------------
+    _graph->SetInputGrid(grid);
+    _graph->SetEdgeWeightToEuclidean();
+    _graph->Build();
 
-    for (vtkIdType i = 0; i < num_points; ++i) {
-        scar_scalars->InsertNextValue(
-            static_cast<float>(
-                accumulator[static_cast<size_t>(i)] / max_acc));
+    const std::vector<vtkIdType> path_vertices = BuildPathVertices();
+    const double mean_edge = _graph->GetEdgeStatistics().mean;
+    const int max_hops =
+        *std::max_element(neighbourhood_sizes.begin(), neighbourhood_sizes.end());
+
+    std::cout << "Mean edge length: " << mean_edge << std::endl;
+
+    // ---- Every combination, evaluated from one field ------------------
+    const std::vector<double> gaussian_sigmas =
+        sigmas.empty() ? std::vector<double>{_sigma} : sigmas;
+    const std::vector<double> linear_sigmas = {-1.0};   // sigma unused
+
+    std::vector<KernelSpec> kernels;
+    for (const int n : neighbourhood_sizes) {
+        for (const int falloff : falloffs) {
+            const std::vector<double>& falloff_sigmas =
+                (falloff == static_cast<int>(VolumeFalloffKernel::Linear))
+                    ? linear_sigmas : gaussian_sigmas;
+            for (const double sigma : falloff_sigmas)
+                kernels.push_back({falloff, n, mean_edge * n, sigma});
+        }
     }
 
-    output_grid->GetPointData()->AddArray(scar_scalars);
+    // The output shares the input arrays; only new arrays are added.
+    vtkSmartPointer<vtkUnstructuredGrid> output_grid =
+        vtkSmartPointer<vtkUnstructuredGrid>::New();
+    output_grid->ShallowCopy(grid);
+
+    AccumulateKernels(grid, path_vertices, max_hops, kernels,
+        [&](size_t k, const std::vector<double>& accumulator) {
+            const KernelSpec& kernel = kernels[k];
+            const std::string array_name = UniqueArrayName(output_grid,
+                LaSyntheticScarField::VariantName(_output_array_name, kernel.hops,
+                                                  kernel.falloff, kernel.sigma));
+
+            vtkSmartPointer<vtkFloatArray> scar_scalars =
+                LaSyntheticScarField::NormalisedArray(accumulator, array_name);
+            if (!scar_scalars) {
+                std::cerr << "LaVolumeSyntheticScar::UpdateSweep — " << array_name
+                          << " is zero everywhere, skipped." << std::endl;
+                return;
+            }
+
+            output_grid->GetPointData()->AddArray(scar_scalars);
+            _sweep_variants.push_back({kernel.hops, kernel.falloff, kernel.sigma, array_name});
+            _written_arrays.push_back(array_name);
+            std::cout << "Writing scalar array: " << array_name << std::endl;
+        });
+
+    if (_geodesic_output) {
+        const std::string geodesic_name =
+            AddGeodesicDistance(output_grid, path_vertices, mean_edge * max_hops);
+        if (!geodesic_name.empty()) _written_arrays.push_back(geodesic_name);
+    }
     _output_volume->SetGrid(output_grid);
 
-    std::cout << "LaVolumeSyntheticScar::Update complete. Array \""
-              << array_name << "\" added to output volume." << std::endl;
+    std::cout << "LaVolumeSyntheticScar::UpdateSweep complete. "
+              << _sweep_variants.size() << " arrays added to output volume."
+              << std::endl;
+}
+
+const std::vector<LaSyntheticScarField::Variant>&
+LaVolumeSyntheticScar::GetSweepVariants() const {
+    return _sweep_variants;
+}
+
+const std::vector<std::string>& LaVolumeSyntheticScar::GetWrittenArrayNames() const {
+    return _written_arrays;
 }
 
 
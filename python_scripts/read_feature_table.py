@@ -0,0 +1,46 @@
+import sys
+import numpy as np
+'''
+Reads the binary feature columns (.lft) written by imagefeature -ob, the
+columnar counterpart of its CSV output. Columns are memory-mapped, so only
+the ones used are read from disk.
+
+Usage:
+Call the program with the .lft filename as the first argument to print the
+columns, or use Read_Feature_Table from another script / notebook:
+
+    df = pd.DataFrame(Read_Feature_Table('features.lft'))
+
+Layout (see LaImageFeatureTable.h): "LAFEAT01", uint32 byte-order mark,
+uint32 columns, uint64 rows, int32[3] image size, uint32 0, then per column
+uint32 type (1 = float32), uint32 name length, uint64 offset and the name.
+'''
+def Read_Feature_Table(filename):
+    with open(filename, 'rb') as f:
+        if f.read(8) != b'LAFEAT01':
+            raise ValueError(filename + ' is not a feature table')
+        bom, num_columns = np.frombuffer(f.read(8), dtype='<u4')
+        if bom != 0x01020304:
+            raise ValueError(filename + ' was written with a different byte order')
+        num_rows = int(np.frombuffer(f.read(8), dtype='<u8')[0])
+        f.read(16)      # image size, reserved
+
+        directory = []
+        for c in range(num_columns):
+            column_type, name_length = np.frombuffer(f.read(8), dtype='<u4')
+            offset = int(np.frombuffer(f.read(8), dtype='<u8')[0])
+            name = f.read(int(name_length)).decode('utf-8')
+            if column_type != 1:
+                raise ValueError('column ' + name + ' has unknown type ' + str(column_type))
+            directory.append((name, offset))
+
+    columns = {}
+    for name, offset in directory:
+        columns[name] = np.memmap(filename, dtype='<f4', mode='r', offset=offset, shape=(num_rows,))
+    return columns
+
+
+if __name__ == '__main__':
+    columns = Read_Feature_Table(sys.argv[1])
+    for name, values in columns.items():
+        print(name, values.shape[0], 'rows, mean', np.nanmean(values))
@@ -17,6 +17,9 @@ if [ $# -eq 0 ] ; then
     echo "    -f <list>   Comma-separated falloff modes 1=Gaussian 2=Linear (default: 1,2)"
     echo "    -s <list>   Comma-separated sigma values          (default: 3.0,7.0,15.0)"
     echo "    -i <path>    Input mesh file path                  (default: <input_file>.vtk)"
+    echo "    -S           Single-run sweep: one process per seed file evaluates"
+    echo "                 every combination from one graph/path build"
+    echo "                 (outputs <base>_n<N>_f<F>[_s<S>].vtk, sigma omitted for Linear)"
     exit 1
 fi
 
@@ -29,15 +32,17 @@ IFS=',' read -ra FALLOFFS       <<< "1,2"
 IFS=',' read -ra SIGMAS         <<< "3.0,7.0,15.0"
 MESH_EXT="vtk"
 INPUT_MESH="vtk"
+SINGLE_RUN=0
 
 # --- Parse options -----------------------------------------------------
-while getopts ":b:n:f:s:e:i:" opt; do
+while getopts ":b:n:f:s:e:i:S" opt; do
     case $opt in
         b) BINARY="$OPTARG" ;;
         n) IFS=',' read -ra NEIGHBOURHOODS <<< "$OPTARG" ;;
         f) IFS=',' read -ra FALLOFFS       <<< "$OPTARG" ;;
         s) IFS=',' read -ra SIGMAS         <<< "$OPTARG" ;;
         i) INPUT_MESH="$OPTARG" ;;
+        S) SINGLE_RUN=1 ;;
         \?) >&2 echo "Unknown option: -$OPTARG"; exit 1 ;;
         :)  >&2 echo "Option -$OPTARG requires an argument"; exit 1 ;;
     esac
@@ -64,6 +69,28 @@ if [ ! -f "$INPUT_MESH" ]; then
     exit 1
 fi
 
+# --- Single-run sweep --------------------------------------------------
+if [ "$SINGLE_RUN" -eq 1 ]; then
+    join() { local IFS=','; echo "$*"; }
+    for pts_file in "$@"; do
+        base="${pts_file%.*}"
+        echo "Sweep n=$(join "${NEIGHBOURHOODS[@]}") falloff=$(join "${FALLOFFS[@]}") sigma=$(join "${SIGMAS[@]}")"
+        echo "  pts:  $pts_file"
+        echo "  mesh: $INPUT_MESH"
+
+        "$BINARY" \
+            -i "$INPUT_MESH" \
+            -pts "$pts_file" \
+            -o "${base}.${MESH_EXT}" \
+            -sweep-n "$(join "${NEIGHBOURHOODS[@]}")" \
+            -sweep-f "$(join "${FALLOFFS[@]}")" \
+            -sweep-s "$(join "${SIGMAS[@]}")" \
+            --sweep-split
+    done
+    echo "Done. $# sweeps run."
+    exit 0
+fi
+
 # --- Main loop ---------------------------------------------------------
 total=$(( $# * ${#NEIGHBOURHOODS[@]} * ${#FALLOFFS[@]} * ${#SIGMAS[@]} ))
 count=0